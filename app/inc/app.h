@@ -1,22 +1,34 @@
 #ifndef APP_H
 #define APP_H
+#include <chrono>
+#include <future>
 #include <memory>
+#include <optional>
+#include <string>
 
 #include "buffer.h"
 #include "context.h"
 #include "camera.h"
 #include "datatypes.h"
 #include "pipeline.h"
+#include "pipeline_layout.h"
 #include "descriptor_set.h"
 #include "descriptor_pool.h"
 #include "descriptor_set_layout.h"
 #include "HDRI_render_target.h"
+#include "light_clustering.h"
 #include "VkBootstrap.h"
 #include "timing_query_pool.h"
 
 #include <map>
 
 class Scene;
+class Uploader;
+class ClusterCuller;
+class DepthPyramid;
+class ParallelRecorder;
+class PipelineManager;
+class ShaderReloader;
 
 namespace vkc
 {
@@ -24,7 +36,7 @@ namespace vkc
 	class CommandBuffer;
 	class ImageView;
 	class Image;
-	class PipelineLayout;
+	class PipelineCache;
 }
 
 class App final
@@ -46,6 +58,15 @@ public:
 	void Run();
 
 	static float constexpr SHADOW_FAR_PLANE = 100.0f;
+	static VkExtent2D constexpr SHADOW_MAP_RESOLUTION{ 2048, 2048 };
+	// shadow maps tolerate coarser geometry than the camera, their LOD pixel error is scaled by this
+	static float constexpr SHADOW_LOD_BIAS = 4.0f;
+	// the render loop starts before the scene is uploaded, meshes and textures appear as their uploads complete
+	static bool constexpr PROGRESSIVE_LOADING = true;
+
+	static char constexpr DEPTH_PREPASS_PIPELINE[]{ "depth prepass" };
+	static char constexpr GBUFFER_PIPELINE[]{ "gbuffer" };
+	static char constexpr BLIT_PIPELINE[]{ "blit" };
 
 private:
 	void InitImGUI() const;
@@ -58,36 +79,89 @@ private:
 	void CreateSyncObjects();
 	void CreateDescriptorPool();
 	void UpdateGbufferDescriptor();
+	void UpdateTextureSamplerDescriptor();
+	void UpdateTextureDescriptors();
 	void CreateDescriptorSets();
 	void CreateGraphicsPipeline();
+	// what the pipeline builders would otherwise read from the app while the render loop changes it, copied when a
+	// pipeline is requested
+	struct PipelineInputs
+	{
+		VkExtent2D Extent;
+		VkFormat   SwapchainFormat;
+		VkFormat   DepthFormat;
+		VkFormat   AlbedoFormat;
+		VkFormat   MaterialFormat;
+		VkFormat   HDRIFormat;
+		glm::vec3  BoundsMin;
+		glm::vec3  BoundsMax;
+		uint32_t   DirectionalLightCount;
+		uint32_t   PointLightCount;
+	};
+	[[nodiscard]] PipelineInputs GetPipelineInputs() const;
+	// read the compiled shaders from disk, called from the pipeline manager's threads
+	[[nodiscard]] vkc::Pipeline BuildDepthPrepPipeline(vkc::PipelineCache& cache, PipelineInputs const& inputs);
+	[[nodiscard]] vkc::Pipeline BuildGBufferGenPipeline(vkc::PipelineCache& cache, PipelineInputs const& inputs);
+	[[nodiscard]] vkc::Pipeline BuildLightingPipeline
+	(
+		vkc::PipelineCache&     cache
+		, PipelineInputs const& inputs
+		, VkBool32              directionalLights
+		, VkBool32              pointLights
+	);
+	[[nodiscard]] vkc::Pipeline BuildBlitPipeline(vkc::PipelineCache& cache, PipelineInputs const& inputs);
+	// lighting variants are keyed by the light toggles they are specialized for
+	[[nodiscard]] std::string GetLightingPipelineKey() const;
+	void                      RequestLightingPipeline();
 	void CreateCmdPool();
 	void CreateDescriptorSetLayouts();
 	void GenerateShadowMaps();
+	// waits for the device, so the old maps and the recorder can be replaced, then generates the maps again with the
+	// configured recording threads
+	void RegenerateShadowMaps();
+	void RecordLoadTimings();
 	void CreateResources();
 	void CreateGBuffer();
 	void CreateDepth();
 	void RecreateSwapchain();
 	void RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageIndex);
-	void Submit(vkc::CommandBuffer& commandBuffer) const;
+	void Submit(vkc::CommandBuffer& commandBuffer, uint64_t uploadValue) const;
 	void Present(uint32_t imageIndex);
 	void End();
 
 	void DoBlitPass(vkc::CommandBuffer& commandBuffer, size_t imageIndex);
 	void DoLightingPass(vkc::CommandBuffer& commandBuffer, size_t imageIndex) const;
 	void DoGBufferPass(vkc::CommandBuffer& commandBuffer, size_t imageIndex) const;
-	void DoDepthPrepass(vkc::CommandBuffer const& commandBuffer, size_t imageIndex) const;
+	// draws a culling view's clusters into the depth buffer, the late prepass loads what the early one wrote
+	void DoDepthPrepass(vkc::CommandBuffer const& commandBuffer, uint32_t view, VkAttachmentLoadOp loadOp) const;
 
 	Config                m_Config;
 	uptr<TimingQueryPool> m_QueryPool;
 	Timings               m_GPUTimings;
 	Timings               m_CPUTimings;
+	// one query per frame in flight counting the depth samples its prepasses wrote, per pixel that is their overdraw
+	VkQueryPool           m_OverdrawQueryPool{};
+	std::vector<bool>     m_OverdrawQueried;
+	double                m_DepthOverdraw{};
+
+	std::chrono::steady_clock::time_point m_StartTime;
+	bool                                  m_ShadowMapsGenerated{};
+	bool                                  m_RegenerateShadowMaps{};
+	// seconds the last shadow recording took per worker count
+	std::map<uint32_t, double>            m_ShadowRecordingDurations;
+	bool                                  m_FullyLoaded{};
 
 	vkb::PhysicalDevice m_PhysicalDevice;
 
 	uptr<Camera> m_Camera;
 	vkc::Context m_Context{};
 
-	uptr<Scene> m_Scene;
+	uptr<Scene>          m_Scene;
+	uptr<ClusterCuller>  m_ClusterCuller;
+	uptr<DepthPyramid>   m_DepthPyramid;
+	uptr<LightClusterer> m_LightClusterer;
+	// scattered over the scene's bounds once, the first ClusteredLightCount of them are shaded
+	std::vector<LightClusterer::PointLight> m_ClusteredLights;
 
 	uptr<vkc::DescriptorSetLayout> m_FrameDescSetLayout{};
 	uptr<vkc::DescriptorSetLayout> m_GlobalDescSetLayout{};
@@ -97,16 +171,20 @@ private:
 	uptr<vkc::PipelineCache> m_PipelineCache{};
 
 	uptr<vkc::PipelineLayout> m_DepthPrepPipelineLayout;
-	uptr<vkc::Pipeline>       m_DepthPrepPipeline{};
-
 	uptr<vkc::PipelineLayout> m_GBufferGenPipelineLayout;
-	uptr<vkc::Pipeline>       m_GBufferGenPipeline{};
-
 	uptr<vkc::PipelineLayout> m_LightingPipelineLayout;
-	uptr<vkc::Pipeline>       m_LightingPipeline{};
-
 	uptr<vkc::PipelineLayout> m_BlitPipelineLayout;
-	uptr<vkc::Pipeline>       m_BlitPipeline{};
+
+	uptr<PipelineManager> m_Pipelines;
+	uptr<ShaderReloader>  m_ShaderReloader;
+	std::string           m_LightingFallback;
+	bool                  m_PipelineCacheWarm{};
+
+	// compiled during startup, joined when the shadow maps are first generated and kept for regenerating them
+	std::future<std::pair<vkc::PipelineLayout, vkc::Pipeline>>   m_DirectionalShadowPipeline;
+	std::future<std::pair<vkc::PipelineLayout, vkc::Pipeline>>   m_PointShadowPipeline;
+	std::optional<std::pair<vkc::PipelineLayout, vkc::Pipeline>> m_DirectionalShadowPass;
+	std::optional<std::pair<vkc::PipelineLayout, vkc::Pipeline>> m_PointShadowPass;
 
 	VkFormat             m_DepthFormat{};
 	uptr<vkc::Image>     m_DepthImage{};
@@ -121,12 +199,16 @@ private:
 	uptr<HDRIRenderTarget> m_HDRIRenderTarget{};
 
 	VkSampler m_TextureSampler{};
+	VkSampler m_NoMipTextureSampler{};
 	VkSampler m_ShadowSampler{};
 
 	std::vector<vkc::Image>     m_SwapchainImages;
 	std::vector<vkc::ImageView> m_SwapchainImageViews;
 
 	uptr<vkc::CommandPool> m_CommandPool{};
+	uptr<vkc::CommandPool> m_InitCommandPool{};
+	uptr<ParallelRecorder> m_ParallelRecorder{};
+	uptr<Uploader>         m_Uploader{};
 
 	std::vector<vkc::Buffer> m_MVPUBOs{};
 	std::vector<vkc::Buffer> m_LightSSBOs{};
@@ -135,6 +217,7 @@ private:
 	std::vector<vkc::DescriptorSet> m_FrameDescriptorSets{};
 	std::vector<vkc::DescriptorSet> m_GlobalDescriptorSets{};
 	std::vector<vkc::DescriptorSet> m_GbufferDescriptorSets{};
+	std::vector<VkSampler>          m_BoundTextureSamplers{};
 
 	std::vector<VkSemaphore> m_ImageAvailableSemaphores{};
 	std::vector<VkSemaphore> m_RenderFinishedSemaphores{};
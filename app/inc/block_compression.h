@@ -0,0 +1,26 @@
+#ifndef VULKANRESEARCH_BLOCK_COMPRESSION_H
+#define VULKANRESEARCH_BLOCK_COMPRESSION_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// encoders for the BCn formats used by cooked textures, every function takes a tightly packed RGBA8 level and
+// returns its blocks in row major order, partial blocks on the right and bottom edges replicate the last texel
+namespace block_compression
+{
+	uint32_t constexpr BLOCK_DIMENSION{ 4 };
+
+	[[nodiscard]] uint64_t CalculateSize(uint32_t width, uint32_t height, uint32_t blockSize);
+
+	// single channel, 8 bytes per block
+	[[nodiscard]] std::vector<unsigned char> EncodeBC4(std::span<unsigned char const> pixels, uint32_t width, uint32_t height, uint32_t channel);
+
+	// two BC4 blocks for the first two channels, 16 bytes per block
+	[[nodiscard]] std::vector<unsigned char> EncodeBC5(std::span<unsigned char const> pixels, uint32_t width, uint32_t height);
+
+	// mode 6 only (single subset RGBA, 4 bit indices), 16 bytes per block
+	[[nodiscard]] std::vector<unsigned char> EncodeBC7(std::span<unsigned char const> pixels, uint32_t width, uint32_t height);
+}
+
+#endif //VULKANRESEARCH_BLOCK_COMPRESSION_H
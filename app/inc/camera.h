@@ -88,6 +88,11 @@ public:
 		return m_Far;
 	}
 
+	[[nodiscard]] glm::vec3 const& GetPosition() const
+	{
+		return m_Position;
+	}
+
 	[[nodiscard]] glm::mat4 CalculateViewMatrix() const
 	{
 		return glm::lookAt(m_Position, m_Position + m_Forward, WORLD_UP);
@@ -0,0 +1,222 @@
+#ifndef VULKANRESEARCH_CLUSTER_CULLING_H
+#define VULKANRESEARCH_CLUSTER_CULLING_H
+
+#include <array>
+#include <vector>
+
+#include "buffer.h"
+#include "datatypes.h"
+#include "draw_sorting.h"
+#include "frustum_culling.h"
+#include "descriptor_pool.h"
+#include "descriptor_set.h"
+#include "descriptor_set_layout.h"
+#include "helper.h"
+#include "pipeline_layout.h"
+#include "glm/glm.hpp"
+
+class DepthPyramid;
+class Scene;
+
+namespace vkc
+{
+	class PipelineCache;
+}
+
+// tests every cluster of the GeometryArena against a view's frustum and normal cone in a compute pass and writes the
+// survivors as indirect draws, every view owns a draw slot per cluster so views culled in one command buffer
+// never overwrite each other. meshes whose bounding sphere is outside the frustum are rejected on the host, the
+// visible ones are sorted by the view's draw order and only the clusters of the LOD picked for each are tested, in
+// that order. invocations take their draw slots as they finish, so the draws follow the sorted order as closely as
+// the workgroups are launched in order.
+// the survivors are compacted per index type, so a pass draws a whole view with at most two indirect count draws
+// and its shaders read the mesh's textures from the per draw data at the draw's gl_DrawID.
+// the first views can also be culled in two phases against a depth pyramid: the early pass draws the clusters the last
+// late pass found visible, the late one tests the rest against the pyramid built from the early depth and writes
+// the ones that turn out visible into the view's late draw slots
+class ClusterCuller final
+{
+public:
+	struct Statistics
+	{
+		uint32_t Visible;
+		uint32_t Total;
+		uint32_t Triangles;
+		// resident meshes whose bounding sphere passed the frustum test
+		uint32_t VisibleMeshes;
+		uint32_t TotalMeshes;
+		// clusters inside the frustum the late pass rejected against the depth pyramid
+		uint32_t Occluded;
+	};
+
+	struct ViewParameters
+	{
+		glm::mat4 ViewProjection;
+		// view position with w = 1, a w of 0 skips the normal cone test for views whose pipelines
+		// do not cull back faces the way the cone assumes
+		glm::vec4 Eye;
+		// render target height and the screen space error in pixels the selected LODs may introduce on it
+		float ViewportHeight;
+		float LodPixelError;
+		// front to back for the depth only passes
+		draw_sorting::Order DrawOrder;
+	};
+
+	ClusterCuller() = delete;
+	// views [0, occlusionViewCount) can be culled in two phases
+	ClusterCuller
+	(
+		vkc::Context&         context
+		, Scene const&        scene
+		, uint32_t            viewCount
+		, uint32_t            occlusionViewCount
+		, vkc::PipelineCache& cache
+	);
+	~ClusterCuller() = default;
+
+	ClusterCuller(ClusterCuller&&)                 = delete;
+	ClusterCuller(ClusterCuller const&)            = delete;
+	ClusterCuller& operator=(ClusterCuller&&)      = delete;
+	ClusterCuller& operator=(ClusterCuller const&) = delete;
+
+	void Destroy();
+
+	// the pyramid the late passes test against, must be set before the first Cull and again after it was resized
+	void SetDepthPyramid(DepthPyramid const& depthPyramid);
+
+	// copies every mesh's textures next to its first cluster, called once before the views of a command buffer are
+	// culled. frames in flight only ever see the same values rewritten
+	void UpdateMeshData() const;
+
+	// tests every mesh's bounding sphere, sorts the visible ones and picks their LODs on the host, the view's previous
+	// Cull must have completed on the GPU. leaves the late draw slots of the view empty. different views may be culled
+	// from several threads at once, each into its own command buffer
+	void Cull(VkCommandBuffer commandBuffer, uint32_t view, ViewParameters const& parameters) const;
+
+	// Cull limited to the clusters the view's last late pass found visible
+	void CullEarly(VkCommandBuffer commandBuffer, uint32_t view, ViewParameters const& parameters) const;
+
+	// tests the clusters CullEarly skipped against the depth pyramid and writes the visible ones to the late view,
+	// expects the pyramid built from the depth of the early draws
+	void CullLate(VkCommandBuffer commandBuffer, uint32_t view, ViewParameters const& parameters) const;
+
+	// binds the arena's buffers and draws everything the view's last Cull kept. the index of the view's first draw slot
+	// is pushed as a uint at pushConstantOffset, the shaders add gl_DrawID to it to find their draw data
+	void Draw
+	(
+		VkCommandBuffer      commandBuffer
+		, uint32_t           view
+		, VkPipelineLayout   pipelineLayout
+		, VkShaderStageFlags pushConstantStages
+		, uint32_t           pushConstantOffset
+	) const;
+
+	// where CullLate writes the draws of an occlusion culled view
+	[[nodiscard]] uint32_t GetLateView(uint32_t view) const
+	{
+		return m_ViewCount + view;
+	}
+
+	// the per draw data as a vertex stage storage buffer at binding 0, added to the layouts of the pipelines that Draw
+	[[nodiscard]] vkc::DescriptorSetLayout const& GetDrawDescriptorSetLayout() const
+	{
+		return m_DrawDescriptorSetLayout;
+	}
+
+	[[nodiscard]] VkDescriptorSet GetDrawDescriptorSet() const
+	{
+		return m_DescriptorSets[1];
+	}
+
+	// counts written by the last completed Cull of each view in the range, including the late pass of occlusion views
+	[[nodiscard]] Statistics GetStatistics(uint32_t firstView, uint32_t viewCount) const;
+
+	// seconds the last Cull of the view spent sorting its visible meshes
+	[[nodiscard]] double GetSortDuration(uint32_t view) const
+	{
+		return m_SortDurations[view];
+	}
+
+private:
+	// the shader's specialization constant
+	enum class Phase : uint32_t
+	{
+		All
+		, Early
+		, Late
+	};
+
+	// written by the host at the first cluster of every mesh
+	struct MeshData
+	{
+		TextureIndices Textures;
+	};
+
+	struct PushConstants
+	{
+		glm::vec4 Planes[6];
+		glm::vec4 Eye;
+		uint32_t  View;
+		uint32_t  ClusterCount;
+		uint32_t  ShortIndexClusterCount;
+	};
+
+	// the pyramid the late pass of a view samples
+	struct OcclusionView
+	{
+		glm::mat4  ViewProjection;
+		glm::uvec2 DepthSize;
+		uint32_t   LevelCount;
+		uint32_t   Padding;
+	};
+
+	void Record(VkCommandBuffer commandBuffer, uint32_t view, ViewParameters const& parameters, Phase phase) const;
+	void SelectLods(uint32_t view, ViewParameters const& parameters, frustum_culling::Planes const& planes) const;
+	void CreatePipelines(vkc::PipelineCache& cache);
+
+	vkc::Context& m_Context;
+	Scene const&  m_Scene;
+
+	uint32_t m_ClusterCount;
+	uint32_t m_ShortIndexClusterCount;
+	uint32_t m_ViewCount;
+	uint32_t m_OcclusionViewCount;
+
+	// a view's slots hold its 16 bit index draws first, then the 32 bit ones from the first long index cluster on
+	vkc::Buffer m_DrawBuffer;
+	// the mesh's TextureIndices for every draw, meshes share the frame's model matrix so there is no transform to index
+	vkc::Buffer m_DrawDataBuffer;
+	// two per view, one per index type
+	vkc::Buffer m_CountBuffer;
+	// whether every cluster was visible to the last late pass, zeroed by the first early one
+	vkc::Buffer  m_VisibilityBuffer;
+	mutable bool m_VisibilityCleared{};
+
+	// written by the host before each late pass
+	help::MappedBuffer m_OcclusionViews{};
+	VkExtent2D         m_DepthExtent{};
+	uint32_t           m_DepthLevelCount{};
+
+	// the mesh's textures, copied next to each of its draws
+	help::MappedBuffer m_MeshData{};
+
+	// per view the visible mesh and cluster counts, then the first invocation and the first cluster of the selected LOD
+	// of every visible mesh in draw order. written by the host, the late pass reuses the ranges of the early one
+	help::MappedBuffer            m_DrawRanges{};
+	// clusters listed in each view's ranges, the size of its dispatch
+	mutable std::vector<uint32_t> m_InvocationCounts;
+	mutable std::vector<double>   m_SortDurations;
+
+	// visible and occluded clusters and triangles per view, host visible so they can be shown without a readback copy
+	help::MappedBuffer m_Statistics{};
+
+	vkc::DescriptorSetLayout        m_DescriptorSetLayout;
+	vkc::DescriptorSetLayout        m_DrawDescriptorSetLayout;
+	vkc::DescriptorPool             m_DescriptorPool;
+	std::vector<vkc::DescriptorSet> m_DescriptorSets;
+	vkc::PipelineLayout             m_PipelineLayout;
+	// one per Phase
+	std::array<VkPipeline, 3>       m_Pipelines{};
+};
+
+#endif //VULKANRESEARCH_CLUSTER_CULLING_H
@@ -0,0 +1,79 @@
+#ifndef VULKANRESEARCH_COOKED_SCENE_H
+#define VULKANRESEARCH_COOKED_SCENE_H
+
+#include <string>
+#include <string_view>
+
+#include "mapped_file.h"
+#include "scene_data.h"
+
+// binary scene cache produced from SceneData, memory mapped at runtime so the vertex and index blobs
+// can be copied into staging memory without any intermediate conversion
+class CookedScene final
+{
+public:
+	static uint32_t constexpr VERSION = 5;
+
+	struct Header
+	{
+		char      Magic[4];
+		uint32_t  Version;
+		uint64_t  SourceHash;
+		double    ImportDuration;
+		glm::vec3 AABBMin;
+		uint32_t  ContainsPBRInfo;
+		glm::vec3 AABBMax;
+		uint32_t  MeshCount;
+		uint32_t  TextureCount;
+		uint32_t  TextureTableSize;
+		uint32_t  MeshletCount;
+		uint32_t  LodCount;
+		uint64_t  VertexCount;
+		uint64_t  IndexCount;
+		uint64_t  MeshesOffset;
+		uint64_t  MeshletsOffset;
+		uint64_t  LodsOffset;
+		uint64_t  VerticesOffset;
+		uint64_t  IndicesOffset;
+		uint64_t  TexturesOffset;
+		uint64_t  FileSize;
+	};
+
+	CookedScene() = delete;
+	// throws if the file is missing, malformed or was cooked from a different source
+	CookedScene(std::string_view path, uint64_t expectedSourceHash);
+	~CookedScene() = default;
+
+	CookedScene(CookedScene&&)                 = delete;
+	CookedScene(CookedScene const&)            = delete;
+	CookedScene& operator=(CookedScene&&)      = delete;
+	CookedScene& operator=(CookedScene const&) = delete;
+
+	[[nodiscard]] SceneView const& GetView() const
+	{
+		return m_View;
+	}
+
+	[[nodiscard]] double GetImportDuration() const
+	{
+		return m_Header->ImportDuration;
+	}
+
+private:
+	MappedFile                m_File;
+	Header const*             m_Header{};
+	std::vector<TextureEntry> m_Textures;
+	SceneView                 m_View;
+};
+
+namespace cooked_scene
+{
+	[[nodiscard]] std::string GetCachePath(std::string_view sourcePath);
+
+	// hashes the source file, any sibling .bin buffer and the cook format version
+	[[nodiscard]] uint64_t HashSource(std::string_view sourcePath);
+
+	void Write(std::string_view path, SceneData const& data, uint64_t sourceHash, double importDuration);
+}
+
+#endif //VULKANRESEARCH_COOKED_SCENE_H
@@ -4,6 +4,7 @@
 
 #include "vulkan/vulkan_core.h"
 #include "glm/glm.hpp"
+#include "draw_sorting.h"
 #include "pipeline_layout.h"
 #include "pipeline.h"
 #include "descriptor_set_layout.h"
@@ -25,8 +26,21 @@ struct TextureIndices
 
 struct Config
 {
-	VkBool32 EnableDirectionalLights{ VK_TRUE };
-	VkBool32 EnablePointLights{ VK_TRUE };
+	VkBool32            EnableDirectionalLights{ VK_TRUE };
+	VkBool32            EnablePointLights{ VK_TRUE };
+	bool                UseTextureMips{ true };
+	// two phase culling of the camera view against the depth of last frame's visible clusters
+	bool                OcclusionCulling{ true };
+	float               LodPixelError{ 1.f };
+	// of the camera view, the depth prepass and the gbuffer pass draw the same culled list
+	draw_sorting::Order CameraDrawOrder{ draw_sorting::Order::FrontToBack };
+	// memory the streamed texture levels may occupy
+	int                 TextureBudgetMiB{ 256 };
+	// unshadowed point lights assigned to the camera's clusters
+	int                 ClusteredLightCount{ 256 };
+	// threads recording the shadow views into secondary command buffers, zero picks the hardware concurrency. changes
+	// apply when the shadow maps are regenerated
+	int                 RecordingThreadCount{ 0 };
 };
 
 struct FrameData
@@ -85,6 +99,19 @@ struct LightData
 	std::vector<glm::mat4> LightSpaceMatrices;
 };
 
+// meshlet as the culling shader reads it, index range and vertex offset are absolute inside the GeometryArena,
+// surviving clusters are compacted behind the draw slot of the first cluster of their mesh
+struct Cluster
+{
+	glm::vec4 Sphere;
+	glm::vec4 Cone;
+	uint32_t  FirstIndex;
+	uint32_t  IndexCount;
+	int32_t   VertexOffset;
+	uint32_t  FirstMeshCluster;
+};
+
+// full precision vertex as imported, only used while building the scene
 struct Vertex
 {
 	glm::vec3 Position;
@@ -93,6 +120,16 @@ struct Vertex
 	glm::vec3 Normal;
 	glm::vec3 Tangent;
 	glm::vec3 Bitangent;
+};
+
+// 20 byte vertex the geometry pipelines fetch: position as unorm16 inside the scene bounds with the bitangent sign in w,
+// half float uv, normal and tangent octahedral encoded as snorm16
+struct PackedVertex
+{
+	uint16_t Position[4];
+	uint16_t UV[2];
+	int16_t  Normal[2];
+	int16_t  Tangent[2];
 
 	static std::span<VkVertexInputBindingDescription> GetBindingDescription()
 	{
@@ -100,7 +137,7 @@ struct Vertex
 		{
 			{
 				.binding = 0
-				, .stride = sizeof(Vertex)
+				, .stride = sizeof(PackedVertex)
 				, .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
 			}
 		};
@@ -115,32 +152,26 @@ struct Vertex
 			{
 				.location = 0
 				, .binding = 0
-				, .format = VK_FORMAT_R32G32B32_SFLOAT
-				, .offset = offsetof(Vertex, Position)
+				, .format = VK_FORMAT_R16G16B16A16_UNORM
+				, .offset = offsetof(PackedVertex, Position)
 			}
 			, {
 				.location = 1
 				, .binding = 0
-				, .format = VK_FORMAT_R32G32_SFLOAT
-				, .offset = offsetof(Vertex, UV)
+				, .format = VK_FORMAT_R16G16_SFLOAT
+				, .offset = offsetof(PackedVertex, UV)
 			}
 			, {
 				.location = 2
 				, .binding = 0
-				, .format = VK_FORMAT_R32G32B32_SFLOAT
-				, .offset = offsetof(Vertex, Normal)
+				, .format = VK_FORMAT_R16G16_SNORM
+				, .offset = offsetof(PackedVertex, Normal)
 			}
 			, {
 				.location = 3
 				, .binding = 0
-				, .format = VK_FORMAT_R32G32B32_SFLOAT
-				, .offset = offsetof(Vertex, Tangent)
-			}
-			, {
-				.location = 4
-				, .binding = 0
-				, .format = VK_FORMAT_R32G32B32_SFLOAT
-				, .offset = offsetof(Vertex, Bitangent)
+				, .format = VK_FORMAT_R16G16_SNORM
+				, .offset = offsetof(PackedVertex, Tangent)
 			}
 		};
 
@@ -0,0 +1,89 @@
+#ifndef VULKANRESEARCH_DEPTH_PYRAMID_H
+#define VULKANRESEARCH_DEPTH_PYRAMID_H
+
+#include <memory>
+#include <vector>
+
+#include "descriptor_pool.h"
+#include "descriptor_set.h"
+#include "descriptor_set_layout.h"
+#include "image.h"
+#include "image_view.h"
+#include "pipeline_layout.h"
+
+namespace vkc
+{
+	class CommandBuffer;
+	class PipelineCache;
+}
+
+// max reduction chain of the depth buffer for occlusion tests, every texel holds the farthest depth of the pixels it
+// covers. level 0 is half the depth resolution rounded up and every level halves the previous one the same way, so a
+// texel of level n covers exactly 2^(n+1) pixels on either axis and the edge texels are never missing a pixel
+class DepthPyramid final
+{
+public:
+	// every level of a pyramid up to 2^17 pixels on a side gets a descriptor set up front
+	static uint32_t constexpr MAX_LEVEL_COUNT{ 16 };
+
+	DepthPyramid() = delete;
+	DepthPyramid(vkc::Context& context, vkc::PipelineCache& cache);
+	~DepthPyramid() = default;
+
+	DepthPyramid(DepthPyramid&&)                 = delete;
+	DepthPyramid(DepthPyramid const&)            = delete;
+	DepthPyramid& operator=(DepthPyramid&&)      = delete;
+	DepthPyramid& operator=(DepthPyramid const&) = delete;
+
+	void Destroy();
+
+	// sizes the pyramid for the depth image the view belongs to, called again whenever it is recreated. expects the
+	// device to be idle when an earlier size is replaced
+	void Resize(vkc::Image const& depthImage, VkImageView depthView);
+
+	// reduces the depth written so far, expects the depth image as a depth attachment and leaves it as one. the pyramid
+	// is ready for compute shader reads once it returns
+	void Build(vkc::CommandBuffer const& commandBuffer, vkc::Image& depthImage);
+
+	// every level, in general layout
+	[[nodiscard]] VkImageView GetView() const
+	{
+		return *m_View;
+	}
+
+	[[nodiscard]] VkExtent2D GetDepthExtent() const
+	{
+		return m_DepthExtent;
+	}
+
+	[[nodiscard]] uint32_t GetLevelCount() const
+	{
+		return static_cast<uint32_t>(m_Levels.size());
+	}
+
+private:
+	struct Level
+	{
+		VkExtent2D     Extent;
+		vkc::ImageView View;
+	};
+
+	void CreatePipeline(vkc::PipelineCache& cache);
+	void DestroyImage();
+
+	vkc::Context& m_Context;
+	VkExtent2D    m_DepthExtent{};
+
+	std::unique_ptr<vkc::Image>     m_Image;
+	std::unique_ptr<vkc::ImageView> m_View;
+	std::vector<Level>              m_Levels;
+
+	// one per level, reading the depth image or the level before it
+	vkc::DescriptorSetLayout        m_DescriptorSetLayout;
+	vkc::DescriptorPool             m_DescriptorPool;
+	std::vector<vkc::DescriptorSet> m_DescriptorSets;
+	vkc::PipelineLayout             m_PipelineLayout;
+	VkPipeline                      m_Pipeline{};
+};
+
+#endif //VULKANRESEARCH_DEPTH_PYRAMID_H
@@ -0,0 +1,38 @@
+#ifndef VULKANRESEARCH_DRAW_SORTING_H
+#define VULKANRESEARCH_DRAW_SORTING_H
+
+#include <cstdint>
+#include <vector>
+
+// host side ordering of a view's draws by 64 bit keys, sorted with a least significant digit radix sort
+namespace draw_sorting
+{
+	enum class Order : uint32_t
+	{
+		// the order the scene's mesh list holds them in
+		Scene
+		// nearest first, so the depth test rejects the fragments of whatever they hide
+		, FrontToBack
+		// draws sharing their textures next to each other, nearest first among them
+		, MaterialMajor
+	};
+
+	// a key and what it sorts, the index of the draw in the caller's list
+	struct Item
+	{
+		uint64_t Key;
+		uint32_t Value;
+	};
+
+	// the state in the top 16 bits, then the material and the depth quantized to 16 bits in the order's priority. the
+	// scene order keeps only the state, the stable sort leaves the rest where it was. depth is any non negative value
+	// that grows with the distance from the view, such as clip space z. the material major order has room for 16 bits
+	// of material
+	[[nodiscard]] uint64_t MakeKey(Order order, uint16_t state, uint32_t material, float depth);
+
+	// stable, scratch is the second buffer the digits are scattered between. passes whose digit is the same for every
+	// key are skipped, so the unused bits of narrow keys cost nothing
+	void Sort(std::vector<Item>& items, std::vector<Item>& scratch);
+}
+
+#endif //VULKANRESEARCH_DRAW_SORTING_H
@@ -0,0 +1,78 @@
+#ifndef VULKANRESEARCH_FRUSTUM_CULLING_H
+#define VULKANRESEARCH_FRUSTUM_CULLING_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// host side frustum test of bounding spheres, several spheres per instruction with SSE or AVX
+namespace frustum_culling
+{
+	// gribb-hartmann planes, left right bottom top near far with depth in [0, 1], normalized so distances are in world units
+	using Planes = std::array<glm::vec4, 6>;
+
+	[[nodiscard]] Planes ExtractPlanes(glm::mat4 const& viewProjection);
+
+	// structure of arrays so the kernel loads a register of spheres per component. padded to a whole block with spheres
+	// that never pass, so the kernel has no scalar tail
+	class Spheres final
+	{
+	public:
+		// spheres tested per block, the widest register the build targets
+		static uint32_t constexpr BLOCK_SIZE{ 8 };
+
+		void Add(glm::vec4 const& sphere);
+		void Clear();
+
+		[[nodiscard]] uint32_t GetCount() const
+		{
+			return m_Count;
+		}
+
+		[[nodiscard]] float const* GetX() const
+		{
+			return m_X.data();
+		}
+
+		[[nodiscard]] float const* GetY() const
+		{
+			return m_Y.data();
+		}
+
+		[[nodiscard]] float const* GetZ() const
+		{
+			return m_Z.data();
+		}
+
+		[[nodiscard]] float const* GetRadius() const
+		{
+			return m_Radius.data();
+		}
+
+		// a multiple of BLOCK_SIZE
+		[[nodiscard]] uint32_t GetPaddedCount() const
+		{
+			return static_cast<uint32_t>(m_X.size());
+		}
+
+	private:
+		std::vector<float> m_X;
+		std::vector<float> m_Y;
+		std::vector<float> m_Z;
+		std::vector<float> m_Radius;
+		uint32_t           m_Count{};
+	};
+
+	// replaces visible with the ascending indices of the spheres intersecting the frustum
+	void Cull(Planes const& planes, Spheres const& spheres, std::vector<uint32_t>& visible);
+
+	// one sphere at a time, the reference the vectorized kernel is measured against
+	void CullScalar(Planes const& planes, Spheres const& spheres, std::vector<uint32_t>& visible);
+
+	// name of the instruction set Cull was built for
+	[[nodiscard]] char const* GetInstructionSet();
+}
+
+#endif //VULKANRESEARCH_FRUSTUM_CULLING_H
@@ -0,0 +1,105 @@
+#ifndef VULKANRESEARCH_GEOMETRY_ARENA_H
+#define VULKANRESEARCH_GEOMETRY_ARENA_H
+
+#include "buffer.h"
+#include "staging_ring.h"
+
+class Uploader;
+
+// one device local vertex buffer and one index buffer shared by every mesh of the scene, sized once at load.
+// 16 bit indices are packed in front of the 32 bit ones so a pass binds the index buffer at most twice,
+// the clusters of every mesh live next to them in a storage buffer for the culling pass
+class GeometryArena final
+{
+public:
+	struct Range
+	{
+		uint32_t FirstIndex;
+		int32_t  VertexOffset;
+	};
+
+	GeometryArena() = delete;
+	GeometryArena(vkc::Context& context, uint64_t vertexCount, uint64_t shortIndexCount, uint64_t indexCount, uint64_t clusterCount);
+	~GeometryArena() = default;
+
+	GeometryArena(GeometryArena&&)                 = delete;
+	GeometryArena(GeometryArena const&)            = delete;
+	GeometryArena& operator=(GeometryArena&&)      = delete;
+	GeometryArena& operator=(GeometryArena const&) = delete;
+
+	// records the copies out of staging and returns where the mesh landed, first index is relative to the section
+	// BindIndexBuffer binds for the index type
+	[[nodiscard]] Range Upload
+	(
+		vkc::CommandBuffer const&        commandBuffer
+		, StagingRing::Allocation const& vertices
+		, StagingRing::Allocation const& indices
+		, VkIndexType                    indexType
+	);
+
+	// appended after the clusters uploaded so far, GetClusterCount is the index of the first one
+	void UploadClusters(vkc::CommandBuffer const& commandBuffer, StagingRing::Allocation const& clusters);
+
+	// hands the ranges written since the previous call over to the graphics queue with the uploader's current batch,
+	// ranges uploaded by later batches are still written while the earlier ones are drawn from
+	void ReleaseWritten(Uploader& uploader);
+
+	// plain handles, so the passes can be recorded into secondary command buffers
+	void BindVertexBuffer(VkCommandBuffer commandBuffer) const;
+	void BindIndexBuffer(VkCommandBuffer commandBuffer, VkIndexType indexType) const;
+
+	[[nodiscard]] vkc::Buffer const& GetVertexBuffer() const
+	{
+		return m_VertexBuffer;
+	}
+
+	[[nodiscard]] vkc::Buffer const& GetIndexBuffer() const
+	{
+		return m_IndexBuffer;
+	}
+
+	[[nodiscard]] vkc::Buffer const& GetClusterBuffer() const
+	{
+		return m_ClusterBuffer;
+	}
+
+	[[nodiscard]] uint32_t GetClusterCount() const
+	{
+		return m_ClusterCount;
+	}
+
+	// clusters the arena was sized for, the count reaches it once every mesh is uploaded
+	[[nodiscard]] uint32_t GetClusterCapacity() const
+	{
+		return m_ClusterCapacity;
+	}
+
+	[[nodiscard]] VkDeviceSize GetSize() const
+	{
+		return m_VertexBuffer.GetSize() + m_IndexBuffer.GetSize() + m_ClusterBuffer.GetSize();
+	}
+
+private:
+	vkc::Context& m_Context;
+
+	VkDeviceSize m_IndexSectionOffset{};
+
+	vkc::Buffer m_VertexBuffer;
+	vkc::Buffer m_IndexBuffer;
+	vkc::Buffer m_ClusterBuffer;
+
+	uint32_t m_ClusterCapacity;
+
+	uint32_t m_VertexCount{};
+	uint32_t m_ShortIndexCount{};
+	uint32_t m_IndexCount{};
+	uint32_t m_ClusterCount{};
+
+	// counts at the last ReleaseWritten
+	uint32_t m_ReleasedVertexCount{};
+	uint32_t m_ReleasedShortIndexCount{};
+	uint32_t m_ReleasedIndexCount{};
+	uint32_t m_ReleasedClusterCount{};
+};
+
+#endif //VULKANRESEARCH_GEOMETRY_ARENA_H
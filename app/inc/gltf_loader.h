@@ -0,0 +1,20 @@
+#ifndef VULKANRESEARCH_GLTF_LOADER_H
+#define VULKANRESEARCH_GLTF_LOADER_H
+
+#include <string_view>
+
+#include "scene_data.h"
+
+// native glTF 2.0 reader: the JSON is parsed once, buffers stay memory mapped and accessors are converted straight into
+// the importer's vertex layout, normals and tangents the file provides are used as they are
+namespace gltf_loader
+{
+	// .gltf with external or base64 embedded buffers and binary .glb
+	[[nodiscard]] bool CanLoad(std::string_view filename);
+
+	// reads every triangle primitive reachable from the default scene, one mesh per primitive and node it is
+	// instanced by, materials map onto the same texture table the Assimp import builds. throws on malformed files
+	[[nodiscard]] SourceScene Load(std::string_view filename);
+}
+
+#endif //VULKANRESEARCH_GLTF_LOADER_H
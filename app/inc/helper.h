@@ -1,32 +1,23 @@
 #ifndef HELPER_H
 #define HELPER_H
 #include <format>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <span>
 
 #include "vulkan/vulkan_core.h"
 #include "Context.h"
+#include "mapped_file.h"
 
 namespace help
 {
-	[[nodiscard]] inline std::vector<char> ReadFile(const std::string& filename)
+	// for the vkc classes that own their code, copied once straight out of a mapping. everything that only reads the
+	// file during a call takes a MappedFile view instead
+	[[nodiscard]] inline std::vector<char> ReadFile(std::string_view filename)
 	{
-		std::ifstream file(filename, std::ios::ate | std::ios::binary);
-
-		if (!file.is_open())
-			throw std::runtime_error("failed to open file " + filename);
-
-		std::streampos const fileSize{ file.tellg() };
-		std::vector<char>    buffer(fileSize);
-
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-
-		file.close();
-
-		return buffer;
+		MappedFile const file{ filename };
+		auto const       data = file.GetView<char>(0, file.GetSize());
+		return { data.begin(), data.end() };
 	}
 
 	[[nodiscard]] inline std::string UUIDToHex(std::span<std::uint8_t> uuidBytes)
@@ -57,6 +48,60 @@ namespace help
 		throw std::runtime_error("failed to find supported format");
 	}
 
+	// for the few buffers allocated outside of vma because the cpu keeps a pointer into them
+	inline uint32_t FindMemoryType(vkc::Context const& context, uint32_t typeBits, VkMemoryPropertyFlags properties)
+	{
+		VkPhysicalDeviceMemoryProperties const& memoryProperties = context.Device.physical_device.memory_properties;
+		for (uint32_t index{}; index < memoryProperties.memoryTypeCount; ++index)
+			if ((typeBits & 1u << index) != 0 && (memoryProperties.memoryTypes[index].propertyFlags & properties) == properties)
+				return index;
+		throw std::runtime_error("no memory type with the requested properties");
+	}
+
+	// host visible, coherent and persistently mapped, zeroed on creation
+	struct MappedBuffer
+	{
+		VkBuffer       Buffer;
+		VkDeviceMemory Memory;
+		void*          Data;
+	};
+
+	[[nodiscard]] MappedBuffer CreateMappedBuffer
+	(
+		vkc::Context const&  context
+		, VkDeviceSize       size
+		, VkBufferUsageFlags usage
+		, std::string const& name
+	);
+	void DestroyMappedBuffer(vkc::Context const& context, MappedBuffer const& buffer);
+
+	// one compute pipeline per specialization of the SPIR-V at the path, named after the matching entry of names
+	void CreateComputePipelines
+	(
+		vkc::Context const&                     context
+		, VkPipelineCache                       cache
+		, VkPipelineLayout                      layout
+		, std::string const&                    shaderPath
+		, std::span<VkSpecializationInfo const> specializations
+		, std::span<std::string_view const>     names
+		, std::span<VkPipeline>                 outPipelines
+	);
+
+	[[nodiscard]] inline VkPipeline CreateComputePipeline
+	(
+		vkc::Context const&           context
+		, VkPipelineCache             cache
+		, VkPipelineLayout            layout
+		, std::string const&          shaderPath
+		, std::string_view            name
+		, VkSpecializationInfo const& specialization = {}
+	)
+	{
+		VkPipeline pipeline{};
+		CreateComputePipelines(context, cache, layout, shaderPath, { &specialization, 1 }, { &name, 1 }, { &pipeline, 1 });
+		return pipeline;
+	}
+
 	inline bool HasStencilComponent(VkFormat format)
 	{
 		return format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
@@ -64,13 +109,19 @@ namespace help
 
 	struct ImageData
 	{
+		ImageData() = default;
 		~ImageData();
 
-		int            Width;
-		int            Height;
-		int            Channels;
-		unsigned char* Pixels;
-		VkDeviceSize   Size;
+		ImageData(ImageData&& other) noexcept;
+		ImageData(ImageData const&)            = delete;
+		ImageData& operator=(ImageData&& other) noexcept;
+		ImageData& operator=(ImageData const&) = delete;
+
+		int            Width{};
+		int            Height{};
+		int            Channels{};
+		unsigned char* Pixels{};
+		VkDeviceSize   Size{};
 	};
 
 	ImageData LoadImage(std::string_view path);
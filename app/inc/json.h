@@ -0,0 +1,89 @@
+#ifndef VULKANRESEARCH_JSON_H
+#define VULKANRESEARCH_JSON_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// minimal JSON reader for scene description files: the whole document is parsed into a tree once, numbers are doubles
+namespace json
+{
+	class Value final
+	{
+	public:
+		using Array  = std::vector<Value>;
+		// members in document order, files like glTF keep objects small so lookups scan them
+		using Object = std::vector<std::pair<std::string, Value>>;
+
+		Value() = default;
+
+		explicit Value(bool value)
+			: m_Value{ value } {}
+
+		explicit Value(double value)
+			: m_Value{ value } {}
+
+		explicit Value(std::string value)
+			: m_Value{ std::move(value) } {}
+
+		explicit Value(Array value)
+			: m_Value{ std::move(value) } {}
+
+		explicit Value(Object value)
+			: m_Value{ std::move(value) } {}
+
+		[[nodiscard]] bool IsNull() const
+		{
+			return std::holds_alternative<std::monostate>(m_Value);
+		}
+
+		[[nodiscard]] bool IsNumber() const
+		{
+			return std::holds_alternative<double>(m_Value);
+		}
+
+		[[nodiscard]] bool IsString() const
+		{
+			return std::holds_alternative<std::string>(m_Value);
+		}
+
+		[[nodiscard]] bool IsArray() const
+		{
+			return std::holds_alternative<Array>(m_Value);
+		}
+
+		[[nodiscard]] bool IsObject() const
+		{
+			return std::holds_alternative<Object>(m_Value);
+		}
+
+		// every getter throws when the value holds another type
+		[[nodiscard]] bool               GetBool() const;
+		[[nodiscard]] double             GetNumber() const;
+		[[nodiscard]] uint32_t           GetUint() const;
+		[[nodiscard]] std::string const& GetString() const;
+		[[nodiscard]] Array const&       GetArray() const;
+		[[nodiscard]] Object const&      GetObject() const;
+
+		// nullptr when the member is missing or the value is not an object
+		[[nodiscard]] Value const* Find(std::string_view key) const;
+
+		// throws when the member is missing
+		[[nodiscard]] Value const& operator[](std::string_view key) const;
+		[[nodiscard]] Value const& operator[](size_t index) const;
+
+		[[nodiscard]] uint32_t GetUint(std::string_view key, uint32_t fallback) const;
+		[[nodiscard]] double   GetNumber(std::string_view key, double fallback) const;
+
+	private:
+		std::variant<std::monostate, bool, double, std::string, Array, Object> m_Value;
+	};
+
+	// throws on malformed input with the byte offset of the error
+	[[nodiscard]] Value Parse(std::string_view text);
+}
+
+#endif //VULKANRESEARCH_JSON_H
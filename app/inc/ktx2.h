@@ -0,0 +1,42 @@
+#ifndef VULKANRESEARCH_KTX2_H
+#define VULKANRESEARCH_KTX2_H
+
+#include <string_view>
+
+#include "mapped_file.h"
+#include "texture_mips.h"
+#include "vulkan/vulkan_core.h"
+
+// minimal KTX2 container support for cooked textures: single 2D image with a full mip chain, no supercompression,
+// only the block compressed formats the texture cooker produces
+namespace ktx2
+{
+	struct Texture
+	{
+		VkFormat            Format;
+		texture_mips::Chain Chain;
+	};
+
+	// cooked file kept mapped, level offsets describe the packed level 0 first layout CopyLevels writes
+	struct MappedTexture
+	{
+		VkFormat                         Format;
+		std::vector<texture_mips::Level> Levels;
+		std::vector<uint64_t>            FileOffsets;
+		MappedFile                       File;
+	};
+
+	// level sizes in the chain are in bytes of the block compressed format
+	void Write(std::string_view path, Texture const& texture);
+
+	// throws if the file is missing, malformed or uses a format the renderer does not cook
+	[[nodiscard]] MappedTexture Open(std::string_view path);
+
+	// copies the levels from firstLevel down to the smallest straight out of the mapping, packed back to back from the
+	// start of destination the same way they are laid out after firstLevel in the whole chain
+	void CopyLevels(MappedTexture const& texture, uint32_t firstLevel, std::span<std::byte> destination);
+
+	[[nodiscard]] uint32_t GetBlockSize(VkFormat format);
+}
+
+#endif //VULKANRESEARCH_KTX2_H
@@ -0,0 +1,117 @@
+#ifndef VULKANRESEARCH_LIGHT_CLUSTERING_H
+#define VULKANRESEARCH_LIGHT_CLUSTERING_H
+
+#include <span>
+#include <vector>
+
+#include "buffer.h"
+#include "descriptor_pool.h"
+#include "descriptor_set.h"
+#include "descriptor_set_layout.h"
+#include "helper.h"
+#include "pipeline_layout.h"
+#include "glm/glm.hpp"
+
+namespace vkc
+{
+	class PipelineCache;
+}
+
+// assigns bounded point lights to the clusters of the camera frustum in a compute pass, so the lighting pass shades a
+// pixel with the lights of its cluster instead of every light in the scene. the clusters are GRID_X by GRID_Y tiles of
+// the screen cut into GRID_Z slices whose depth grows exponentially from the near to the far plane, each lists at
+// most MAX_LIGHTS_PER_CLUSTER lights. the light count is only known when a frame is recorded, so changing it needs no
+// new pipeline
+class LightClusterer final
+{
+public:
+	static uint32_t constexpr GRID_X{ 16 };
+	static uint32_t constexpr GRID_Y{ 9 };
+	static uint32_t constexpr GRID_Z{ 24 };
+	static uint32_t constexpr CLUSTER_COUNT{ GRID_X * GRID_Y * GRID_Z };
+	static uint32_t constexpr MAX_LIGHTS_PER_CLUSTER{ 128 };
+	// size of every frame's light buffer
+	static uint32_t constexpr MAX_LIGHT_COUNT{ 4096 };
+
+	// as the shaders read it, the light does not reach past its radius
+	struct PointLight
+	{
+		glm::vec4 PositionRadius;
+		// luminous flux in lumen in w
+		glm::vec4 Colour;
+	};
+
+	struct Statistics
+	{
+		// summed over every cluster, lights dropped from full clusters excluded
+		uint32_t AssignedLights;
+		uint32_t MaxClusterLights;
+		// clusters that were touched by more than MAX_LIGHTS_PER_CLUSTER lights
+		uint32_t OverflowingClusters;
+	};
+
+	LightClusterer() = delete;
+	// one frame in flight per camera buffer, each holding the frame's ModelViewProj
+	LightClusterer(vkc::Context& context, std::span<VkBuffer const> cameraBuffers, vkc::PipelineCache& cache);
+	~LightClusterer() = default;
+
+	LightClusterer(LightClusterer&&)                 = delete;
+	LightClusterer(LightClusterer const&)            = delete;
+	LightClusterer& operator=(LightClusterer&&)      = delete;
+	LightClusterer& operator=(LightClusterer const&) = delete;
+
+	void Destroy();
+
+	// copies the lights the frame is shaded with, the first MAX_LIGHT_COUNT of them. the frame's previous submission
+	// must have completed
+	void Update(uint32_t frame, std::span<PointLight const> lights);
+
+	// fills the light lists of every cluster for the frame's camera, the lighting pass may read them once it returns
+	void Build(VkCommandBuffer commandBuffer, uint32_t frame) const;
+
+	// the frame's lights, the count of every cluster and its light indices as fragment stage storage buffers at
+	// bindings 0 to 2, added to the lighting pipeline's layout
+	[[nodiscard]] vkc::DescriptorSetLayout const& GetLightingDescriptorSetLayout() const
+	{
+		return m_LightingDescriptorSetLayout;
+	}
+
+	[[nodiscard]] VkDescriptorSet GetLightingDescriptorSet(uint32_t frame) const
+	{
+		return m_LightingDescriptorSets[frame];
+	}
+
+	// counts written by the last completed Build
+	[[nodiscard]] Statistics GetStatistics() const;
+
+private:
+	struct PushConstants
+	{
+		uint32_t LightCount;
+	};
+
+	void CreatePipeline(vkc::PipelineCache& cache);
+
+	vkc::Context& m_Context;
+	uint32_t      m_FrameCount;
+
+	// host written every frame, one per frame in flight
+	std::vector<help::MappedBuffer> m_Lights;
+	std::vector<uint32_t>           m_LightCounts;
+	// light count and MAX_LIGHTS_PER_CLUSTER light indices per cluster, rebuilt every frame
+	vkc::Buffer m_LightGridBuffer;
+	vkc::Buffer m_LightIndexBuffer;
+	// assigned, most per cluster and overflowing clusters, host visible so they can be shown without a readback copy
+	help::MappedBuffer m_Statistics{};
+
+	vkc::DescriptorSetLayout        m_DescriptorSetLayout;
+	vkc::DescriptorSetLayout        m_LightingDescriptorSetLayout;
+	vkc::DescriptorPool             m_DescriptorPool;
+	// one per frame in flight, the frame's camera and lights for the build
+	std::vector<vkc::DescriptorSet> m_DescriptorSets;
+	std::vector<vkc::DescriptorSet> m_LightingDescriptorSets;
+	vkc::PipelineLayout             m_PipelineLayout;
+	VkPipeline                      m_Pipeline{};
+};
+
+#endif //VULKANRESEARCH_LIGHT_CLUSTERING_H
@@ -0,0 +1,51 @@
+#ifndef VULKANRESEARCH_MAPPED_FILE_H
+#define VULKANRESEARCH_MAPPED_FILE_H
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+// read-only memory mapping of a whole file, unmapped on destruction
+class MappedFile final
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(std::string_view path);
+	~MappedFile();
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(MappedFile const&)            = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+
+	[[nodiscard]] std::span<std::byte const> GetData() const
+	{
+		return { m_Data, m_Size };
+	}
+
+	[[nodiscard]] size_t GetSize() const
+	{
+		return m_Size;
+	}
+
+	template<typename T>
+	[[nodiscard]] std::span<T const> GetView(size_t offset, size_t count) const
+	{
+		if (offset + count * sizeof(T) > m_Size || offset % alignof(T) != 0)
+			throw std::runtime_error("mapped view is out of bounds");
+		return { reinterpret_cast<T const*>(m_Data + offset), count };
+	}
+
+private:
+	void Unmap();
+
+	std::byte const* m_Data{};
+	size_t           m_Size{};
+#ifdef _WIN32
+	void* m_File{};
+	void* m_Mapping{};
+#endif
+};
+
+#endif //VULKANRESEARCH_MAPPED_FILE_H
@@ -3,19 +3,32 @@
 
 #include <vector>
 
-#include "buffer.h"
 #include "datatypes.h"
 
+// draw range inside the scene's GeometryArena
 class Mesh final
 {
 public:
+	// cluster range of one level of the LOD chain, Error is in object space units
+	struct Lod
+	{
+		uint32_t FirstCluster;
+		uint32_t ClusterCount;
+		uint32_t IndexCount;
+		float    Error;
+	};
+
 	Mesh
 	(
-		vkc::Context&               context
-		, vkc::CommandBuffer const& commandBuffer
-		, std::vector<Vertex>&&     vertices, vkc::Buffer const& stagingVert
-		, std::vector<uint32_t>&&   indices, vkc::Buffer const&  stagingIndex
-		, TextureIndices            textureIndices
+		uint32_t           firstIndex
+		, int32_t          vertexOffset
+		, uint32_t         indexCount
+		, VkIndexType      indexType
+		, uint32_t         firstCluster
+		, uint32_t         clusterCount
+		, std::vector<Lod> lods
+		, glm::vec4 const& bounds
+		, TextureIndices   textureIndices
 	);
 	~Mesh() = default;
 
@@ -24,16 +37,48 @@ public:
 	Mesh& operator=(Mesh&&)      = delete;
 	Mesh& operator=(Mesh const&) = delete;
 
-	[[nodiscard]] vkc::Buffer const& GetVertexBuffer() const
+	// relative to the arena section of the mesh's index type
+	[[nodiscard]] uint32_t GetFirstIndex() const
+	{
+		return m_FirstIndex;
+	}
+
+	[[nodiscard]] int32_t GetVertexOffset() const
+	{
+		return m_VertexOffset;
+	}
+
+	[[nodiscard]] uint32_t GetIndexCount() const
+	{
+		return m_IndexCount;
+	}
+
+	// 16 bit whenever the mesh has fewer than 65536 vertices
+	[[nodiscard]] VkIndexType GetIndexType() const
 	{
-		return m_VertexBuffer;
+		return m_IndexType;
 	}
 
-	[[nodiscard]] vkc::Buffer const& GetIndexBuffer() const
+	// the clusters of every LOD of the mesh are consecutive in the arena's cluster buffer
+	[[nodiscard]] uint32_t GetFirstCluster() const
 	{
-		return m_IndexBuffer;
+		return m_FirstCluster;
 	}
 
+	[[nodiscard]] uint32_t GetClusterCount() const
+	{
+		return m_ClusterCount;
+	}
+
+	[[nodiscard]] std::vector<Lod> const& GetLods() const
+	{
+		return m_Lods;
+	}
+
+	// coarsest level whose error projects to at most pixelError pixels on a render target viewportHeight pixels high,
+	// works for perspective and orthographic projections alike
+	[[nodiscard]] uint32_t SelectLod(glm::mat4 const& viewProjection, float viewportHeight, float pixelError) const;
+
 	void SetRotation(glm::vec3 const& rotation);
 
 	void Rotate(glm::vec3 const& rotation);
@@ -51,6 +96,12 @@ public:
 		return m_TextureIndices;
 	}
 
+	// bounding sphere of every LOD, center in xyz and radius in w
+	[[nodiscard]] glm::vec4 const& GetBounds() const
+	{
+		return m_Bounds;
+	}
+
 	glm::mat4 GetModelMatrix();
 
 private:
@@ -59,11 +110,15 @@ private:
 	glm::vec3 m_Scale{};
 	glm::mat4 m_ModelMatrix{};
 
-	std::vector<Vertex> m_Vertices;
-	vkc::Buffer         m_VertexBuffer;
+	uint32_t    m_FirstIndex;
+	int32_t     m_VertexOffset;
+	uint32_t    m_IndexCount;
+	VkIndexType m_IndexType;
+	uint32_t    m_FirstCluster;
+	uint32_t    m_ClusterCount;
 
-	std::vector<uint32_t> m_Indices;
-	vkc::Buffer           m_IndexBuffer;
+	std::vector<Lod> m_Lods;
+	glm::vec4        m_Bounds;
 
 	TextureIndices m_TextureIndices;
 
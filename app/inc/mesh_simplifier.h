@@ -0,0 +1,25 @@
+#ifndef VULKANRESEARCH_MESH_SIMPLIFIER_H
+#define VULKANRESEARCH_MESH_SIMPLIFIER_H
+
+#include <span>
+#include <vector>
+
+#include "datatypes.h"
+
+// quadric error edge-collapse decimation producing the coarser levels of a mesh's LOD chain
+namespace mesh_simplifier
+{
+	struct Result
+	{
+		std::vector<uint32_t> Indices;
+		// object space distance the simplified surface may deviate from the source by
+		float Error;
+	};
+
+	// collapses edges onto one of their endpoints, cheapest first, until targetIndexCount is reached or nothing collapses
+	// without flipping a triangle. only indices change so every level shares the source vertices, vertices on uv seams
+	// and open borders are locked to keep the silhouette and the texture layout intact
+	[[nodiscard]] Result Simplify(std::span<Vertex const> vertices, std::span<uint32_t const> indices, size_t targetIndexCount);
+}
+
+#endif //VULKANRESEARCH_MESH_SIMPLIFIER_H
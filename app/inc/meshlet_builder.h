@@ -0,0 +1,21 @@
+#ifndef VULKANRESEARCH_MESHLET_BUILDER_H
+#define VULKANRESEARCH_MESHLET_BUILDER_H
+
+#include <span>
+#include <vector>
+
+#include "scene_data.h"
+
+// splits meshes into clusters small enough to be culled individually on the gpu
+namespace meshlet_builder
+{
+	uint32_t constexpr MAX_VERTICES{ 64 };
+	uint32_t constexpr MAX_TRIANGLES{ 124 };
+
+	// triangles are taken in index order, the importer already sorts them for vertex cache locality, so every meshlet
+	// is a contiguous range of the mesh's indices and nothing has to be reordered.
+	// bounds are grown by padding to stay conservative for the quantized positions the gpu renders
+	[[nodiscard]] std::vector<Meshlet> Build(std::span<Vertex const> vertices, std::span<uint32_t const> indices, float padding);
+}
+
+#endif //VULKANRESEARCH_MESHLET_BUILDER_H
@@ -0,0 +1,57 @@
+#ifndef VULKANRESEARCH_PARALLEL_RECORDER_H
+#define VULKANRESEARCH_PARALLEL_RECORDER_H
+
+#include <functional>
+#include <vector>
+
+#include "context.h"
+#include "thread_pool.h"
+
+// records the items of a pass on worker threads, every worker owns a command pool and fills one secondary command
+// buffer per Record with a contiguous range of the items. the primary executes the buffers in range order, so the
+// commands end up in the order a serial loop would have recorded them
+class ParallelRecorder final
+{
+public:
+	// records the items [first, last) into the secondary command buffer
+	using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t last)>;
+
+	ParallelRecorder() = delete;
+	// zero workers picks the hardware concurrency
+	ParallelRecorder(vkc::Context& context, uint32_t queueFamily, uint32_t workerCount = 0);
+	~ParallelRecorder() = default;
+
+	ParallelRecorder(ParallelRecorder&&)                 = delete;
+	ParallelRecorder(ParallelRecorder const&)            = delete;
+	ParallelRecorder& operator=(ParallelRecorder&&)      = delete;
+	ParallelRecorder& operator=(ParallelRecorder const&) = delete;
+
+	void Destroy();
+
+	// splits count items into at most one range per worker and executes the recorded buffers from the primary, returns
+	// once every range is recorded. the secondary buffers are begun outside of any rendering, so items begin their own
+	void Record(VkCommandBuffer primary, uint32_t count, RecordFunction const& record);
+
+	// recycles the buffers of every Record since the previous reset, the submissions executing them must have completed
+	void Reset();
+
+	[[nodiscard]] uint32_t GetWorkerCount() const
+	{
+		return static_cast<uint32_t>(m_Workers.size());
+	}
+
+private:
+	// only touched by the job recording the worker's range
+	struct Worker
+	{
+		VkCommandPool                CommandPool;
+		std::vector<VkCommandBuffer> CommandBuffers;
+		uint32_t                     UsedCount;
+	};
+
+	vkc::Context&       m_Context;
+	ThreadPool          m_ThreadPool;
+	std::vector<Worker> m_Workers;
+};
+
+#endif //VULKANRESEARCH_PARALLEL_RECORDER_H
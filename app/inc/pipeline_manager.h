@@ -0,0 +1,175 @@
+#ifndef VULKANRESEARCH_PIPELINE_MANAGER_H
+#define VULKANRESEARCH_PIPELINE_MANAGER_H
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "context.h"
+#include "pipeline.h"
+#include "thread_pool.h"
+
+namespace vkc
+{
+	class PipelineCache;
+}
+
+// pipelines requested by key are compiled on background threads through the shared pipeline cache, passes ask for them
+// every frame and get a designated fallback until they are ready. finished compiles are published at a frame boundary
+// and replaced pipelines destroyed once no frame in flight can still reference them
+class PipelineManager final
+{
+public:
+	// runs on a worker thread, may only read state that does not change while the render loop runs. the cache is the
+	// worker's own, seeded from the shared one
+	using Builder = std::function<vkc::Pipeline(vkc::PipelineCache& cache)>;
+
+	struct Statistics
+	{
+		std::string Key;
+		double      CompileMilliseconds;
+		// the driver found the pipeline in the cache, judged by the worker's cache data not growing
+		bool     CacheHit;
+		uint32_t Builds;
+		bool     Ready;
+	};
+
+	PipelineManager() = delete;
+	// zero threads picks the hardware concurrency
+	PipelineManager(vkc::Context& context, vkc::PipelineCache& cache, uint32_t framesInFlight, uint32_t threadCount = 0);
+	~PipelineManager();
+
+	PipelineManager(PipelineManager&&)                 = delete;
+	PipelineManager(PipelineManager const&)            = delete;
+	PipelineManager& operator=(PipelineManager&&)      = delete;
+	PipelineManager& operator=(PipelineManager const&) = delete;
+
+	// starts compiling unless the key was already requested. shaders are the source names the pipeline is built from,
+	// the fallback is used in its place until it is ready
+	void Request(std::string const& key, std::vector<std::string> shaders, Builder builder, std::string fallback = {});
+	// compiles every requested pipeline built from the shader again, the current ones stay in use meanwhile.
+	// safe to call from any thread, returns how many were queued
+	uint32_t RebuildUsing(std::string const& shader);
+
+	// blocks until every compile queued so far finished and publishes them, for pipelines needed before the first frame
+	void Wait();
+	// once the frame's fence is signaled: publishes finished compiles
+	void Update();
+
+	[[nodiscard]] bool IsReady(std::string const& key) const;
+	// the pipeline, or its fallback while it compiles. throws when neither is ready
+	[[nodiscard]] vkc::Pipeline& Get(std::string const& key) const;
+
+	[[nodiscard]] std::vector<Statistics> GetStatistics() const;
+	[[nodiscard]] uint32_t                GetCacheHits() const;
+	[[nodiscard]] uint32_t                GetCacheMisses() const;
+
+	// pipelines that are not kept by key, such as the ones only needed while loading, compiled on the same workers with
+	// the same caches. the caller owns the result
+	template<typename Function>
+	[[nodiscard]] std::future<std::invoke_result_t<Function, vkc::PipelineCache&>> Compile(Function&& function)
+	{
+		return m_ThreadPool.Submit([this, function = std::forward<Function>(function)]() mutable
+		{
+			CacheLease const lease{ *this };
+			return function(lease.Cache);
+		});
+	}
+
+	// folds what the workers compiled into the shared cache so it can be written back, expects no compiles in flight
+	void MergeCaches();
+
+	// expects the device to be idle
+	void Destroy();
+
+private:
+	struct Entry
+	{
+		std::vector<std::string> Shaders;
+		Builder                  Build;
+		std::string              Fallback;
+		// only touched by the render thread
+		std::unique_ptr<vkc::Pipeline> Pipeline;
+
+		uint64_t Requested{};
+		uint64_t Published{};
+		double   CompileMilliseconds{};
+		bool     CacheHit{};
+		uint32_t Builds{};
+	};
+
+	struct CompiledPipeline
+	{
+		std::string   Key;
+		uint64_t      Generation;
+		vkc::Pipeline Pipeline;
+		double        Milliseconds;
+		bool          CacheHit;
+	};
+
+	struct RetiredPipeline
+	{
+		vkc::Pipeline Pipeline;
+		uint64_t      Frame;
+	};
+
+	// a worker holds a cache for the length of one build, so it sees no other build's additions
+	struct CacheLease
+	{
+		explicit CacheLease(PipelineManager& manager)
+			: Manager{ manager }
+			, Cache{ manager.AcquireCache() } {}
+
+		~CacheLease()
+		{
+			Manager.ReleaseCache(Cache);
+		}
+
+		CacheLease(CacheLease&&)                 = delete;
+		CacheLease(CacheLease const&)            = delete;
+		CacheLease& operator=(CacheLease&&)      = delete;
+		CacheLease& operator=(CacheLease const&) = delete;
+
+		PipelineManager&    Manager;
+		vkc::PipelineCache& Cache;
+	};
+
+	// expects the mutex to be held
+	void Submit(std::string const& key, Entry& entry);
+	void Publish();
+	[[nodiscard]] vkc::PipelineCache& AcquireCache();
+	void                              ReleaseCache(vkc::PipelineCache& cache);
+	[[nodiscard]] size_t              GetCacheSize(vkc::PipelineCache& cache) const;
+
+	vkc::Context&       m_Context;
+	vkc::PipelineCache& m_Cache;
+	uint32_t            m_FramesInFlight;
+
+	// a map keeps entries in place while their keys are looked up from other threads
+	std::map<std::string, Entry>   m_Entries;
+	std::vector<CompiledPipeline>  m_Compiled;
+	std::deque<RetiredPipeline>    m_Retired;
+	std::vector<std::future<void>> m_Pending;
+	mutable std::mutex             m_Mutex;
+
+	// every worker cache starts from the shared cache's contents, so a warm start hits on any thread
+	std::vector<char>                                m_CacheSeed;
+	std::vector<std::unique_ptr<vkc::PipelineCache>> m_WorkerCaches;
+	std::vector<vkc::PipelineCache*>                 m_FreeCaches;
+	std::mutex                                       m_CacheMutex;
+
+	uint32_t m_CacheHits{};
+	uint32_t m_CacheMisses{};
+	uint64_t m_Frame{};
+
+	// last so queued compiles finish before the state they report to is gone
+	ThreadPool m_ThreadPool;
+};
+
+#endif //VULKANRESEARCH_PIPELINE_MANAGER_H
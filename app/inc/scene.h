@@ -1,23 +1,44 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include <chrono>
+#include <deque>
+#include <future>
 #include <list>
+#include <memory>
 #include <string>
+#include <utility>
+#include <variant>
 
+#include "cooked_scene.h"
+#include "frustum_culling.h"
+#include "geometry_arena.h"
 #include "mesh.h"
+#include "scene_data.h"
+#include "texture_streaming.h"
+#include "thread_pool.h"
+#include "uploader.h"
 
 #include "command_pool.h"
 #include "context.h"
-#include "assimp/material.h"
-
-struct aiNode;
-struct aiScene;
 
 class Scene final
 {
 public:
+	struct LoadStats
+	{
+		double ColdImportDuration{};
+		// from opening the cooked scene until every mesh can be drawn
+		double CachedLoadDuration{};
+		// wall time of the parallel texture load phase (cooked read or decode and mip generation) and the sum of every image's time on its worker
+		double TextureDecodeWallDuration{};
+		double TextureDecodeSummedDuration{};
+		bool   LoadedFromCache{};
+	};
+
 	Scene() = delete;
-	Scene(vkc::Context& context, vkc::CommandPool& commandPool);
+	// frames in flight size the texture streamer's feedback
+	Scene(vkc::Context& context, Uploader& uploader, uint32_t framesInFlight);
 	~Scene() = default;
 
 	Scene(Scene&&)                 = delete;
@@ -25,8 +46,26 @@ public:
 	Scene& operator=(Scene&&)      = delete;
 	Scene& operator=(Scene const&) = delete;
 
+	// records the whole scene and waits for the transfer queue, the first frame shows all of it
 	void Load(std::string_view filename);
 
+	// opens or cooks the scene and sizes its resources, textures show a placeholder until ContinueLoading hands their
+	// levels over and meshes are only drawn once ContinueLoading uploaded them
+	void Open(std::string_view filename);
+
+	// once per frame while loading: passes decoded textures to the streamer, records and submits the next batch of
+	// meshes and makes the meshes of completed batches visible
+	void ContinueLoading();
+
+	// every mesh can be drawn
+	[[nodiscard]] bool IsGeometryLoaded() const
+	{
+		return m_NextMesh == m_UploadOrder.size() && m_PendingMeshes.empty();
+	}
+
+	// and every texture shows its own levels
+	[[nodiscard]] bool IsLoaded() const;
+
 	void LoadFirstMeshFromFile(std::string_view filename);
 
 	[[nodiscard]] bool ContainsPBRInfo() const
@@ -34,11 +73,62 @@ public:
 		return m_ContainsPBRInfo;
 	}
 
+	[[nodiscard]] LoadStats const& GetLoadStats() const
+	{
+		return m_LoadStats;
+	}
+
+	// bounds the vertex positions are quantized against
+	[[nodiscard]] glm::vec3 const& GetBoundsMin() const
+	{
+		return m_AABBMin;
+	}
+
+	[[nodiscard]] glm::vec3 const& GetBoundsMax() const
+	{
+		return m_AABBMax;
+	}
+
+	// timeline value of the batch the last visible meshes were uploaded by, graphics work drawing them waits on it
+	[[nodiscard]] uint64_t GetUploadValue() const
+	{
+		return m_UploadValue;
+	}
+
+	// only the meshes whose upload completed
 	[[nodiscard]] std::list<Mesh> const& GetMeshes() const
 	{
 		return m_Meshes;
 	}
 
+	// bounding spheres of the visible meshes in the same order, for the host frustum test
+	[[nodiscard]] frustum_culling::Spheres const& GetMeshBounds() const
+	{
+		return m_MeshBounds;
+	}
+
+	// the clusters of the visible meshes, they come first in the arena
+	[[nodiscard]] uint32_t GetResidentClusterCount() const
+	{
+		return m_ResidentClusterCount;
+	}
+
+	// meshes with 16 bit indices are uploaded first, so their clusters lead the arena
+	[[nodiscard]] uint32_t GetShortIndexClusterCount() const
+	{
+		return m_ShortIndexClusterCount;
+	}
+
+	[[nodiscard]] GeometryArena const& GetGeometry() const
+	{
+		return *m_Geometry;
+	}
+
+	[[nodiscard]] TextureStreamer& GetTextureStreamer()
+	{
+		return *m_TextureStreamer;
+	}
+
 	[[nodiscard]] std::span<vkc::Image> GetTextureImages()
 	{
 		return m_TextureImages;
@@ -77,6 +167,11 @@ public:
 	}
 
 	[[nodiscard]] uint32_t AddTextureToPool(vkc::Image&& image, vkc::ImageView&& imageView);
+	// the slot keeps its index, the previous image and view are returned to be destroyed once no frame samples them
+	[[nodiscard]] std::pair<vkc::Image, vkc::ImageView> ReplaceTextureInPool(uint32_t index, vkc::Image&& image, vkc::ImageView&& imageView);
+
+	// pool slots whose view changed since the frame's descriptor set was last written, streamed or added to the pool
+	[[nodiscard]] std::vector<uint32_t> TakeChangedTextures(uint32_t frame);
 
 	[[nodiscard]] std::span<Light> GetPointLights()
 	{
@@ -87,25 +182,88 @@ public:
 	void AddLight(glm::vec3 const& position, bool isPoint, glm::vec3 const& colour, float intensity);
 
 private:
-	void     ProcessNode(aiNode const* node, aiScene const* scene, vkc::CommandBuffer& commandBuffer);
-	uint32_t LoadTexture
-	(aiTextureType, aiMaterial const* material, vkc::CommandBuffer const& commandBuffer, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB);
+	using SourceTexture = TextureStreamer::SourceTexture;
 
-	vkc::Context&     m_Context;
-	vkc::CommandPool& m_CommandPool;
+	struct DecodedTexture
+	{
+		SourceTexture Texture;
+		double        Duration;
+		bool          Cooked;
+	};
+
+	// meshes recorded into the same upload batch, drawn once it completes
+	struct PendingMeshes
+	{
+		uint64_t        Value;
+		std::list<Mesh> Meshes;
+	};
+
+	// flushes once this much staging memory is recorded so the transfer queue starts while the rest is being staged,
+	// a quarter of the staging ring keeps several batches in flight. progressive loading records one batch per frame
+	static uint64_t constexpr UPLOAD_BATCH_SIZE{ 16ull * 1024 * 1024 };
+
+	void BeginUpload();
+	void LoadPlaceholders();
+	void StartTextureDecodes();
+	void AddTexture(uint32_t index, DecodedTexture decoded);
+	void RecordMesh(MeshRecord const& mesh);
+	void ShowCompletedMeshes();
+	void FinishGeometry();
+	void SubmitUploadBatchIfFull();
+	void SubmitUploadBatch();
+
+	vkc::Context& m_Context;
+	Uploader&     m_Uploader;
+	uint32_t      m_FramesInFlight;
 
-	std::stack<vkc::Buffer> m_StagingBuffers;
+	ThreadPool m_ThreadPool;
 
-	std::list<Mesh> m_Meshes;
-	LightData       m_LightData;
+	uint64_t m_StagedBytes{};
+	uint64_t m_UploadValue{};
 
-	std::vector<vkc::Image>                   m_TextureImages;
-	std::vector<vkc::ImageView>               m_TextureImageViews;
-	std::unordered_map<std::string, uint32_t> m_LoadedTextures;
+	// source of the upload, released once every mesh is recorded
+	std::unique_ptr<CookedScene> m_CookedScene;
+	std::unique_ptr<SceneData>   m_ImportedScene;
+	SceneView                    m_View;
+
+	std::chrono::steady_clock::time_point m_LoadStart;
+	std::chrono::steady_clock::time_point m_TextureDecodeStart;
+	// startup timeline spans of the phases that end on a later frame
+	uint32_t m_TextureDecodeSpan{};
+	uint32_t m_GeometryUploadSpan{};
+
+	// meshes grouped by index type so passes switch the index buffer binding once
+	std::vector<MeshRecord>   m_UploadOrder;
+	size_t                    m_NextMesh{};
+	std::list<Mesh>           m_RecordedMeshes;
+	std::deque<PendingMeshes> m_PendingMeshes;
+	uint32_t                  m_ResidentClusterCount{};
+	uint32_t                  m_ShortIndexClusterCount{};
+
+	std::unique_ptr<GeometryArena> m_Geometry;
+	std::list<Mesh>                m_Meshes;
+	frustum_culling::Spheres       m_MeshBounds;
+	LightData                      m_LightData;
+
+	std::vector<std::future<DecodedTexture>> m_TextureDecodes;
+	uint32_t                                 m_DecodedTextureCount{};
+	uint32_t                                 m_CookedTextureCount{};
+	uint64_t                                 m_TextureTailBytes{};
+	uint64_t                                 m_UncompressedTextureBytes{};
+	// one per TextureUsage in declaration order
+	std::vector<SourceTexture> m_Placeholders;
+
+	// streamed scene textures first, then the textures added to the pool
+	std::vector<vkc::Image>            m_TextureImages;
+	std::vector<vkc::ImageView>        m_TextureImageViews;
+	std::unique_ptr<TextureStreamer>   m_TextureStreamer;
+	std::vector<std::vector<uint32_t>> m_ChangedTextures;
 
 	glm::vec3 m_AABBMin{ FLT_MAX };
 	glm::vec3 m_AABBMax{ FLT_MIN };
 
+	LoadStats m_LoadStats{};
+
 	bool m_ContainsPBRInfo{};
 };
 
@@ -0,0 +1,119 @@
+#ifndef VULKANRESEARCH_SCENE_DATA_H
+#define VULKANRESEARCH_SCENE_DATA_H
+
+#include <cfloat>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "datatypes.h"
+
+enum class TextureUsage : uint32_t
+{
+	Albedo
+	, Normals
+	, Metalness
+	, Roughness
+};
+
+struct TextureEntry
+{
+	std::string  Path;
+	TextureUsage Usage;
+};
+
+// cluster of up to meshlet_builder::MAX_TRIANGLES consecutive triangles of a mesh, FirstIndex is relative to the mesh,
+// the cone holds the average face normal and the sine of the widest angle between it and any face normal
+struct Meshlet
+{
+	glm::vec3 Center;
+	float     Radius;
+	glm::vec3 ConeAxis;
+	float     ConeCutoff;
+	uint32_t  FirstIndex;
+	uint32_t  IndexCount;
+};
+
+// one level of a mesh's LOD chain, index and meshlet ranges are relative to the mesh's own,
+// Error is the object space distance the level may deviate from the full resolution surface by
+struct MeshLod
+{
+	uint32_t FirstIndex;
+	uint32_t IndexCount;
+	uint32_t FirstMeshlet;
+	uint32_t MeshletCount;
+	float    Error;
+};
+
+// index and meshlet ranges cover the whole LOD chain, finest level first
+struct MeshRecord
+{
+	uint32_t       FirstVertex;
+	uint32_t       VertexCount;
+	uint32_t       FirstIndex;
+	uint32_t       IndexCount;
+	uint32_t       FirstMeshlet;
+	uint32_t       MeshletCount;
+	uint32_t       FirstLod;
+	uint32_t       LodCount;
+	glm::vec3      Center;
+	float          Radius;
+	TextureIndices Textures;
+};
+
+// scene in its final, upload ready form: every mesh references ranges of the shared vertex, index, meshlet and LOD arrays
+// and texture indices point into the texture table, which is also the order textures are uploaded in,
+// vertex positions are quantized against AABBMin and AABBMax
+struct SceneData
+{
+	std::vector<PackedVertex> Vertices;
+	std::vector<uint32_t>     Indices;
+	std::vector<MeshRecord>   Meshes;
+	std::vector<Meshlet>      Meshlets;
+	std::vector<MeshLod>      Lods;
+	std::vector<TextureEntry> Textures;
+
+	glm::vec3 AABBMin{ FLT_MAX };
+	glm::vec3 AABBMax{ -FLT_MAX };
+
+	bool ContainsPBRInfo{};
+};
+
+// scene as read from its source file, before LODs and meshlets are built: meshes reference their full resolution
+// indices, vertices are kept unpacked in Vertices and SceneData::Vertices stays empty
+struct SourceScene
+{
+	SceneData           Data;
+	std::vector<Vertex> Vertices;
+};
+
+// non owning view over either imported or cooked scene data
+struct SceneView
+{
+	SceneView() = default;
+
+	explicit SceneView(SceneData const& data)
+		: Vertices{ data.Vertices }
+		, Indices{ data.Indices }
+		, Meshes{ data.Meshes }
+		, Meshlets{ data.Meshlets }
+		, Lods{ data.Lods }
+		, Textures{ data.Textures }
+		, AABBMin{ data.AABBMin }
+		, AABBMax{ data.AABBMax }
+		, ContainsPBRInfo{ data.ContainsPBRInfo } {}
+
+	std::span<PackedVertex const> Vertices;
+	std::span<uint32_t const>     Indices;
+	std::span<MeshRecord const>   Meshes;
+	std::span<Meshlet const>      Meshlets;
+	std::span<MeshLod const>      Lods;
+	std::span<TextureEntry const> Textures;
+
+	glm::vec3 AABBMin{};
+	glm::vec3 AABBMax{};
+
+	bool ContainsPBRInfo{};
+};
+
+#endif //VULKANRESEARCH_SCENE_DATA_H
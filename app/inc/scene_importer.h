@@ -0,0 +1,21 @@
+#ifndef VULKANRESEARCH_SCENE_IMPORTER_H
+#define VULKANRESEARCH_SCENE_IMPORTER_H
+
+#include <string_view>
+
+#include "scene_data.h"
+
+namespace scene_importer
+{
+	enum class Reader
+	{
+		// glTF through the native loader, every other format through Assimp
+		Auto
+		, Assimp
+	};
+
+	// reads the source file and converts it into the renderer's layout, building every mesh's LODs and meshlets
+	[[nodiscard]] SceneData Import(std::string_view filename, Reader reader = Reader::Auto);
+}
+
+#endif //VULKANRESEARCH_SCENE_IMPORTER_H
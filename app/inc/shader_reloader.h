@@ -0,0 +1,46 @@
+#ifndef VULKANRESEARCH_SHADER_RELOADER_H
+#define VULKANRESEARCH_SHADER_RELOADER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+class PipelineManager;
+
+// watches the shader sources and, when one is saved, compiles it to SPIR-V and has the pipeline manager rebuild every
+// pipeline using it, which swaps them in at a frame boundary without waiting for the device.
+// the watch relies on inotify, on other platforms the reloader stays inert
+class ShaderReloader final
+{
+public:
+	ShaderReloader() = delete;
+	explicit ShaderReloader(PipelineManager& pipelines);
+	~ShaderReloader();
+
+	ShaderReloader(ShaderReloader&&)                 = delete;
+	ShaderReloader(ShaderReloader const&)            = delete;
+	ShaderReloader& operator=(ShaderReloader&&)      = delete;
+	ShaderReloader& operator=(ShaderReloader const&) = delete;
+
+	// stops watching, rebuilds already queued still finish in the pipeline manager
+	void Destroy();
+
+private:
+	// waits for saves to settle a moment so an editor writing a file in several steps triggers one rebuild
+	static uint32_t constexpr SETTLE_MILLISECONDS{ 50 };
+
+	void WatchLoop();
+#ifdef __linux__
+	// compiles the shader next to the ones the build produced, returns false and logs the compiler output on errors
+	[[nodiscard]] bool Compile(std::string const& shader) const;
+#endif
+
+	PipelineManager& m_Pipelines;
+
+	int               m_Watch{ -1 };
+	std::atomic<bool> m_Stopping{};
+	std::thread       m_Thread;
+};
+
+#endif //VULKANRESEARCH_SHADER_RELOADER_H
@@ -1,28 +1,33 @@
 #ifndef VULKANRESEARCH_SHADOW_GENERATION_H
 #define VULKANRESEARCH_SHADOW_GENERATION_H
 
+#include "cluster_culling.h"
 #include "datatypes.h"
 #include "scene.h"
+#include "vertex_packing.h"
 
 namespace shadow
 {
+	// drawDescSetLayout is the ClusterCuller's, bound as set 1
 	inline std::pair<vkc::PipelineLayout, vkc::Pipeline> CreatePipelineForDirectionalShadows
 	(
-		vkc::Context&         context, vkc::DescriptorSetLayout const& descSetLayout, VkFormat depthFormat, VkExtent2D shadowRes
-		, vkc::PipelineCache* cache = nullptr
+		vkc::Context&                     context, vkc::DescriptorSetLayout const& descSetLayout
+		, vkc::DescriptorSetLayout const& drawDescSetLayout, VkFormat depthFormat, VkExtent2D shadowRes
+		, glm::vec3 const&                boundsMin, glm::vec3 const& boundsMax
+		, vkc::PipelineCache*             cache = nullptr
 	)
 	{
+		// the light space transform, then the first draw slot of the culled view
 		vkc::PipelineLayoutBuilder layoutBuilder{ context };
 		vkc::PipelineLayout        directionalPipelineLayout = layoutBuilder
-														.AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT
-																		 , 0
-																		 , sizeof(uint32_t))
-														.AddPushConstant(VK_SHADER_STAGE_VERTEX_BIT, 16, sizeof(glm::mat4))
+														.AddPushConstant(VK_SHADER_STAGE_VERTEX_BIT, 16, sizeof(glm::mat4) + sizeof(uint32_t))
 														.AddDescriptorSetLayout(descSetLayout)
+														.AddDescriptorSetLayout(drawDescSetLayout)
 														.Build(false);
 
-		vkc::ShaderStage const vert{ context, help::ReadFile("shaders/transform_to_lightspace.spv"), VK_SHADER_STAGE_VERTEX_BIT };
+		vkc::ShaderStage       vert{ context, help::ReadFile("shaders/transform_to_lightspace.spv"), VK_SHADER_STAGE_VERTEX_BIT };
 		vkc::ShaderStage const frag{ context, help::ReadFile("shaders/alpha_discard.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
+		vertex_packing::AddDequantizationConstants(vert, boundsMin, boundsMax);
 
 		vkc::PipelineBuilder pipelineBuilder{ context };
 		if (cache)
@@ -41,26 +46,32 @@ namespace shadow
 											.SetRenderingAttachments({}
 																	 , depthFormat
 																	 , VK_FORMAT_UNDEFINED)
-											.SetVertexDescription(Vertex::GetBindingDescription(), Vertex::GetAttributeDescription())
+											.SetVertexDescription(PackedVertex::GetBindingDescription(), PackedVertex::GetAttributeDescription())
 											.Build(directionalPipelineLayout, false);
 		return { std::move(directionalPipelineLayout), std::move(directionalPipeline) };
 	}
 
+	// drawDescSetLayout is the ClusterCuller's, bound as set 1
 	inline std::pair<vkc::PipelineLayout, vkc::Pipeline> CreatePipelineForPointShadows
 	(
-		vkc::Context&         context, vkc::DescriptorSetLayout const& descSetLayout, VkFormat depthFormat, VkExtent2D shadowRes
-		, vkc::PipelineCache* cache = nullptr
+		vkc::Context&                     context, vkc::DescriptorSetLayout const& descSetLayout
+		, vkc::DescriptorSetLayout const& drawDescSetLayout, VkFormat depthFormat, VkExtent2D shadowRes
+		, glm::vec3 const&                boundsMin, glm::vec3 const& boundsMax
+		, vkc::PipelineCache*             cache = nullptr
 	)
 	{
 		vkc::ShaderStage vert{ context, help::ReadFile("shaders/transform_to_lightspace.spv"), VK_SHADER_STAGE_VERTEX_BIT };
 		vkc::ShaderStage depthOverride{ context, help::ReadFile("shaders/frag_depth_override.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
+		vertex_packing::AddDequantizationConstants(vert, boundsMin, boundsMax);
 
+		// light position and far plane, the light space transform, then the first draw slot of the culled view
 		vkc::PipelineLayoutBuilder layoutBuilder{ context };
 		vkc::PipelineLayout        pointPipelineLayout = layoutBuilder
 												  .AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT
 																   , 0
 																   , sizeof(glm::vec4) + sizeof(glm::mat4) + sizeof(uint32_t))
 												  .AddDescriptorSetLayout(descSetLayout)
+												  .AddDescriptorSetLayout(drawDescSetLayout)
 												  .Build(false);
 		vkc::PipelineBuilder pipelineBuilder{ context };
 		if (cache)
@@ -79,24 +90,76 @@ namespace shadow
 									  .SetRenderingAttachments({}
 															   , depthFormat
 															   , VK_FORMAT_UNDEFINED)
-									  .SetVertexDescription(Vertex::GetBindingDescription(), Vertex::GetAttributeDescription())
+									  .SetVertexDescription(PackedVertex::GetBindingDescription(), PackedVertex::GetAttributeDescription())
 									  .Build(pointPipelineLayout, false);
 
 		return { std::move(pointPipelineLayout), std::move(pointPipeline) };
 	}
 
+	// every map to depth attachment before the lights are recorded into secondary command buffers, which cannot
+	// track the layouts themselves
+	inline void TransitionShadowMapsForGeneration
+	(
+		vkc::Context const&         context
+		, vkc::CommandBuffer const& commandBuffer
+		, std::span<vkc::Image>     shadowMaps
+		, uint32_t                  layerCount
+	)
+	{
+		for (vkc::Image& shadowMap: shadowMaps)
+		{
+			vkc::Image::Transition transition{};
+			transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+			transition.SrcAccessMask = VK_ACCESS_NONE;
+			transition.DstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+			transition.LayerCount    = layerCount;
+			shadowMap.MakeTransition(context, commandBuffer, transition);
+		}
+	}
+
+	// every map to shader read only once all lights were recorded
+	inline void TransitionShadowMapsForSampling
+	(
+		vkc::Context const&         context
+		, vkc::CommandBuffer const& commandBuffer
+		, std::span<vkc::Image>     shadowMaps
+		, uint32_t                  layerCount
+	)
+	{
+		for (vkc::Image& shadowMap: shadowMaps)
+		{
+			vkc::Image::Transition transition{};
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			transition.SrcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_NONE;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_NONE;
+			transition.LayerCount    = layerCount;
+			shadowMap.MakeTransition(context, commandBuffer, transition);
+		}
+	}
+
+	// the point lights [firstLight, lastLight), their maps have to be depth attachments already. nothing but the lights'
+	// own culling views is written, so ranges of lights can be recorded by several threads at once
 	inline void RecordPointShadowsGeneration
 	(
 		vkc::Context const&                      context
-		, vkc::CommandBuffer const&              commandBuffer
+		, VkCommandBuffer                        commandBuffer
 		, Scene&                                 scene
 		, std::span<vkc::Image>                  shadowMaps
 		, std::span<std::vector<vkc::ImageView>> shadowMapViews
 		, FrameData const&                       frameData
+		, ClusterCuller const&                   culler
+		, uint32_t                               firstView
+		, float                                  lodPixelError
+		, uint32_t                               firstLight
+		, uint32_t                               lastLight
 	)
 	{
 		auto pointLights = scene.GetPointLights();
-		for (uint32_t lightIndex{}; lightIndex < pointLights.size(); ++lightIndex)
+		for (uint32_t lightIndex{ firstLight }; lightIndex < lastLight; ++lightIndex)
 		{
 			auto& light = pointLights[lightIndex];
 			assert(light.IsPoint());
@@ -114,19 +177,21 @@ namespace shadow
 
 			auto& shadowMap   = shadowMaps[lightIndex];
 			auto& shadowViews = shadowMapViews[lightIndex];
-			// transition to depth attachment optimal
-			{
-				vkc::Image::Transition transition{};
-				transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
-				transition.SrcAccessMask = VK_ACCESS_NONE;
-				transition.DstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-				transition.SrcStageMask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-				transition.DstStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-				transition.LayerCount    = 6;
-				shadowMap.MakeTransition(context, commandBuffer, transition);
-			}
 			for (uint32_t faceIndex{}; faceIndex < 6; ++faceIndex)
 			{
+				// the cone test is skipped, shadow pipelines see the scene with a flipped winding
+				uint32_t const  view       = firstView + lightIndex * 6 + faceIndex;
+				glm::mat4 const lightSpace = captureProj * captureViews[faceIndex];
+				culler.Cull(commandBuffer
+							, view
+							, {
+								lightSpace
+								, glm::vec4{ .0f }
+								, static_cast<float>(shadowMap.GetExtent().height)
+								, lodPixelError
+								, draw_sorting::Order::FrontToBack
+							});
+
 				auto&                     shadowView = shadowViews[faceIndex];
 				VkRenderingAttachmentInfo depthAttachment{};
 				depthAttachment.sType                   = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
@@ -155,7 +220,6 @@ namespace shadow
 															, 0
 															, nullptr);
 
-				glm::mat4 const lightSpace = captureProj * captureViews[faceIndex];
 				context.DispatchTable.cmdPushConstants(commandBuffer
 													   , *frameData.PipelineLayout
 													   , VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT
@@ -169,71 +233,47 @@ namespace shadow
 													   , 0
 													   , sizeof(glm::vec4)
 													   , &positionFar);
-				for (auto& meshes = scene.GetMeshes();
-					 auto& mesh: meshes)
-				{
-					VkDeviceSize offsets[] = { 0 };
-					context.DispatchTable.cmdPushConstants(commandBuffer
-														   , *frameData.PipelineLayout
-														   , VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT
-														   , sizeof(glm::mat4) + sizeof(glm::vec4)
-														   , sizeof(uint32_t)
-														   , &mesh.GetTextureIndices().Diffuse);
-
-					context.DispatchTable.cmdBindVertexBuffers(commandBuffer
-															   , 0
-															   , 1
-															   , mesh.GetVertexBuffer()
-															   , offsets);
-
-					context.DispatchTable.cmdBindIndexBuffer(commandBuffer, mesh.GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-					context.DispatchTable.cmdDrawIndexed(commandBuffer
-														 , static_cast<uint32_t>(mesh.GetIndexBuffer().GetSize() / sizeof(uint32_t))
-														 , 1
-														 , 0
-														 , 0
-														 , 0);
-				}
+				culler.Draw(commandBuffer
+							, view
+							, *frameData.PipelineLayout
+							, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT
+							, sizeof(glm::vec4) + sizeof(glm::mat4));
 				context.DispatchTable.cmdEndRendering(commandBuffer);
-				//
-				{
-					vkc::Image::Transition transition{ shadowView };
-					transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-					transition.SrcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-					transition.DstAccessMask = VK_ACCESS_NONE;
-					transition.SrcStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-					transition.DstStageMask  = VK_PIPELINE_STAGE_NONE;
-					shadowMap.MakeTransition(context, commandBuffer, transition);
-				}
 			}
 		}
 	}
 
+	// the directional lights [firstLight, lastLight), recorded the same way as the point lights
 	inline void RecordDirectionalShadowsGeneration
 	(
 		vkc::Context const&         context
-		, vkc::CommandBuffer const& commandBuffer
+		, VkCommandBuffer           commandBuffer
 		, Scene&                    scene
 		, std::span<vkc::Image>     shadowMaps
 		, std::span<vkc::ImageView> shadowMapViews
 		, FrameData const&          frameData
+		, ClusterCuller const&      culler
+		, uint32_t                  firstView
+		, float                     lodPixelError
+		, uint32_t                  firstLight
+		, uint32_t                  lastLight
 	)
 	{
-		for (uint32_t index{}; index < shadowMaps.size(); ++index)
+		for (uint32_t index{ firstLight }; index < lastLight; ++index)
 		{
 			auto& shadowMap  = shadowMaps[index];
 			auto& shadowView = shadowMapViews[index];
-			// transition to depth attachment optimal
-			{
-				vkc::Image::Transition transition{ shadowMapViews[index] };
-				transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
-				transition.SrcAccessMask = VK_ACCESS_NONE;
-				transition.DstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-				transition.SrcStageMask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-				transition.DstStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-				shadowMap.MakeTransition(context, commandBuffer, transition);
-			}
+
+			glm::mat4 const lightSpace = scene.GetLightMatrices()[scene.GetLights()[index].GetMatrixIndex()];
+			culler.Cull(commandBuffer
+						, firstView + index
+						, {
+							lightSpace
+							, glm::vec4{ .0f }
+							, static_cast<float>(shadowMap.GetExtent().height)
+							, lodPixelError
+							, draw_sorting::Order::FrontToBack
+						});
 			VkRenderingAttachmentInfo depthAttachment{};
 			depthAttachment.sType                   = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
 			depthAttachment.clearValue.depthStencil = { 1.f, 0 };
@@ -261,50 +301,14 @@ namespace shadow
 														, 0
 														, nullptr);
 
-			glm::mat4 const lightSpace = scene.GetLightMatrices()[scene.GetLights()[index].GetMatrixIndex()];
 			context.DispatchTable.cmdPushConstants(commandBuffer
 												   , *frameData.PipelineLayout
 												   , VK_SHADER_STAGE_VERTEX_BIT
 												   , 16
 												   , sizeof(glm::mat4)
 												   , &lightSpace);
-			for (auto& meshes = scene.GetMeshes();
-				 auto& mesh: meshes)
-			{
-				VkDeviceSize offsets[] = { 0 };
-				context.DispatchTable.cmdPushConstants(commandBuffer
-													   , *frameData.PipelineLayout
-													   , VK_SHADER_STAGE_FRAGMENT_BIT
-													   , 0
-													   , sizeof(uint32_t)
-													   , &mesh.GetTextureIndices().Diffuse);
-
-				context.DispatchTable.cmdBindVertexBuffers(commandBuffer
-														   , 0
-														   , 1
-														   , mesh.GetVertexBuffer()
-														   , offsets);
-
-				context.DispatchTable.cmdBindIndexBuffer(commandBuffer, mesh.GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-				context.DispatchTable.cmdDrawIndexed(commandBuffer
-													 , static_cast<uint32_t>(mesh.GetIndexBuffer().GetSize() / sizeof(uint32_t))
-													 , 1
-													 , 0
-													 , 0
-													 , 0);
-			}
+			culler.Draw(commandBuffer, firstView + index, *frameData.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 16 + sizeof(glm::mat4));
 			context.DispatchTable.cmdEndRendering(commandBuffer);
-			//
-			{
-				vkc::Image::Transition transition{ shadowView };
-				transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-				transition.SrcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-				transition.DstAccessMask = VK_ACCESS_NONE;
-				transition.SrcStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-				transition.DstStageMask  = VK_PIPELINE_STAGE_NONE;
-				shadowMap.MakeTransition(context, commandBuffer, transition);
-			}
 		}
 	}
 }
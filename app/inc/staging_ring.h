@@ -0,0 +1,81 @@
+#ifndef VULKANRESEARCH_STAGING_RING_H
+#define VULKANRESEARCH_STAGING_RING_H
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "context.h"
+#include "helper.h"
+
+// fixed-size persistently mapped staging buffer handed out front to back, every region is tagged with the timeline
+// value of the upload batch that reads it and becomes reusable once that value completes
+class StagingRing final
+{
+public:
+	struct Allocation
+	{
+		VkBuffer             Buffer;
+		VkDeviceSize         Offset;
+		std::span<std::byte> Data;
+	};
+
+	StagingRing() = delete;
+	StagingRing(vkc::Context& context, VkDeviceSize capacity);
+	~StagingRing() = default;
+
+	StagingRing(StagingRing&&)                 = delete;
+	StagingRing(StagingRing const&)            = delete;
+	StagingRing& operator=(StagingRing&&)      = delete;
+	StagingRing& operator=(StagingRing const&) = delete;
+
+	void Destroy();
+
+	// empty when the allocation would overwrite a region the gpu may still read, requests larger than the ring
+	// get a dedicated buffer that is released with the open region
+	[[nodiscard]] std::optional<Allocation> TryAllocate(VkDeviceSize size, VkDeviceSize alignment);
+
+	// tags everything allocated since the previous call with the value of the batch that was just submitted
+	void Close(uint64_t value);
+
+	void Release(uint64_t completedValue);
+
+	// timeline value the oldest live region waits for, zero while that region is still being recorded
+	[[nodiscard]] uint64_t GetOldestValue() const
+	{
+		return m_Regions.empty() ? 0 : m_Regions.front().Value;
+	}
+
+	[[nodiscard]] VkDeviceSize GetCapacity() const
+	{
+		return m_Capacity;
+	}
+
+	[[nodiscard]] VkDeviceSize GetPeakUsage() const
+	{
+		return m_PeakUsage;
+	}
+
+private:
+	struct Region
+	{
+		VkDeviceSize                    Size;
+		uint64_t                        Value;
+		std::vector<help::MappedBuffer> DedicatedBuffers;
+	};
+
+	vkc::Context& m_Context;
+
+	help::MappedBuffer m_Buffer;
+	VkDeviceSize       m_Capacity{};
+	VkDeviceSize       m_Head{};
+	VkDeviceSize       m_Used{};
+	VkDeviceSize       m_PeakUsage{};
+
+	Region             m_OpenRegion{};
+	std::deque<Region> m_Regions;
+};
+
+#endif //VULKANRESEARCH_STAGING_RING_H
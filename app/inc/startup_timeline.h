@@ -0,0 +1,77 @@
+#ifndef VULKANRESEARCH_STARTUP_TIMELINE_H
+#define VULKANRESEARCH_STARTUP_TIMELINE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// hierarchical record of where startup and scene loading spend their time. spans nest under the innermost scope open
+// on the same thread and carry byte and item counters, everything is safe to call from any thread
+namespace startup_timeline
+{
+	uint32_t constexpr NO_PARENT{ UINT32_MAX };
+	// Begin nests under the calling thread's innermost scope
+	uint32_t constexpr CURRENT_SCOPE{ UINT32_MAX - 1 };
+
+	struct Span
+	{
+		std::string Name;
+		uint32_t    Parent;
+		// seconds since the timeline started, the duration grows until the span ends
+		double      Start;
+		double      Duration;
+		bool        Finished;
+		uint64_t    Bytes;
+		uint64_t    Items;
+		// what the items count, such as vertices or textures
+		std::string ItemName;
+	};
+
+	// for phases that end on a later frame or another thread than they started on, does not become the current scope
+	[[nodiscard]] uint32_t Begin(std::string name, uint32_t parent = CURRENT_SCOPE);
+	void                   End(uint32_t span);
+
+	// summed into the span
+	void AddBytes(uint32_t span, uint64_t bytes);
+	void AddItems(uint32_t span, uint64_t count, std::string_view itemName);
+
+	// spans one block, nested spans started on this thread meanwhile become its children
+	class Scope final
+	{
+	public:
+		explicit Scope(std::string name);
+		~Scope();
+
+		Scope(Scope&&)                 = delete;
+		Scope(Scope const&)            = delete;
+		Scope& operator=(Scope&&)      = delete;
+		Scope& operator=(Scope const&) = delete;
+
+		[[nodiscard]] uint32_t GetSpan() const
+		{
+			return m_Span;
+		}
+
+		void AddBytes(uint64_t bytes) const
+		{
+			startup_timeline::AddBytes(m_Span, bytes);
+		}
+
+		void AddItems(uint64_t count, std::string_view itemName) const
+		{
+			startup_timeline::AddItems(m_Span, count, itemName);
+		}
+
+	private:
+		uint32_t m_Span;
+	};
+
+	// copies in start order, a span's parent always precedes it
+	[[nodiscard]] std::vector<Span> GetSpans();
+
+	// nested by parent so two runs can be diffed, throws when the file can not be written
+	void WriteJson(std::string_view path);
+}
+
+#endif //VULKANRESEARCH_STARTUP_TIMELINE_H
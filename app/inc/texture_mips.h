@@ -0,0 +1,40 @@
+#ifndef VULKANRESEARCH_TEXTURE_MIPS_H
+#define VULKANRESEARCH_TEXTURE_MIPS_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace texture_mips
+{
+	enum class Filter
+	{
+		// plain box filter, for data textures
+		Linear
+		// colour is averaged in linear space and re-encoded, alpha stays linear
+		, SRGB
+		// vectors are decoded from [0, 1], averaged and renormalised
+		, Normal
+	};
+
+	struct Level
+	{
+		uint32_t Width;
+		uint32_t Height;
+		uint64_t Offset;
+		uint64_t Size;
+	};
+
+	// every level of an RGBA8 image packed back to back, level 0 first
+	struct Chain
+	{
+		std::vector<unsigned char> Pixels;
+		std::vector<Level>         Levels;
+	};
+
+	[[nodiscard]] uint32_t CalculateLevelCount(uint32_t width, uint32_t height);
+
+	[[nodiscard]] Chain Generate(std::span<unsigned char const> pixels, uint32_t width, uint32_t height, Filter filter);
+}
+
+#endif //VULKANRESEARCH_TEXTURE_MIPS_H
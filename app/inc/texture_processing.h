@@ -0,0 +1,27 @@
+#ifndef VULKANRESEARCH_TEXTURE_PROCESSING_H
+#define VULKANRESEARCH_TEXTURE_PROCESSING_H
+
+#include <string>
+#include <string_view>
+
+#include "ktx2.h"
+#include "scene_data.h"
+
+// turns source images into the layout the shaders sample: albedo stays RGBA, normals keep XY (Z is reconstructed),
+// metalness and roughness keep only their glTF channel (blue and green) in the red channel
+namespace texture_processing
+{
+	std::string_view constexpr SOURCE_DIRECTORY{ "data/textures/" };
+	std::string_view constexpr COOKED_DIRECTORY{ "data/textures_cooked/" };
+
+	// one file per usage, glTF packs metalness and roughness into the same source image
+	[[nodiscard]] std::string GetCookedPath(std::string_view cookedDirectory, TextureEntry const& texture);
+
+	// BC7 / BC5 / BC4 when compressing, RGBA8 / RG8 / R8 otherwise
+	[[nodiscard]] VkFormat GetFormat(TextureUsage usage, bool compressed);
+
+	// decodes the source and builds its full mip chain in the format returned by GetFormat
+	[[nodiscard]] ktx2::Texture Process(std::string_view sourcePath, TextureUsage usage, bool compress);
+}
+
+#endif //VULKANRESEARCH_TEXTURE_PROCESSING_H
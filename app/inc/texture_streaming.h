@@ -0,0 +1,169 @@
+#ifndef VULKANRESEARCH_TEXTURE_STREAMING_H
+#define VULKANRESEARCH_TEXTURE_STREAMING_H
+
+#include <deque>
+#include <optional>
+#include <variant>
+#include <vector>
+
+#include "helper.h"
+#include "image.h"
+#include "image_view.h"
+#include "ktx2.h"
+#include "uploader.h"
+
+// keeps the mip tail of every scene texture resident and streams finer levels in and out under a memory budget.
+// the gbuffer pass reports the resolution it sampled each texture at into a per frame feedback buffer, a texture is
+// grown by recreating its image with the finer levels and swapping the view in the bindless array once the upload
+// completes, levels nobody requested lately are evicted least recently used first when a request does not fit.
+// the streamed textures occupy the first slots of the pool, the streamer replaces them in place. every slot starts out
+// with a placeholder until its source is handed over, so textures can arrive while the scene is already drawn
+class TextureStreamer final
+{
+public:
+	// cooked textures stay mapped so levels can be copied out again whenever they are streamed in
+	using SourceTexture = std::variant<ktx2::MappedTexture, ktx2::Texture>;
+
+	struct Statistics
+	{
+		uint64_t ResidentBytes;
+		uint64_t RequestedBytes;
+		uint64_t FullChainBytes;
+		uint32_t PendingUploads;
+		// textures whose own levels are not shown yet
+		uint32_t Placeholders;
+	};
+
+	TextureStreamer() = delete;
+	// records the tail of every texture's placeholder into the uploader's current batch and appends the images to the
+	// pool, the placeholders have to outlive the streamer
+	TextureStreamer
+	(
+		vkc::Context&                       context
+		, Uploader&                         uploader
+		, std::vector<vkc::Image>&          images
+		, std::vector<vkc::ImageView>&      views
+		, std::vector<SourceTexture const*> placeholders
+		, uint32_t                          framesInFlight
+	);
+	~TextureStreamer() = default;
+
+	TextureStreamer(TextureStreamer&&)                 = delete;
+	TextureStreamer(TextureStreamer const&)            = delete;
+	TextureStreamer& operator=(TextureStreamer&&)      = delete;
+	TextureStreamer& operator=(TextureStreamer const&) = delete;
+
+	// expects the device to be idle
+	void Destroy();
+
+	// records the upload of the source's tail into the uploader's current batch, the placeholder is swapped out once
+	// the batch completes, returns the staged bytes
+	uint64_t SetSource(uint32_t texture, SourceTexture source);
+
+	// submits the uploader's current batch, the textures recorded into it swap in once it completes
+	uint64_t Flush();
+
+	// once the frame's fence is signaled: reads the feedback its last submission wrote, swaps in completed uploads
+	// and submits the uploads the new requests need
+	void Update(uint32_t frame, uint64_t budget);
+
+	// textures whose view changed since the frame's descriptor set was last written, the caller rewrites them
+	[[nodiscard]] std::vector<uint32_t> TakeChangedTextures(uint32_t frame);
+
+	[[nodiscard]] VkBuffer GetFeedbackBuffer(uint32_t frame) const
+	{
+		return m_FeedbackBuffers[frame].Buffer;
+	}
+
+	[[nodiscard]] uint32_t GetTextureCount() const
+	{
+		return static_cast<uint32_t>(m_Textures.size());
+	}
+
+	[[nodiscard]] Statistics GetStatistics() const;
+
+private:
+	// finest level of the tail uploaded at load and never evicted
+	static uint32_t constexpr TAIL_RESOLUTION{ 64 };
+	// a request older than this many frames no longer protects the texture's levels from eviction
+	static uint64_t constexpr REQUEST_LIFETIME{ 120 };
+	// staging memory one Update may record, keeps streaming from stalling a frame on a full ring
+	static uint64_t constexpr MAX_STREAMED_BYTES_PER_UPDATE{ 8ull * 1024 * 1024 };
+
+	struct Texture
+	{
+		std::optional<SourceTexture> Source;
+		SourceTexture const*         Placeholder;
+		uint32_t                     TailLevel;
+		// a level of the placeholder while it is shown
+		uint32_t                     ResidentLevel;
+		// level the image will hold once the upload in flight completes, equals ResidentLevel when idle
+		uint32_t                     TargetLevel;
+		uint32_t                     RequestedLevel;
+		uint64_t                     LastRequestFrame;
+		bool                         ShowsPlaceholder;
+	};
+
+	struct PendingUpload
+	{
+		uint32_t       Texture;
+		uint32_t       Level;
+		vkc::Image     Image;
+		vkc::ImageView View;
+	};
+
+	// uploads submitted in the same batch, swapped in together once the uploader's timeline reaches Value
+	struct PendingBatch
+	{
+		uint64_t                   Value;
+		std::vector<PendingUpload> Uploads;
+	};
+
+	struct RetiredImage
+	{
+		vkc::Image     Image;
+		vkc::ImageView View;
+		uint64_t       Frame;
+	};
+
+	[[nodiscard]] static std::span<texture_mips::Level const> GetLevels(SourceTexture const& source);
+	[[nodiscard]] static VkFormat                             GetFormat(SourceTexture const& source);
+	[[nodiscard]] static uint32_t                             GetTailLevel(SourceTexture const& source);
+
+	// the placeholder until the source is handed over
+	[[nodiscard]] static SourceTexture const& GetSource(Texture const& texture);
+
+	// bytes of the levels from level down to the smallest
+	[[nodiscard]] static uint64_t GetSize(SourceTexture const& source, uint32_t level);
+
+	[[nodiscard]] uint32_t GetEffectiveRequest(Texture const& texture) const;
+
+	// records the upload of the texture's levels from level on into a new image, returns the staged bytes
+	uint64_t Stream(uint32_t texture, uint32_t level);
+
+	// shrinks textures holding finer levels than they were asked for, least recently used first, until the bytes are
+	// released or nothing is left to evict, returns the bytes released
+	uint64_t Evict(uint64_t bytes);
+
+	void ReadFeedback(uint32_t frame);
+	void MarkChanged(uint32_t texture);
+
+	vkc::Context& m_Context;
+	Uploader&     m_Uploader;
+
+	std::vector<vkc::Image>&     m_Images;
+	std::vector<vkc::ImageView>& m_Views;
+	uint32_t                     m_FramesInFlight;
+
+	std::vector<Texture>               m_Textures;
+	std::vector<help::MappedBuffer>    m_FeedbackBuffers;
+	std::vector<std::vector<uint32_t>> m_ChangedTextures;
+	// recorded into the uploader's current batch
+	std::vector<PendingUpload> m_RecordedUploads;
+	std::deque<PendingBatch>   m_PendingBatches;
+	std::deque<RetiredImage>   m_RetiredImages;
+
+	uint64_t m_Frame{};
+};
+
+#endif //VULKANRESEARCH_TEXTURE_STREAMING_H
@@ -0,0 +1,58 @@
+#ifndef VULKANRESEARCH_THREAD_POOL_H
+#define VULKANRESEARCH_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// fixed size pool of workers pulling jobs from a single FIFO queue
+class ThreadPool final
+{
+public:
+	// zero picks the hardware concurrency
+	explicit ThreadPool(uint32_t threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(ThreadPool&&)                 = delete;
+	ThreadPool(ThreadPool const&)            = delete;
+	ThreadPool& operator=(ThreadPool&&)      = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	// exceptions thrown by the job are rethrown from the returned future
+	template<typename Function>
+	[[nodiscard]] std::future<std::invoke_result_t<Function>> Submit(Function&& function)
+	{
+		using Result = std::invoke_result_t<Function>;
+
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+		std::future<Result> future = task->get_future();
+		//
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_Jobs.emplace([task] { (*task)(); });
+		}
+		m_Condition.notify_one();
+		return future;
+	}
+
+	[[nodiscard]] uint32_t GetThreadCount() const
+	{
+		return static_cast<uint32_t>(m_Workers.size());
+	}
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread>          m_Workers;
+	std::queue<std::function<void()>> m_Jobs;
+	std::mutex                        m_Mutex;
+	std::condition_variable           m_Condition;
+	bool                              m_Stopping{};
+};
+
+#endif //VULKANRESEARCH_THREAD_POOL_H
@@ -0,0 +1,140 @@
+#ifndef VULKANRESEARCH_UPLOADER_H
+#define VULKANRESEARCH_UPLOADER_H
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "command_pool.h"
+#include "context.h"
+#include "staging_ring.h"
+
+// records uploads on the transfer queue and hands the written resources over to the graphics queue,
+// every submitted batch signals the next value of a timeline semaphore graphics submissions wait on
+class Uploader final
+{
+public:
+	Uploader() = delete;
+	explicit Uploader(vkc::Context& context);
+	~Uploader() = default;
+
+	Uploader(Uploader&&)                 = delete;
+	Uploader(Uploader const&)            = delete;
+	Uploader& operator=(Uploader&&)      = delete;
+	Uploader& operator=(Uploader const&) = delete;
+
+	// expects the device to be idle, runs every outstanding retirement
+	void Destroy();
+
+	// transfer command buffer of the batch being recorded, begun on first use
+	[[nodiscard]] vkc::CommandBuffer& GetCommandBuffer();
+
+	// mapped staging memory read by the batch being recorded, when the ring is full the batch is submitted if it
+	// holds the oldest region and the cpu waits for that region to retire. that retires earlier allocations too, so
+	// the copies reading an allocation have to be recorded before the next one is made
+	[[nodiscard]] StagingRing::Allocation AllocateStaging(VkDeviceSize size, VkDeviceSize alignment);
+
+	// ownership release of a buffer range written by the current batch, dst masks describe its first use on the
+	// graphics queue
+	void ReleaseBuffer
+	(
+		VkBuffer                buffer
+		, VkPipelineStageFlags2 dstStageMask
+		, VkAccessFlags2        dstAccessMask
+		, VkDeviceSize          offset = 0
+		, VkDeviceSize          size   = VK_WHOLE_SIZE
+	);
+
+	// same for an image, which must already be in its final layout
+	void ReleaseImage
+	(
+		VkImage                   image
+		, VkImageLayout           layout
+		, VkImageSubresourceRange range
+		, VkPipelineStageFlags2   dstStageMask
+		, VkAccessFlags2          dstAccessMask
+	);
+
+	// ends and submits the current batch, returns the timeline value signaled once it completes
+	uint64_t Submit();
+
+	// records the acquire half of the ownership transfers on a graphics command buffer, only for batches that already
+	// completed when requested, returns the value the graphics submission has to wait on
+	uint64_t RecordAcquireBarriers(vkc::CommandBuffer const& commandBuffer, bool completedOnly = false);
+
+	[[nodiscard]] VkSemaphoreSubmitInfo CreateWaitInfo(uint64_t value, VkPipelineStageFlags2 stageMask) const;
+
+	// lets a graphics submission advance the timeline too so its resources can be retired the same way,
+	// that submission has to wait on the value before the one returned
+	[[nodiscard]] VkSemaphoreSubmitInfo CreateSignalInfo(uint64_t& outValue);
+
+	[[nodiscard]] uint64_t GetLastValue() const
+	{
+		return m_LastValue;
+	}
+
+	// the callback runs from Collect once the timeline reaches the value
+	void Retire(uint64_t value, std::function<void()> callback);
+	void Collect();
+
+	void Wait(uint64_t value) const;
+
+	[[nodiscard]] uint64_t GetCompletedValue() const;
+
+	[[nodiscard]] bool IsComplete(uint64_t value) const
+	{
+		return GetCompletedValue() >= value;
+	}
+
+	[[nodiscard]] bool IsDedicated() const
+	{
+		return m_QueueFamily != m_GraphicsQueueFamily;
+	}
+
+	[[nodiscard]] StagingRing const& GetStagingRing() const
+	{
+		return m_StagingRing;
+	}
+
+	// number of staging allocations that had to wait for the gpu because the ring was full
+	[[nodiscard]] uint32_t GetStagingStallCount() const
+	{
+		return m_StagingStallCount;
+	}
+
+private:
+	struct Batch
+	{
+		uint64_t                            Value{};
+		std::vector<VkBufferMemoryBarrier2> BufferBarriers;
+		std::vector<VkImageMemoryBarrier2>  ImageBarriers;
+	};
+
+	struct Retirement
+	{
+		uint64_t              Value;
+		std::function<void()> Callback;
+	};
+
+	vkc::Context& m_Context;
+
+	VkQueue  m_Queue{};
+	uint32_t m_QueueFamily{};
+	uint32_t m_GraphicsQueueFamily{};
+
+	vkc::CommandPool    m_CommandPool;
+	vkc::CommandBuffer* m_CommandBuffer{};
+
+	VkSemaphore m_TimelineSemaphore{};
+	uint64_t    m_LastValue{};
+
+	StagingRing m_StagingRing;
+	uint32_t    m_StagingStallCount{};
+
+	Batch                  m_RecordingBatch{};
+	std::deque<Batch>      m_UnacquiredBatches;
+	std::deque<Retirement> m_Retirements;
+	std::deque<uint64_t>   m_InFlightValues;
+};
+
+#endif //VULKANRESEARCH_UPLOADER_H
@@ -0,0 +1,31 @@
+#ifndef VULKANRESEARCH_VERTEX_PACKING_H
+#define VULKANRESEARCH_VERTEX_PACKING_H
+
+#include <span>
+#include <vector>
+
+#include "datatypes.h"
+
+namespace vkc
+{
+	class ShaderStage;
+}
+
+// conversion between the imported vertex and the compact one the gpu reads
+namespace vertex_packing
+{
+	[[nodiscard]] PackedVertex Pack(Vertex const& vertex, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax);
+
+	[[nodiscard]] std::vector<PackedVertex> Pack(std::span<Vertex const> vertices, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax);
+
+	[[nodiscard]] glm::vec3 UnpackPosition(PackedVertex const& vertex, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax);
+
+	// octahedral mapping of a unit vector onto [-1, 1]^2
+	[[nodiscard]] glm::vec2 EncodeOctahedral(glm::vec3 const& direction);
+	[[nodiscard]] glm::vec3 DecodeOctahedral(glm::vec2 const& encoded);
+
+	// bounds min and extent as specialization constants 0 to 5, every vertex shader reading PackedVertex declares them
+	void AddDequantizationConstants(vkc::ShaderStage& stage, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax);
+}
+
+#endif //VULKANRESEARCH_VERTEX_PACKING_H
@@ -1,12 +1,15 @@
-#version 450
+#version 460
+#extension GL_GOOGLE_include_directive : require
 
-layout (location = 0) in vec3 inPosition;
+#include "quantization.glsl"
+
+layout (location = 0) in vec4 inPosition;
 layout (location = 1) in vec2 inUV;
-layout (location = 2) in vec3 normal;
-layout (location = 3) in vec3 tangent;
-layout (location = 4) in vec3 bitangent;
+layout (location = 2) in vec2 inNormal;
+layout (location = 3) in vec2 inTangent;
 
 layout (location = 0) out vec2 outUV;
+layout (location = 2) flat out uint outDiffuse;
 
 layout (set = 1, binding = 0) uniform ModelViewProjection
 {
@@ -15,8 +18,20 @@ layout (set = 1, binding = 0) uniform ModelViewProjection
     mat4 Projection;
 } mvp;
 
+// TextureIndices of the cluster's mesh, written next to its draw by the culling pass
+layout (std430, set = 2, binding = 0) readonly buffer DrawData
+{
+    uvec4 drawTextures[];
+};
+
+layout (push_constant) uniform Constants
+{
+    uint firstDraw;
+};
+
 void main()
 {
-    gl_Position = mvp.Projection * mvp.View * mvp.Model * vec4(inPosition, 1.);
+    gl_Position = mvp.Projection * mvp.View * mvp.Model * vec4(DequantizePosition(inPosition.xyz), 1.);
     outUV = inUV;
+    outDiffuse = drawTextures[firstDraw + gl_DrawID].x;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 layout (location = 0) in vec2 inUV;
 layout (location = 1) in vec4 inPosition;
+layout (location = 2) flat in uint inDiffuse;
 
 layout (set = 0, binding = 0) uniform sampler samp;
 layout (set = 0, binding = 1) uniform texture2D textures[];
@@ -11,13 +12,12 @@ layout (push_constant) uniform constants
 {
     vec3 LightPosition;
     float FarPlane;
-    layout(offset = 80)uint Diffuse;
 };
 
 void main()
 {
     const float alphaThreshold = .95f;
-    if (texture(sampler2D(textures[nonuniformEXT(Diffuse)], samp), inUV).a < alphaThreshold)
+    if (texture(sampler2D(textures[nonuniformEXT(inDiffuse)], samp), inUV).a < alphaThreshold)
     discard;
 
     // get distance between fragment and light source
@@ -7,13 +7,14 @@ layout (location = 1) in mat3 inTBN;
 layout (set = 0, binding = 0) uniform sampler samp;
 layout (set = 0, binding = 1) uniform texture2D textures[];
 
-layout (push_constant) uniform constants
+// TextureStreamer feedback, log2 of the texel resolution each texture was sampled at plus one, 0 when unsampled
+layout (set = 1, binding = 4) buffer TextureFeedback
 {
-    uint Diffuse;
-    uint Normals;
-    uint Metalness;
-    uint Roughness;
-} textureIndices;
+    uint requestedResolutions[];
+};
+
+// diffuse, normals, metalness and roughness
+layout (location = 4) flat in uvec4 inTextureIndices;
 
 // https://knarkowicz.wordpress.com/2014/04/16/octahedron-normal-vector-encoding/
 vec2 OctWrap(vec2 v)
@@ -30,18 +31,44 @@ vec2 Encode(vec3 n)
     return n.xy;
 }
 
+// isotropic estimate from the larger uv footprint, resolution-independent so the streamer can map it onto any chain
+uint CalculateRequestedResolution()
+{
+    float footprint = max(length(dFdx(inUV)), length(dFdy(inUV)));
+    return uint(clamp(ceil(-log2(max(footprint, 1e-8))), 0.0, 30.0)) + 1;
+}
+
+void RequestResolution(uint textureIndex, uint resolution)
+{
+    if (textureIndex < requestedResolutions.length() && requestedResolutions[textureIndex] < resolution)
+        atomicMax(requestedResolutions[textureIndex], resolution);
+}
+
 layout (location = 0) out vec4 outAlbedo;
 layout (location = 1) out vec4 outMaterial;
 
 void main()
 {
-    vec3 normal = texture(sampler2D(textures[nonuniformEXT(textureIndices.Normals)], samp), inUV).rgb;
-    normal = normal * 2.0 - 1.0;
+    // one pixel in an 8x8 tile reports, enough to find every texture on screen without contending on the atomics
+    uint resolution = CalculateRequestedResolution();
+    if ((uint(gl_FragCoord.x) & 7u) == 0u && (uint(gl_FragCoord.y) & 7u) == 0u)
+    {
+        RequestResolution(inTextureIndices.x, resolution);
+        RequestResolution(inTextureIndices.y, resolution);
+        RequestResolution(inTextureIndices.z, resolution);
+        RequestResolution(inTextureIndices.w, resolution);
+    }
+
+    // normal maps only store XY (BC5 / RG8)
+    vec3 normal;
+    normal.xy = texture(sampler2D(textures[nonuniformEXT(inTextureIndices.y)], samp), inUV).rg * 2.0 - 1.0;
+    normal.z = sqrt(max(1.0 - dot(normal.xy, normal.xy), 0.0));
     normal = normalize(inTBN * normal);
 
-    const float metalness = texture(sampler2D(textures[nonuniformEXT(textureIndices.Metalness)], samp), inUV).b;
-    const float roughness = texture(sampler2D(textures[nonuniformEXT(textureIndices.Roughness)], samp), inUV).g;
+    // single channel textures (BC4 / R8)
+    const float metalness = texture(sampler2D(textures[nonuniformEXT(inTextureIndices.z)], samp), inUV).r;
+    const float roughness = texture(sampler2D(textures[nonuniformEXT(inTextureIndices.w)], samp), inUV).r;
 
-    outAlbedo = texture(sampler2D(textures[nonuniformEXT(textureIndices.Diffuse)], samp), inUV);
+    outAlbedo = texture(sampler2D(textures[nonuniformEXT(inTextureIndices.x)], samp), inUV);
     outMaterial = vec4(Encode(normal).rg, roughness, metalness);
 }
\ No newline at end of file
@@ -29,6 +29,9 @@ struct Light
     uint matrixIndex;
 };
 
+// shadow maps are generated once the scene's geometry finished loading, lights are unshadowed until then
+const uint NO_SHADOW_MAP = 0xFFFFFFFFu;
+
 layout (constant_id = 0) const uint LIGHT_COUNT = 1u;
 layout (constant_id = 1) const uint DIRECTIONAL_LIGHT_COUNT = 1u;
 layout (constant_id = 2) const uint POINT_LIGHT_COUNT = 0u;
@@ -45,6 +48,32 @@ layout (std430, set = 1, binding = 2) readonly buffer LightMatricesSSBO
 };
 layout (set = 1, binding = 3) uniform sampler shadowSampler;
 
+// unshadowed point lights reaching no further than their radius, shaded through the lists of the pixel's cluster
+layout (constant_id = 6) const uint CLUSTER_GRID_X = 16u;
+layout (constant_id = 7) const uint CLUSTER_GRID_Y = 9u;
+layout (constant_id = 8) const uint CLUSTER_GRID_Z = 24u;
+layout (constant_id = 9) const uint MAX_LIGHTS_PER_CLUSTER = 128u;
+
+// PointLight from light_clustering.h
+struct PointLight
+{
+    vec4 positionRadius;
+    vec4 colour;
+};
+
+layout (std430, set = 3, binding = 0) readonly buffer PointLights
+{
+    PointLight pointLights[];
+};
+layout (std430, set = 3, binding = 1) readonly buffer LightGrid
+{
+    uint lightCounts[];
+};
+layout (std430, set = 3, binding = 2) readonly buffer LightIndices
+{
+    uint lightIndices[];
+};
+
 float DistributionGGX(vec3 N, vec3 H, float a)
 {
     float a2 = a * a;
@@ -152,7 +181,9 @@ void main()
         vec4 lightSpacePosition = matrices[matrixIndex] * vec4(worldPosition, 1.f);
         lightSpacePosition /= lightSpacePosition.w;
         const vec3 shadowMapUV = vec3(lightSpacePosition.xy * .5f + .5f, lightSpacePosition.z);
-        const float shadow = texture(sampler2DShadow(textures[lights[lightIndex].shadowMapIndex], shadowSampler), shadowMapUV);
+        float shadow = 1.f;
+        if (lights[lightIndex].shadowMapIndex != NO_SHADOW_MAP)
+            shadow = texture(sampler2DShadow(textures[lights[lightIndex].shadowMapIndex], shadowSampler), shadowMapUV);
 
         Lo += shadow * CalculateLight(viewDirection, lightDirection, normal, lights[lightIndex].colour.rgb, albedoColour.rgb, roughness, metalness, illuminance);
     }
@@ -171,11 +202,39 @@ void main()
 
         vec3 fragToLight = -lights[lightIndex].position.xyz + worldPosition;
         float currentDepth = length(fragToLight) / SHADOW_FAR_PLANE;
-        float shadow = texture(samplerCubeShadow(cubemaps[lights[lightIndex].shadowMapIndex], shadowSampler), vec4(fragToLight, currentDepth)).r;
+        float shadow = 1.f;
+        if (lights[lightIndex].shadowMapIndex != NO_SHADOW_MAP)
+            shadow = texture(samplerCubeShadow(cubemaps[lights[lightIndex].shadowMapIndex], shadowSampler), vec4(fragToLight, currentDepth)).r;
 
         Lo += shadow * CalculateLight(viewDirection, lightDirection, normal, lights[lightIndex].colour.rgb, albedoColour.rgb, roughness, metalness, illuminance);
     }
 
+    // the slices are spaced exponentially between the near and far plane, as light_cluster.comp builds them
+    const float nearPlane = mvp.projection[3][2] / mvp.projection[2][2];
+    const float farPlane = mvp.projection[3][2] / (mvp.projection[2][2] + 1.f);
+    const float viewDepth = -(mvp.view * vec4(worldPosition, 1.f)).z;
+    const float slice = log(max(viewDepth, nearPlane) / nearPlane) / log(farPlane / nearPlane) * float(CLUSTER_GRID_Z);
+    const uvec2 tile = min(uvec2(inUV * vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y)), uvec2(CLUSTER_GRID_X, CLUSTER_GRID_Y) - 1u);
+    const uint cluster = tile.x + CLUSTER_GRID_X * (tile.y + CLUSTER_GRID_Y * min(uint(slice), CLUSTER_GRID_Z - 1u));
+
+    const uint clusterLightCount = lightCounts[cluster];
+    for (uint slot = 0u; slot < clusterLightCount; ++slot)
+    {
+        const PointLight light = pointLights[lightIndices[cluster * MAX_LIGHTS_PER_CLUSTER + slot]];
+        const vec3 toLight = light.positionRadius.xyz - worldPosition;
+        const float distance = length(toLight);
+        if (distance >= light.positionRadius.w)
+            continue;
+
+        const float luminousIntensity = light.colour.a / (4.f * PI);
+        // inverse square falloff windowed to reach zero at the radius
+        const float ratio = distance / light.positionRadius.w;
+        const float window = clamp(1.f - ratio * ratio * ratio * ratio, 0.f, 1.f);
+        const float attenuation = window * window / max(distance * distance, 0.0001f);
+
+        Lo += CalculateLight(viewDirection, toLight / max(distance, 0.0001f), normal, light.colour.rgb, albedoColour.rgb, roughness, metalness, luminousIntensity * attenuation);
+    }
+
     vec3 ambient = vec3(.03f) * albedoColour.rgb;
     vec3 colour = ambient + Lo;
 
@@ -0,0 +1,18 @@
+#ifndef QUANTIZATION_GLSL
+#define QUANTIZATION_GLSL
+
+// PackedVertex, positions are unorm inside the scene bounds and w holds the bitangent sign. the bounds are set by
+// vertex_packing::AddDequantizationConstants
+layout (constant_id = 0) const float BOUNDS_MIN_X = 0.f;
+layout (constant_id = 1) const float BOUNDS_MIN_Y = 0.f;
+layout (constant_id = 2) const float BOUNDS_MIN_Z = 0.f;
+layout (constant_id = 3) const float BOUNDS_EXTENT_X = 1.f;
+layout (constant_id = 4) const float BOUNDS_EXTENT_Y = 1.f;
+layout (constant_id = 5) const float BOUNDS_EXTENT_Z = 1.f;
+
+vec3 DequantizePosition(vec3 quantized)
+{
+    return vec3(BOUNDS_MIN_X, BOUNDS_MIN_Y, BOUNDS_MIN_Z) + quantized * vec3(BOUNDS_EXTENT_X, BOUNDS_EXTENT_Y, BOUNDS_EXTENT_Z);
+}
+
+#endif
@@ -1,21 +1,33 @@
-#version 450
+#version 460
+#extension GL_GOOGLE_include_directive : require
 
-layout (location = 0) in vec3 inPosition;
+#include "quantization.glsl"
+
+layout (location = 0) in vec4 inPosition;
 layout (location = 1) in vec2 inUV;
-layout (location = 2) in vec3 normal;
-layout (location = 3) in vec3 tangent;
-layout (location = 4) in vec3 bitangent;
+layout (location = 2) in vec2 inNormal;
+layout (location = 3) in vec2 inTangent;
 
 layout (location = 0) out vec2 outUV;
 layout (location = 1) out vec4 outPosition;
+layout (location = 2) flat out uint outDiffuse;
 layout (push_constant) uniform Constants
 {
     layout (offset = 16)mat4 lightSpaceTransform;
+    uint firstDraw;
+};
+
+// TextureIndices of the cluster's mesh, written next to its draw by the culling pass
+layout (std430, set = 1, binding = 0) readonly buffer DrawData
+{
+    uvec4 drawTextures[];
 };
 
 void main()
 {
-    gl_Position = lightSpaceTransform * vec4(inPosition, 1.f);
-    outPosition = vec4(inPosition, 1.f);
+    vec3 position = DequantizePosition(inPosition.xyz);
+    gl_Position = lightSpaceTransform * vec4(position, 1.f);
+    outPosition = vec4(position, 1.f);
     outUV = inUV;
+    outDiffuse = drawTextures[firstDraw + gl_DrawID].x;
 }
\ No newline at end of file
@@ -1,4 +1,7 @@
-#version 450
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+#include "quantization.glsl"
 
 layout (set = 1, binding = 0) uniform ModelViewProjection
 {
@@ -7,22 +10,46 @@ layout (set = 1, binding = 0) uniform ModelViewProjection
     mat4 projection;
 } mvp;
 
-layout (location = 0) in vec3 inPosition;
+// TextureIndices of the cluster's mesh, written next to its draw by the culling pass
+layout (std430, set = 2, binding = 0) readonly buffer DrawData
+{
+    uvec4 drawTextures[];
+};
+
+layout (push_constant) uniform Constants
+{
+    uint firstDraw;
+};
+
+layout (location = 0) in vec4 inPosition;
 layout (location = 1) in vec2 inUV;
-layout (location = 2) in vec3 normal;
-layout (location = 3) in vec3 tangent;
-layout (location = 4) in vec3 bitangent;
+layout (location = 2) in vec2 inNormal;
+layout (location = 3) in vec2 inTangent;
 
 layout (location = 0) out vec2 outUV;
 layout (location = 1) out mat3 outTBN;
+layout (location = 4) flat out uvec4 outTextureIndices;
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3 direction = vec3(encoded, 1. - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.);
+    direction.xy += vec2(direction.x >= 0. ? -fold : fold, direction.y >= 0. ? -fold : fold);
+    return normalize(direction);
+}
 
 void main()
 {
+    const vec3 normal = DecodeOctahedral(inNormal);
+    const vec3 tangent = DecodeOctahedral(inTangent);
+    const vec3 bitangent = cross(normal, tangent) * (inPosition.w * 2. - 1.);
+
     const vec3 T = normalize(vec3(mvp.model * vec4(tangent, 0.0)));
     const vec3 B = normalize(vec3(mvp.model * vec4(bitangent, 0.0)));
     const vec3 N = normalize(vec3(mvp.model * vec4(normal, 0.0)));
     outTBN = mat3(T, B, N);
 
-    gl_Position = mvp.projection * mvp.view * mvp.model * vec4(inPosition, 1.);
+    gl_Position = mvp.projection * mvp.view * mvp.model * vec4(DequantizePosition(inPosition.xyz), 1.);
     outUV = inUV;
+    outTextureIndices = drawTextures[firstDraw + gl_DrawID];
 }
@@ -2,10 +2,13 @@
 
 #include <iostream>
 
+#include "cluster_culling.h"
 #include "command_pool.h"
 #include "datatypes.h"
+#include "depth_pyramid.h"
 #include "helper.h"
 #include "image.h"
+#include "parallel_recorder.h"
 #include "shadow_generation.h"
 #include "shader_stage.h"
 #include "pipeline_cache.h"
@@ -14,28 +17,91 @@
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_vulkan.h"
 
+#include <algorithm>
+#include <array>
+#include <fstream>
 #include <span>
 #include <chrono>
+#include <random>
+#include <thread>
 #include <ranges>
 
+#include "pipeline_manager.h"
 #include "scene.h"
+#include "shader_reloader.h"
+#include "startup_timeline.h"
+#include "uploader.h"
+#include "vertex_packing.h"
 
 #include "image_view.h"
 
-void App::CreatePipelineCache()
+namespace
 {
-	try
+	VkPipelineColorBlendAttachmentState OpaqueBlendAttachment()
+	{
+		VkPipelineColorBlendAttachmentState blendAttachment{};
+		blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT
+										 | VK_COLOR_COMPONENT_G_BIT
+										 | VK_COLOR_COMPONENT_B_BIT
+										 | VK_COLOR_COMPONENT_A_BIT;
+		return blendAttachment;
+	}
+
+	void DrawStartupSpan
+	(
+		std::vector<startup_timeline::Span> const& spans
+		, std::vector<std::vector<uint32_t>> const& children
+		, uint32_t                                  index
+	)
 	{
-		if (std::vector cache = help::ReadFile(std::format("data/pipelines_{}_{}.cache"
-														   , m_PhysicalDevice.properties.deviceID
-														   , help::UUIDToHex(m_PhysicalDevice.properties.pipelineCacheUUID)));
-			!cache.empty())
+		startup_timeline::Span const& span = spans[index];
+		ImGui::TableNextRow();
+		ImGui::TableSetColumnIndex(0);
+		ImGuiTreeNodeFlags const flags = children[index].empty()
+										 ? ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen
+										 : ImGuiTreeNodeFlags_None;
+		bool const open = ImGui::TreeNodeEx(reinterpret_cast<void*>(static_cast<uintptr_t>(index)), flags, "%s", span.Name.c_str());
+
+		ImGui::TableSetColumnIndex(1);
+		if (span.Finished)
+			ImGui::Text("%.2f", span.Duration * 1000.);
+		else
+			ImGui::Text("%.2f running", span.Duration * 1000.);
+
+		ImGui::TableSetColumnIndex(2);
+		if (span.Bytes > 0 && span.Items > 0)
+			ImGui::Text("%.2f MiB, %llu %s", static_cast<double>(span.Bytes) / (1024 * 1024)
+						, static_cast<unsigned long long>(span.Items), span.ItemName.c_str());
+		else if (span.Bytes > 0)
+			ImGui::Text("%.2f MiB", static_cast<double>(span.Bytes) / (1024 * 1024));
+		else if (span.Items > 0)
+			ImGui::Text("%llu %s", static_cast<unsigned long long>(span.Items), span.ItemName.c_str());
+
+		if (open && !children[index].empty())
 		{
-			vkc::PipelineCache::Data const cacheData{ std::move(cache) };
-			m_PipelineCache = std::make_unique<
-				vkc::PipelineCache>(m_Context, std::span{ cacheData.Cache }, VkPipelineCacheCreateFlagBits{});
+			for (uint32_t const child: children[index])
+				DrawStartupSpan(spans, children, child);
+			ImGui::TreePop();
 		}
 	}
+}
+
+void App::CreatePipelineCache()
+{
+	startup_timeline::Scope const scope{ "CreatePipelineCache" };
+	try
+	{
+		// the driver copies the blob while the cache is created, so it is read straight out of the mapping
+		MappedFile const cache{
+			std::format("data/pipelines_{}_{}.cache"
+						, m_PhysicalDevice.properties.deviceID
+						, help::UUIDToHex(m_PhysicalDevice.properties.pipelineCacheUUID))
+		};
+		m_PipelineCache = std::make_unique<vkc::PipelineCache>(m_Context
+															   , cache.GetView<char>(0, cache.GetSize())
+															   , VkPipelineCacheCreateFlagBits{});
+		m_PipelineCacheWarm = true;
+	}
 	catch (const std::runtime_error&)
 	{
 		std::cerr << "Cache not found. Generating new pipeline cache" << std::endl;
@@ -50,9 +116,11 @@ void App::CreatePipelineCache()
 }
 
 App::App(int width, int height)
+	: m_StartTime{ std::chrono::steady_clock::now() }
 {
-	auto const start = std::chrono::steady_clock::now();
-	double     initDuration{};
+	startup_timeline::Scope const startup{ "App constructor" };
+	auto const                    start = m_StartTime;
+	double                        initDuration{};
 	//
 	{
 		m_Camera = std::make_unique<Camera>(glm::vec3(.0f, .0f, .0f)
@@ -65,7 +133,12 @@ App::App(int width, int height)
 		CreateSurface();
 		CreateDevice();
 		CreatePipelineCache();
-		CreateSwapchain();
+		//
+		{
+			// also recreated on resize, only the first one is part of startup
+			startup_timeline::Scope const scope{ "CreateSwapchain" };
+			CreateSwapchain();
+		}
 		m_Context.DeletionQueue.Push([this]
 		{
 			std::vector<VkImageView> views;
@@ -83,32 +156,44 @@ App::App(int width, int height)
 	{
 		auto const localStart = std::chrono::steady_clock::now();
 		CreateScene();
-		auto const end  = std::chrono::steady_clock::now();
-		m_CPUTimings[2] = Timing{ "Scene load", std::chrono::duration<double>(end - localStart).count() };
+		auto const end   = std::chrono::steady_clock::now();
+		m_CPUTimings[20] = Timing{ PROGRESSIVE_LOADING ? "Scene open" : "Scene load", std::chrono::duration<double>(end - localStart).count() };
 	}
 	//
 	{
 		auto const localStart = std::chrono::steady_clock::now();
 		CreateResources();
 		CreateDescriptorSetLayouts();
-		CreateGraphicsPipeline();
+		//
+		{
+			auto const pipelinesStart = std::chrono::steady_clock::now();
+			CreateGraphicsPipeline();
+			auto const pipelinesEnd = std::chrono::steady_clock::now();
+			m_CPUTimings[11]        = Timing{
+				m_PipelineCacheWarm ? "Pipeline creation (warm cache)" : "Pipeline creation (cold cache)"
+				, std::chrono::duration<double>(pipelinesEnd - pipelinesStart).count()
+			};
+		}
 		CreateSyncObjects();
 		CreateDescriptorPool();
 		CreateDescriptorSets();
 		auto const end = std::chrono::steady_clock::now();
 		initDuration += std::chrono::duration<double>(end - localStart).count();
 	}
-	auto const end  = std::chrono::steady_clock::now();
-	m_CPUTimings[1] = Timing{ "Vulkan init", initDuration };
-	m_CPUTimings[3] = Timing{ "Total init", std::chrono::duration<double>(end - start).count() };
+	auto const end   = std::chrono::steady_clock::now();
+	m_CPUTimings[10] = Timing{ "Vulkan init", initDuration };
+	m_CPUTimings[30] = Timing{ "Total init", std::chrono::duration<double>(end - start).count() };
 	InitImGUI();
-	GenerateShadowMaps();
+	// progressive loading generates them from the render loop instead
+	if (m_Scene->IsGeometryLoaded())
+		GenerateShadowMaps();
 }
 
 App::~App() = default;
 
 void App::Run()
 {
+	bool firstFrame{ true };
 	// main loop
 	while (!glfwWindowShouldClose(m_Context.Window))
 	{
@@ -117,6 +202,50 @@ void App::Run()
 
 		glfwPollEvents();
 		m_Context.DispatchTable.waitForFences(1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+		m_Uploader->Collect();
+		// the frame that last wrote the query completed with the fence
+		if (m_OverdrawQueried[m_CurrentFrame])
+		{
+			uint64_t samples{};
+			if (m_Context.DispatchTable.getQueryPoolResults(m_OverdrawQueryPool
+															, m_CurrentFrame
+															, 1
+															, sizeof(samples)
+															, &samples
+															, sizeof(samples)
+															, VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+			{
+				VkExtent2D const extent = m_Context.Swapchain.extent;
+				m_DepthOverdraw         = static_cast<double>(samples) / (static_cast<double>(extent.width) * extent.height);
+			}
+		}
+		m_Pipelines->Update();
+		UpdateTextureSamplerDescriptor();
+		if (!m_FullyLoaded)
+		{
+			auto const loadingStart = std::chrono::steady_clock::now();
+			m_Scene->ContinueLoading();
+			if (!m_ShadowMapsGenerated && m_Scene->IsGeometryLoaded())
+				GenerateShadowMaps();
+			auto const loadingEnd = std::chrono::steady_clock::now();
+			m_CPUTimings[41]      = Timing{ "Progressive loading", std::chrono::duration<double>(loadingEnd - loadingStart).count() };
+		}
+		//
+		{
+			auto const streamingStart = std::chrono::steady_clock::now();
+			m_Scene->GetTextureStreamer().Update(m_CurrentFrame, static_cast<uint64_t>(m_Config.TextureBudgetMiB) * 1024 * 1024);
+			UpdateTextureDescriptors();
+			auto const streamingEnd = std::chrono::steady_clock::now();
+			m_CPUTimings[40]        = Timing{ "Texture streaming", std::chrono::duration<double>(streamingEnd - streamingStart).count() };
+		}
+		if (m_RegenerateShadowMaps)
+		{
+			m_RegenerateShadowMaps = false;
+			RegenerateShadowMaps();
+		}
+		// shadow map indices show up in the frame whose descriptors were just given the maps
+		if (!m_LightSSBOs.empty())
+			m_LightSSBOs[m_CurrentFrame].UpdateData(m_Scene->GetLights());
 
 		world_time::Tick();
 		m_Camera->Update(m_Context.Window);
@@ -124,6 +253,8 @@ void App::Run()
 		ModelViewProj const mvp{ glm::mat4{ 1 }, m_Camera->CalculateViewMatrix(), m_Camera->GetProjection() };
 
 		m_MVPUBOs[m_CurrentFrame].UpdateData(mvp);
+		m_LightClusterer->Update(m_CurrentFrame
+								 , std::span{ m_ClusteredLights }.first(static_cast<size_t>(m_Config.ClusteredLightCount)));
 		uint32_t imageIndex{};
 		if (auto const result = m_Context.DispatchTable.acquireNextImageKHR(m_Context.Swapchain
 																			, UINT64_MAX
@@ -141,6 +272,9 @@ void App::Run()
 
 		using namespace std::placeholders;
 		commandBuffer.Begin(m_Context);
+		// meshes and streamed textures are only used once their batch completed, the wait on the scene's value is
+		// already satisfied but makes the copies visible when no ownership transfer is recorded
+		uint64_t const uploadValue = std::max(m_Uploader->RecordAcquireBarriers(commandBuffer, true), m_Scene->GetUploadValue());
 		m_QueryPool->Reset(commandBuffer);
 		m_QueryPool->RecordWholePipe(commandBuffer
 									 , "Total GPU frametime"
@@ -151,14 +285,24 @@ void App::Run()
 									 });
 		commandBuffer.End(m_Context);
 
-		Submit(commandBuffer);
+		Submit(commandBuffer, uploadValue);
 
 		Present(imageIndex);
 
 		++m_CurrentFrame;
 		m_CurrentFrame %= m_FramesInFlight;
-		auto const end  = std::chrono::steady_clock::now();
-		m_CPUTimings[5] = Timing{ "CPU frame time", std::chrono::duration<double>(end - start).count() };
+		auto const end   = std::chrono::steady_clock::now();
+		m_CPUTimings[50] = Timing{ "CPU frame time", std::chrono::duration<double>(end - start).count() };
+		if (firstFrame)
+		{
+			m_CPUTimings[31] = Timing{ "Time to first frame", std::chrono::duration<double>(end - m_StartTime).count() };
+			firstFrame       = false;
+		}
+		if (!m_FullyLoaded && m_Scene->IsLoaded())
+		{
+			m_FullyLoaded = true;
+			RecordLoadTimings();
+		}
 	}
 
 	if (m_Context.DispatchTable.deviceWaitIdle() != VK_SUCCESS)
@@ -169,6 +313,7 @@ void App::Run()
 
 void App::InitImGUI() const
 {
+	startup_timeline::Scope const scope{ "InitImGUI" };
 	ImGui::CreateContext();
 	ImGui_ImplGlfw_InitForVulkan(m_Context.Window, true);
 	ImGui_ImplVulkan_InitInfo initInfo{};
@@ -197,6 +342,64 @@ void App::DrawImGui()
 	ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(20, 20));
 	ImGui::PushStyleVar(ImGuiStyleVar_ChildBorderSize, 4.f);
 	ImGui::Begin("Timing information", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoResize);
+	ImGui::Checkbox("Texture mips", &m_Config.UseTextureMips);
+	ImGui::Checkbox("Occlusion culling", &m_Config.OcclusionCulling);
+	//
+	{
+		char const* const orders[]{ "Scene", "Front to back", "Material" };
+		int               order = static_cast<int>(m_Config.CameraDrawOrder);
+		if (ImGui::Combo("Draw order", &order, orders, static_cast<int>(std::size(orders))))
+			m_Config.CameraDrawOrder = static_cast<draw_sorting::Order>(order);
+	}
+	//
+	{
+		// switching lights compiles another lighting variant in the background, the startup one is drawn meanwhile
+		bool directionalLights = m_Config.EnableDirectionalLights;
+		bool pointLights       = m_Config.EnablePointLights;
+		bool changed           = ImGui::Checkbox("Directional lights", &directionalLights);
+		changed |= ImGui::Checkbox("Point lights", &pointLights);
+		if (changed)
+		{
+			m_Config.EnableDirectionalLights = directionalLights;
+			m_Config.EnablePointLights       = pointLights;
+			RequestLightingPipeline();
+		}
+	}
+	// changing the count only changes what the next frames upload, the lighting pipeline stays the same
+	ImGui::SliderInt("Clustered point lights", &m_Config.ClusteredLightCount, 0, static_cast<int>(m_ClusteredLights.size()));
+	//
+	{
+		LightClusterer::Statistics const clustering = m_LightClusterer->GetStatistics();
+		ImGui::Text("%.1f lights per cluster on average, %u at most, %u clusters over the limit"
+					, static_cast<double>(clustering.AssignedLights) / LightClusterer::CLUSTER_COUNT
+					, clustering.MaxClusterLights
+					, clustering.OverflowingClusters);
+	}
+	//
+	{
+		// the shadow views are recorded once, regenerating them measures the recording with another thread count
+		ImGui::SliderInt("Recording threads", &m_Config.RecordingThreadCount, 0, static_cast<int>(std::thread::hardware_concurrency()));
+		if (m_ShadowMapsGenerated && ImGui::Button("Regenerate shadow maps"))
+			m_RegenerateShadowMaps = true;
+		for (auto const& [workerCount, duration]: m_ShadowRecordingDurations)
+			ImGui::Text("Shadow recording with %u threads %.4f s", workerCount, duration);
+	}
+	ImGui::SliderFloat("LOD pixel error", &m_Config.LodPixelError, .25f, 16.f, "%.2f", ImGuiSliderFlags_Logarithmic);
+	ImGui::SliderInt("Texture budget (MiB)", &m_Config.TextureBudgetMiB, 16, 2048, "%d", ImGuiSliderFlags_Logarithmic);
+	//
+	{
+		TextureStreamer::Statistics const streaming = m_Scene->GetTextureStreamer().GetStatistics();
+		ImGui::Text("Textures resident %.1f / requested %.1f / full %.1f MiB, %u uploads in flight, %u placeholders"
+					, static_cast<double>(streaming.ResidentBytes) / (1024 * 1024)
+					, static_cast<double>(streaming.RequestedBytes) / (1024 * 1024)
+					, static_cast<double>(streaming.FullChainBytes) / (1024 * 1024)
+					, streaming.PendingUploads
+					, streaming.Placeholders);
+	}
+	ImGui::Text("Staging ring peak %.1f / %.1f MiB, %u stalls"
+				, static_cast<double>(m_Uploader->GetStagingRing().GetPeakUsage()) / (1024 * 1024)
+				, static_cast<double>(m_Uploader->GetStagingRing().GetCapacity()) / (1024 * 1024)
+				, m_Uploader->GetStagingStallCount());
 	if (ImGui::CollapsingHeader("CPU Timings", ImGuiTreeNodeFlags_DefaultOpen))
 	{
 		if (ImGui::BeginTable("CPU_Timing_Table", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
@@ -258,6 +461,115 @@ void App::DrawImGui()
 			ImGui::EndTable();
 		}
 	}
+	ImGui::Spacing();
+	ImGui::Separator();
+	ImGui::Spacing();
+	if (ImGui::CollapsingHeader("Cluster culling", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		// one sample per pixel, a pixel covered by nothing counts as zero
+		ImGui::Text("Depth prepass overdraw %.2f samples per pixel", m_DepthOverdraw);
+		if (ImGui::BeginTable("Cluster_Culling_Table", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Pass");
+			ImGui::TableSetupColumn("Visible meshes", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+			ImGui::TableSetupColumn("Visible clusters", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+			ImGui::TableSetupColumn("Culled (%)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+			ImGui::TableSetupColumn("Occluded (%)", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+			ImGui::TableSetupColumn("Triangles", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+			ImGui::TableHeadersRow();
+
+			uint32_t const directionalCount = m_Scene->GetDirectionalLightCount();
+			std::pair<char const*, ClusterCuller::Statistics> const rows[]
+			{
+				{ "Depth prepass + GBuffer", m_ClusterCuller->GetStatistics(m_CurrentFrame, 1) }
+				, { "Directional shadows", m_ClusterCuller->GetStatistics(m_FramesInFlight, directionalCount) }
+				, {
+					"Point shadows"
+					, m_ClusterCuller->GetStatistics(m_FramesInFlight + directionalCount, 6 * m_Scene->GetPointLightCount())
+				}
+			};
+			for (auto const& [label, statistics]: rows)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::TextUnformatted(label);
+
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%u / %u", statistics.VisibleMeshes, statistics.TotalMeshes);
+
+				ImGui::TableSetColumnIndex(2);
+				ImGui::Text("%u / %u", statistics.Visible, statistics.Total);
+
+				ImGui::TableSetColumnIndex(3);
+				ImGui::Text("%.1f", statistics.Total > 0
+										? 100.0 * (statistics.Total - statistics.Visible) / statistics.Total
+										: .0);
+
+				// of the clusters that passed the frustum and cone tests
+				ImGui::TableSetColumnIndex(4);
+				uint32_t const tested = statistics.Visible + statistics.Occluded;
+				ImGui::Text("%.1f", tested > 0 ? 100.0 * statistics.Occluded / tested : .0);
+
+				ImGui::TableSetColumnIndex(5);
+				ImGui::Text("%u", statistics.Triangles);
+			}
+			ImGui::EndTable();
+		}
+	}
+	ImGui::Spacing();
+	ImGui::Separator();
+	ImGui::Spacing();
+	if (ImGui::CollapsingHeader("Pipelines"))
+	{
+		ImGui::Text("Pipeline cache hits %u, misses %u", m_Pipelines->GetCacheHits(), m_Pipelines->GetCacheMisses());
+		if (ImGui::BeginTable("Pipeline_Table", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Pipeline");
+			ImGui::TableSetupColumn("Compile (ms)", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+			ImGui::TableSetupColumn("Cache", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+			ImGui::TableHeadersRow();
+
+			for (PipelineManager::Statistics const& statistics: m_Pipelines->GetStatistics())
+			{
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::TextUnformatted(statistics.Key.c_str());
+
+				ImGui::TableSetColumnIndex(1);
+				if (statistics.Ready)
+					ImGui::Text("%.2f", statistics.CompileMilliseconds);
+				else
+					ImGui::TextUnformatted("compiling");
+
+				ImGui::TableSetColumnIndex(2);
+				ImGui::TextUnformatted(!statistics.Ready ? "-" : statistics.CacheHit ? "hit" : "miss");
+			}
+			ImGui::EndTable();
+		}
+	}
+	ImGui::Spacing();
+	ImGui::Separator();
+	ImGui::Spacing();
+	if (ImGui::CollapsingHeader("Startup timeline"))
+	{
+		std::vector<startup_timeline::Span> const spans = startup_timeline::GetSpans();
+		std::vector<std::vector<uint32_t>>        children(spans.size());
+		std::vector<uint32_t>                     roots;
+		for (uint32_t index{}; index < spans.size(); ++index)
+			(spans[index].Parent == startup_timeline::NO_PARENT ? roots : children[spans[index].Parent]).push_back(index);
+
+		if (ImGui::BeginTable("Startup_Timeline_Table", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Scope");
+			ImGui::TableSetupColumn("Duration (ms)", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+			ImGui::TableSetupColumn("Counters", ImGuiTableColumnFlags_WidthFixed, 160.0f);
+			ImGui::TableHeadersRow();
+
+			for (uint32_t const root: roots)
+				DrawStartupSpan(spans, children, root);
+			ImGui::EndTable();
+		}
+	}
 	ImGui::End();
 	ImGui::PopStyleVar();
 	ImGui::PopStyleVar();
@@ -265,6 +577,7 @@ void App::DrawImGui()
 
 void App::CreateWindow(int width, int height)
 {
+	startup_timeline::Scope const scope{ "CreateWindow" };
 	glfwInit();
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -278,6 +591,7 @@ void App::CreateWindow(int width, int height)
 
 void App::CreateInstance()
 {
+	startup_timeline::Scope const scope{ "CreateInstance" };
 	vkb::InstanceBuilder instanceBuilder{};
 	auto const           instanceResult = instanceBuilder
 								.use_default_debug_messenger()
@@ -298,6 +612,7 @@ void App::CreateInstance()
 
 void App::CreateSurface()
 {
+	startup_timeline::Scope const scope{ "CreateSurface" };
 	// create surface
 	if (VkResult const result = glfwCreateWindowSurface(m_Context.Instance, m_Context.Window, nullptr, &m_Context.Surface);
 		result != VK_SUCCESS)
@@ -314,8 +629,10 @@ void App::CreateSurface()
 
 void App::CreateDevice()
 {
+	startup_timeline::Scope const scope{ "CreateDevice" };
 	VkPhysicalDeviceVulkan11Features features11{};
-	features11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+	features11.sType                = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+	features11.shaderDrawParameters = VK_TRUE;
 	VkPhysicalDeviceVulkan12Features features12{};
 	features12.sType                                        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 	features12.runtimeDescriptorArray                       = VK_TRUE;
@@ -324,6 +641,13 @@ void App::CreateDevice()
 	features12.descriptorBindingVariableDescriptorCount     = VK_TRUE;
 	features12.descriptorIndexing                           = VK_TRUE;
 	features12.shaderSampledImageArrayNonUniformIndexing    = VK_TRUE;
+	features12.timelineSemaphore                            = VK_TRUE;
+	features12.drawIndirectCount                            = VK_TRUE;
+	VkPhysicalDeviceFeatures features{};
+	features.samplerAnisotropy        = VK_TRUE;
+	features.textureCompressionBC     = VK_TRUE;
+	features.fragmentStoresAndAtomics = VK_TRUE;
+	features.occlusionQueryPrecise    = VK_TRUE;
 	VkPhysicalDeviceVulkan13Features features13{};
 	features13.sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
 	features13.dynamicRendering = VK_TRUE;
@@ -334,7 +658,7 @@ void App::CreateDevice()
 	vkb::PhysicalDeviceSelector selector{ m_Context.Instance };
 	auto const                  physicalDeviceResult = selector
 									  .prefer_gpu_device_type()
-									  // .add_required_extension_features(features)
+									  .set_required_features(features)
 									  .add_required_extension_features(features11)
 									  .add_required_extension_features(features12)
 									  .add_required_extension_features(features13)
@@ -412,6 +736,7 @@ void App::CreateSwapchain()
 
 void App::CreateSyncObjects()
 {
+	startup_timeline::Scope const scope{ "CreateSyncObjects" };
 	VkSemaphoreCreateInfo semaphoreCreateInfo{};
 	semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 	VkFenceCreateInfo fenceCreateInfo{};
@@ -441,6 +766,7 @@ void App::CreateSyncObjects()
 
 void App::CreateDescriptorSetLayouts()
 {
+	startup_timeline::Scope const scope{ "CreateDescriptorSetLayouts" };
 	//
 	{
 		vkc::DescriptorSetLayoutBuilder builder{ m_Context };
@@ -451,6 +777,7 @@ void App::CreateDescriptorSetLayouts()
 										  .AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
 										  .AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
 										  .AddBinding(3, VK_DESCRIPTOR_TYPE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+										  .AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
 										  .Build();
 
 		m_FrameDescSetLayout = std::make_unique<vkc::DescriptorSetLayout>(std::move(layout));
@@ -479,18 +806,30 @@ void App::CreateDescriptorSetLayouts()
 		samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
 		samplerCreateInfo.compareEnable           = VK_FALSE;
 
+		// base level only, kept to compare pass timings against the mipmapped sampler
+		m_Context.DispatchTable.createSampler(&samplerCreateInfo, nullptr, &m_NoMipTextureSampler);
+
+		samplerCreateInfo.mipmapMode       = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerCreateInfo.maxLod           = VK_LOD_CLAMP_NONE;
+		samplerCreateInfo.anisotropyEnable = VK_TRUE;
+		samplerCreateInfo.maxAnisotropy    = std::min(16.f, m_PhysicalDevice.properties.limits.maxSamplerAnisotropy);
 		m_Context.DispatchTable.createSampler(&samplerCreateInfo, nullptr, &m_TextureSampler);
 
-		samplerCreateInfo.addressModeU  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.addressModeV  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.addressModeW  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.compareEnable = VK_TRUE;
-		samplerCreateInfo.compareOp     = VK_COMPARE_OP_LESS;
+		samplerCreateInfo.mipmapMode       = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerCreateInfo.maxLod           = .0f;
+		samplerCreateInfo.anisotropyEnable = VK_FALSE;
+		samplerCreateInfo.maxAnisotropy    = 1.f;
+		samplerCreateInfo.addressModeU     = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeV     = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeW     = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.compareEnable    = VK_TRUE;
+		samplerCreateInfo.compareOp        = VK_COMPARE_OP_LESS;
 		m_Context.DispatchTable.createSampler(&samplerCreateInfo, nullptr, &m_ShadowSampler);
 
 		m_Context.DeletionQueue.Push([this]
 		{
 			m_Context.DispatchTable.destroySampler(m_TextureSampler, nullptr);
+			m_Context.DispatchTable.destroySampler(m_NoMipTextureSampler, nullptr);
 			m_Context.DispatchTable.destroySampler(m_ShadowSampler, nullptr);
 		});
 
@@ -516,6 +855,7 @@ void App::CreateDescriptorSetLayouts()
 
 void App::GenerateShadowMaps()
 {
+	startup_timeline::Scope const scope{ "GenerateShadowMaps" };
 	//
 	{
 		std::vector<vkc::Image>     directionalShadowMaps;
@@ -524,13 +864,12 @@ void App::GenerateShadowMaps()
 		std::vector<vkc::Image>                  pointShadowMaps;
 		std::vector<std::vector<vkc::ImageView>> pointShadowMapViews;
 
-		constexpr VkExtent2D shadowMapResolution{ 2048, 2048 };
-		vkc::ImageBuilder    builder{ m_Context };
+		vkc::ImageBuilder builder{ m_Context };
 		builder
 			.SetAspectFlags(m_DepthImage->GetAspect())
 			.SetFormat(m_DepthImage->GetFormat())
 			.SetType(VK_IMAGE_TYPE_2D)
-			.SetExtent(shadowMapResolution);
+			.SetExtent(SHADOW_MAP_RESOLUTION);
 
 		if (m_Scene->GetDirectionalLightCount() > 0)
 			for (uint32_t index{}; index < m_Scene->GetDirectionalLightCount(); ++index)
@@ -566,21 +905,22 @@ void App::GenerateShadowMaps()
 								 , "point shadow map");
 			}
 
-		auto [directionalPipelineLayout, directionalPipeline] = shadow::CreatePipelineForDirectionalShadows(m_Context
-				 , *m_GlobalDescSetLayout
-				 , m_DepthFormat
-				 , shadowMapResolution);
-		auto [pointPipelineLayout, pointPipeline] = shadow::CreatePipelineForPointShadows(m_Context
-																						  , *m_GlobalDescSetLayout
-																						  , m_DepthFormat
-																						  , shadowMapResolution);
+		if (!m_DirectionalShadowPass)
+		{
+			m_DirectionalShadowPass = m_DirectionalShadowPipeline.get();
+			m_PointShadowPass       = m_PointShadowPipeline.get();
+		}
+		auto& [directionalPipelineLayout, directionalPipeline] = *m_DirectionalShadowPass;
+		auto& [pointPipelineLayout, pointPipeline]             = *m_PointShadowPass;
 
-		vkc::CommandBuffer& commandBuffer = m_CommandPool->AllocateCommandBuffer(m_Context);
+		vkc::CommandBuffer& commandBuffer = m_InitCommandPool->AllocateCommandBuffer(m_Context);
 		commandBuffer.Begin(m_Context, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		// only called once every mesh batch completed
+		uint64_t const uploadValue = std::max(m_Uploader->RecordAcquireBarriers(commandBuffer, true), m_Scene->GetUploadValue());
 		m_QueryPool->Reset(commandBuffer);
 		std::string const label{ "Shadow generation" };
 		m_QueryPool->WriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, label, 0);
-		VkDescriptorSet descSets[]{ m_GlobalDescriptorSets[m_CurrentFrame] };
+		VkDescriptorSet descSets[]{ m_GlobalDescriptorSets[m_CurrentFrame], m_ClusterCuller->GetDrawDescriptorSet() };
 
 		FrameData const pointLightData{
 			.PipelineLayout = &pointPipelineLayout
@@ -595,98 +935,152 @@ void App::GenerateShadowMaps()
 			, .DescriptorSetLayouts = { m_GlobalDescSetLayout.get(), 1 }
 			, .DescriptorSets = { descSets }
 		};
-		shadow::RecordPointShadowsGeneration(m_Context
-											 , commandBuffer
-											 , *m_Scene
-											 , pointShadowMaps
-											 , pointShadowMapViews
-											 , pointLightData);
-
-		shadow::RecordDirectionalShadowsGeneration(m_Context
-												   , commandBuffer
-												   , *m_Scene
-												   , directionalShadowMaps
-												   , directionalShadowMapViews
-												   , directionalLightData);
+		shadow::TransitionShadowMapsForGeneration(m_Context, commandBuffer, pointShadowMaps, 6);
+		shadow::TransitionShadowMapsForGeneration(m_Context, commandBuffer, directionalShadowMaps, 1);
+
+		// every light culls its views on the host before drawing them, with thousands of meshes that dominates the
+		// recording, so ranges of lights are recorded by the workers. point lights come first and have six views each
+		auto const     recordStart     = std::chrono::steady_clock::now();
+		uint32_t const pointLightCount = m_Scene->GetPointLightCount();
+		float const    lodPixelError   = m_Config.LodPixelError * SHADOW_LOD_BIAS;
+		m_ClusterCuller->UpdateMeshData();
+		m_ParallelRecorder->Record(commandBuffer
+								   , pointLightCount + m_Scene->GetDirectionalLightCount()
+								   , [&](VkCommandBuffer secondary, uint32_t first, uint32_t last)
+								   {
+									   shadow::RecordPointShadowsGeneration(m_Context
+																			, secondary
+																			, *m_Scene
+																			, pointShadowMaps
+																			, pointShadowMapViews
+																			, pointLightData
+																			, *m_ClusterCuller
+																			, m_FramesInFlight + m_Scene->GetDirectionalLightCount()
+																			, lodPixelError
+																			, std::min(first, pointLightCount)
+																			, std::min(last, pointLightCount));
+									   shadow::RecordDirectionalShadowsGeneration(m_Context
+																				  , secondary
+																				  , *m_Scene
+																				  , directionalShadowMaps
+																				  , directionalShadowMapViews
+																				  , directionalLightData
+																				  , *m_ClusterCuller
+																				  , m_FramesInFlight
+																				  , lodPixelError
+																				  , std::max(first, pointLightCount) - pointLightCount
+																				  , std::max(last, pointLightCount) - pointLightCount);
+								   });
+		auto const   recordEnd      = std::chrono::steady_clock::now();
+		double const recordDuration = std::chrono::duration<double>(recordEnd - recordStart).count();
+		m_CPUTimings[25]            = Timing{
+			std::format("Shadow recording ({} threads)", m_ParallelRecorder->GetWorkerCount())
+			, recordDuration
+		};
+		m_ShadowRecordingDurations[m_ParallelRecorder->GetWorkerCount()] = recordDuration;
+
+		shadow::TransitionShadowMapsForSampling(m_Context, commandBuffer, pointShadowMaps, 6);
+		shadow::TransitionShadowMapsForSampling(m_Context, commandBuffer, directionalShadowMaps, 1);
 		m_QueryPool->WriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, label, 0);
 
 		commandBuffer.End(m_Context);
-		commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
-		if (m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX) != VK_SUCCESS)
-			throw std::runtime_error("failed to wait for command buffer fence");
 
-		for (auto& views: pointShadowMapViews)
-			for (auto& view: views)
-				view.Destroy(m_Context);
+		// waits for the scene on the gpu and advances the upload timeline so the temporaries below retire without a cpu wait
+		uint64_t              shadowValue{};
+		VkSemaphoreSubmitInfo waitInfos[]{ m_Uploader->CreateWaitInfo(uploadValue, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT) };
+		VkSemaphoreSubmitInfo signalInfos[]{ m_Uploader->CreateSignalInfo(shadowValue) };
+		commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, waitInfos, signalInfos);
 
-		for (uint32_t index{}; index < directionalShadowMaps.size(); ++index)
+		// the pool tracks the new slots, every frame writes them into its descriptor set before it draws again. a
+		// regeneration swaps the maps into the slots the lights already link
+		auto retiredMaps = std::make_shared<std::vector<std::pair<vkc::Image, vkc::ImageView>>>();
+		auto addToPool   = [this, &retiredMaps](Light& light, vkc::Image&& map, vkc::ImageView&& view)
 		{
-			uint32_t const textureIndex = m_Scene->AddTextureToPool(std::move(directionalShadowMaps[index])
-																	, std::move(directionalShadowMapViews[index]));
-			m_Scene->GetLights()[index].LinkShadowMapIndex(textureIndex);
-		}
+			if (m_ShadowMapsGenerated)
+				retiredMaps->emplace_back(m_Scene->ReplaceTextureInPool(light.GetShadowMapIndex(), std::move(map), std::move(view)));
+			else
+				light.LinkShadowMapIndex(m_Scene->AddTextureToPool(std::move(map), std::move(view)));
+		};
+		for (uint32_t index{}; index < directionalShadowMaps.size(); ++index)
+			addToPool(m_Scene->GetLights()[index], std::move(directionalShadowMaps[index]), std::move(directionalShadowMapViews[index]));
 
 		for (uint32_t index{ m_Scene->GetDirectionalLightCount() }; index < m_Scene->GetLights().size(); ++index)
 		{
 			auto& map  = pointShadowMaps[index - m_Scene->GetDirectionalLightCount()];
 			auto  view = map.CreateView(m_Context, VK_IMAGE_VIEW_TYPE_CUBE, 0, 6);
-
-			uint32_t const textureIndex = m_Scene->AddTextureToPool(std::move(map)
-																	, std::move(view));
-			m_Scene->GetLights()[index].LinkShadowMapIndex(textureIndex);
+			addToPool(m_Scene->GetLights()[index], std::move(map), std::move(view));
 		}
 		directionalShadowMaps.clear();
 		directionalShadowMapViews.clear();
 
-		directionalPipeline.Destroy(m_Context);
-		directionalPipelineLayout.Destroy(m_Context);
-		pointPipeline.Destroy(m_Context);
-		pointPipelineLayout.Destroy(m_Context);
-		// update descriptor texture array with newly created shadow maps
-		{
-			auto const& textures     = m_Scene->GetTextureImages();
-			auto const& textureViews = m_Scene->GetTextureImageViews();
-
-			std::vector<VkDescriptorImageInfo> imageInfos;
-			imageInfos.reserve(textures.size());
+		auto pointViews = std::make_shared<std::vector<std::vector<vkc::ImageView>>>(std::move(pointShadowMapViews));
+		m_Uploader->Retire(shadowValue
+						   , [this, pointViews, retiredMaps]
+						   {
+							   m_ParallelRecorder->Reset();
+							   for (auto& views: *pointViews)
+								   for (auto& view: views)
+									   view.Destroy(m_Context);
+							   for (auto& [map, view]: *retiredMaps)
+							   {
+								   view.Destroy(m_Context);
+								   map.Destroy(m_Context);
+							   }
+						   });
+	}
+	m_ShadowMapsGenerated = true;
+}
 
-			const size_t textureCountWithoutShadowMaps = textures.size() - m_Scene->GetLights().size();
+void App::RegenerateShadowMaps()
+{
+	// the frames in flight sample the old maps, and the recorder's buffers are only reset by the retirement of the
+	// previous generation
+	if (m_Context.DispatchTable.deviceWaitIdle() != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for the device");
+	m_Uploader->Collect();
 
-			for (auto [image, view]{
-					 std::make_pair(textures.begin() + textureCountWithoutShadowMaps, textureViews.begin() + textureCountWithoutShadowMaps)
-				 };
-				 image != textures.end() && view != textureViews.end();
-				 ++image, ++view)
-			{
-				imageInfos.emplace_back(VK_NULL_HANDLE, *view, image->GetLayout());
-			}
+	m_ParallelRecorder->Destroy();
+	m_ParallelRecorder = std::make_unique<ParallelRecorder>(m_Context
+															, m_Context.Device.get_queue_index(vkb::QueueType::graphics).value()
+															, static_cast<uint32_t>(m_Config.RecordingThreadCount));
+	GenerateShadowMaps();
+}
 
-			for (uint32_t index{}; index < m_GlobalDescriptorSets.size(); ++index)
-			{
-				m_GlobalDescriptorSets[index]
-					.AddWriteDescriptor(imageInfos
-										, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
-										, 1
-										, static_cast<uint32_t>(textureCountWithoutShadowMaps))
-					.Update(m_Context);
-			}
-		}
-	}
+void App::RecordLoadTimings()
+{
+	auto const end = std::chrono::steady_clock::now();
 
-	for (auto& ssbo: m_LightMatricesSSBOs)
-		ssbo.UpdateData(m_Scene->GetLightMatrices());
-	for (auto& ssbo: m_LightSSBOs)
-		ssbo.UpdateData(m_Scene->GetLights());
+	Scene::LoadStats const& loadStats = m_Scene->GetLoadStats();
+	m_CPUTimings[21] = Timing{
+		loadStats.LoadedFromCache ? "Scene cold import (at cook time)" : "Scene cold import"
+		, loadStats.ColdImportDuration
+	};
+	m_CPUTimings[22] = Timing{ "Scene cached load", loadStats.CachedLoadDuration };
+	m_CPUTimings[23] = Timing{ "Texture decode + mips (wall)", loadStats.TextureDecodeWallDuration };
+	m_CPUTimings[24] = Timing{ "Texture decode + mips (summed per image)", loadStats.TextureDecodeSummedDuration };
+	m_CPUTimings[32] = Timing{ "Time to fully loaded", std::chrono::duration<double>(end - m_StartTime).count() };
+	std::cout << std::format("First frame after {:.3f} s, fully loaded after {:.3f} s"
+							 , m_CPUTimings[31].GetDuration()
+							 , m_CPUTimings[32].GetDuration()) << std::endl;
+	for (PipelineManager::Statistics const& statistics: m_Pipelines->GetStatistics())
+		std::cout << std::format("Pipeline {} compiled in {:.2f} ms, cache {}"
+								 , statistics.Key
+								 , statistics.CompileMilliseconds
+								 , statistics.CacheHit ? "hit" : "miss") << '\n';
+	std::cout << std::format("Pipeline cache hits {}, misses {}", m_Pipelines->GetCacheHits(), m_Pipelines->GetCacheMisses())
+		<< std::endl;
 }
 
 void App::CreateDescriptorPool()
 {
+	startup_timeline::Scope const scope{ "CreateDescriptorPool" };
 	vkc::DescriptorPoolBuilder builder{ m_Context };
 	vkc::DescriptorPool        pool = builder
 							   .SetFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
 							   .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_FramesInFlight) // mvp
 							   .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_FramesInFlight) // light data
 							   .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_FramesInFlight) // light data
+							   .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_FramesInFlight) // texture feedback
 							   .AddPoolSize(VK_DESCRIPTOR_TYPE_SAMPLER, m_FramesInFlight)        // sampler
 							   .AddPoolSize(VK_DESCRIPTOR_TYPE_SAMPLER, m_FramesInFlight)        // shadow sampler
 							   .AddPoolSize(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, m_FramesInFlight)  // textures
@@ -741,6 +1135,7 @@ void App::UpdateGbufferDescriptor()
 
 void App::CreateDescriptorSets()
 {
+	startup_timeline::Scope const scope{ "CreateDescriptorSets" };
 	//
 	{
 		std::vector<VkDescriptorSetLayout> layouts(m_FramesInFlight, *m_FrameDescSetLayout);
@@ -776,10 +1171,16 @@ void App::CreateDescriptorSets()
 			shadowSamplerInfo.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 			shadowSamplerInfo.imageView   = VK_NULL_HANDLE;
 
+			VkDescriptorBufferInfo feedbackInfo{};
+			feedbackInfo.buffer = m_Scene->GetTextureStreamer().GetFeedbackBuffer(index);
+			feedbackInfo.range  = VK_WHOLE_SIZE;
+			feedbackInfo.offset = 0;
+
 			m_FrameDescriptorSets[index]
 				.AddWriteDescriptor({ &bufferInfo, 1 }, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, 0)
 				.AddWriteDescriptor({ &lightInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, 0)
 				.AddWriteDescriptor({ &shadowSamplerInfo, 1 }, VK_DESCRIPTOR_TYPE_SAMPLER, 3, 0)
+				.AddWriteDescriptor({ &feedbackInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4, 0)
 				.Update(m_Context);
 		}
 	}
@@ -800,7 +1201,7 @@ void App::CreateDescriptorSets()
 		VkDescriptorImageInfo samplerInfo[]
 		{
 			{
-				.sampler = m_TextureSampler
+				.sampler = m_Config.UseTextureMips ? m_TextureSampler : m_NoMipTextureSampler
 				, .imageView = VK_NULL_HANDLE
 				, .imageLayout = VK_IMAGE_LAYOUT_UNDEFINED
 			}
@@ -828,6 +1229,7 @@ void App::CreateDescriptorSets()
 								 .AddVariableDescriptorCount(counts)
 								 .Build(*m_DescPool, layouts);
 
+		m_BoundTextureSamplers.assign(m_FramesInFlight, samplerInfo[0].sampler);
 		for (auto& descriptor: m_GlobalDescriptorSets)
 			descriptor
 				.AddWriteDescriptor(samplerInfo, VK_DESCRIPTOR_TYPE_SAMPLER, 0, 0)
@@ -839,15 +1241,58 @@ void App::CreateDescriptorSets()
 	}
 }
 
+void App::UpdateTextureSamplerDescriptor()
+{
+	VkSampler const sampler = m_Config.UseTextureMips ? m_TextureSampler : m_NoMipTextureSampler;
+	if (m_BoundTextureSamplers[m_CurrentFrame] == sampler)
+		return;
+
+	// only called once the frame's fence is signaled, so the set is no longer in use
+	VkDescriptorImageInfo samplerInfo[]
+	{
+		{
+			.sampler = sampler
+			, .imageView = VK_NULL_HANDLE
+			, .imageLayout = VK_IMAGE_LAYOUT_UNDEFINED
+		}
+	};
+	m_GlobalDescriptorSets[m_CurrentFrame]
+		.AddWriteDescriptor(samplerInfo, VK_DESCRIPTOR_TYPE_SAMPLER, 0, 0)
+		.Update(m_Context);
+	m_BoundTextureSamplers[m_CurrentFrame] = sampler;
+}
+
+void App::UpdateTextureDescriptors()
+{
+	std::vector<uint32_t> const changed = m_Scene->TakeChangedTextures(m_CurrentFrame);
+	if (changed.empty())
+		return;
+
+	// only called once the frame's fence is signaled, so the set is no longer in use
+	std::span const                    textures     = m_Scene->GetTextureImages();
+	std::span const                    textureViews = m_Scene->GetTextureImageViews();
+	std::vector<VkDescriptorImageInfo> imageInfos;
+	imageInfos.reserve(changed.size());
+	for (uint32_t const texture: changed)
+		imageInfos.emplace_back(VK_NULL_HANDLE, textureViews[texture], textures[texture].GetLayout());
+
+	for (size_t index{}; index < changed.size(); ++index)
+		m_GlobalDescriptorSets[m_CurrentFrame]
+			.AddWriteDescriptor({ &imageInfos[index], 1 }, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1, changed[index]);
+	m_GlobalDescriptorSets[m_CurrentFrame].Update(m_Context);
+}
+
 void App::CreateGraphicsPipeline()
 {
+	startup_timeline::Scope const scope{ "CreateGraphicsPipeline" };
 	// depth prepass layout
 	{
 		vkc::PipelineLayoutBuilder builder{ m_Context };
 		vkc::PipelineLayout        layout = builder
 									 .AddDescriptorSetLayout(*m_GlobalDescSetLayout)
 									 .AddDescriptorSetLayout(*m_FrameDescSetLayout)
-									 .AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(TextureIndices::Diffuse))
+									 .AddDescriptorSetLayout(m_ClusterCuller->GetDrawDescriptorSetLayout())
+									 .AddPushConstant(VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(uint32_t))
 									 .Build();
 		m_DepthPrepPipelineLayout = std::make_unique<vkc::PipelineLayout>(std::move(layout));
 	}
@@ -857,7 +1302,8 @@ void App::CreateGraphicsPipeline()
 		vkc::PipelineLayout        layout = builder
 									 .AddDescriptorSetLayout(*m_GlobalDescSetLayout)
 									 .AddDescriptorSetLayout(*m_FrameDescSetLayout)
-									 .AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(TextureIndices))
+									 .AddDescriptorSetLayout(m_ClusterCuller->GetDrawDescriptorSetLayout())
+									 .AddPushConstant(VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(uint32_t))
 									 .Build();
 		m_GBufferGenPipelineLayout = std::make_unique<vkc::PipelineLayout>(std::move(layout));
 	}
@@ -868,6 +1314,7 @@ void App::CreateGraphicsPipeline()
 									 .AddDescriptorSetLayout(*m_GlobalDescSetLayout)
 									 .AddDescriptorSetLayout(*m_FrameDescSetLayout)
 									 .AddDescriptorSetLayout(*m_GbufferDescSetLayout)
+									 .AddDescriptorSetLayout(m_LightClusterer->GetLightingDescriptorSetLayout())
 									 .Build();
 		m_LightingPipelineLayout = std::make_unique<vkc::PipelineLayout>(std::move(layout));
 		VkDebugUtilsObjectNameInfoEXT debugNameInfo{};
@@ -896,133 +1343,273 @@ void App::CreateGraphicsPipeline()
 			throw std::runtime_error("failed to set debug object name");
 	}
 
-	VkPipelineColorBlendAttachmentState blendAttachment{};
-	blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT
-									 | VK_COLOR_COMPONENT_G_BIT
-									 | VK_COLOR_COMPONENT_B_BIT
-									 | VK_COLOR_COMPONENT_A_BIT;
-
-	// depth prepass pipeline
-	{
-		vkc::ShaderStage const vert{ m_Context, help::ReadFile("shaders/basic_transform.spv"), VK_SHADER_STAGE_VERTEX_BIT };
-		vkc::ShaderStage       alphaDiscard{ m_Context, help::ReadFile("shaders/alpha_discard.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
-
-		vkc::PipelineBuilder builder{ m_Context };
-		vkc::Pipeline        pipeline = builder
-								 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-								 .AddViewport(m_Context.Swapchain.extent)
-								 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-								 .SetCullMode(VK_CULL_MODE_BACK_BIT)
-								 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-								 .SetVertexDescription(Vertex::GetBindingDescription(), Vertex::GetAttributeDescription())
-								 .UseCache(*m_PipelineCache)
-								 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-								 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-								 .SetRenderingAttachments({}, m_DepthFormat, VK_FORMAT_UNDEFINED)
-								 .EnableDepthTest(VK_COMPARE_OP_LESS)
-								 .EnableDepthWrite()
-								 .AddShaderStage(vert)
-								 .AddShaderStage(alphaDiscard)
-								 .Build(*m_DepthPrepPipelineLayout, true);
-		m_DepthPrepPipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
-	}
-	// gbuffer gen pipeline
-	{
-		vkc::ShaderStage const vert{ m_Context, help::ReadFile("shaders/transform_w_normals.spv"), VK_SHADER_STAGE_VERTEX_BIT };
-		vkc::ShaderStage       frag{ m_Context, help::ReadFile("shaders/gbuffer_generation.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
-
-		VkFormat colorAttachmentFormats[]{ m_AlbedoImage->GetFormat(), m_MaterialImage->GetFormat() };
-
-		vkc::PipelineBuilder builder{ m_Context };
-		vkc::Pipeline        pipeline = builder
-								 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-								 .AddViewport(m_Context.Swapchain.extent)
-								 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-								 .SetCullMode(VK_CULL_MODE_BACK_BIT)
-								 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-								 .SetVertexDescription(Vertex::GetBindingDescription(), Vertex::GetAttributeDescription())
-								 .UseCache(*m_PipelineCache)
-								 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-								 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-								 .AddColorBlendAttachment(blendAttachment)
-								 .AddColorBlendAttachment(blendAttachment)
-								 .SetRenderingAttachments(colorAttachmentFormats, m_DepthFormat, VK_FORMAT_UNDEFINED)
-								 .EnableDepthTest(VK_COMPARE_OP_EQUAL)
-								 .AddShaderStage(vert)
-								 .AddShaderStage(frag)
-								 .Build(*m_GBufferGenPipelineLayout, true);
-		m_GBufferGenPipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
-	}
-	// lighting pipeline
-	{
-		vkc::ShaderStage quad{ m_Context, help::ReadFile("shaders/quad.spv"), VK_SHADER_STAGE_VERTEX_BIT };
-		vkc::ShaderStage lighting{ m_Context, help::ReadFile("shaders/lighting.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
-		lighting.AddSpecializationConstant(static_cast<uint32_t>(m_Scene->GetLights().size()));
-		VkBool32 const hasDirectionalLights = m_Scene->GetDirectionalLightCount() > 0 ? VK_TRUE : VK_FALSE;
-		VkBool32 const hasPointLights       = m_Scene->GetPointLightCount() > 0 ? VK_TRUE : VK_FALSE;
-		lighting.AddSpecializationConstant(std::max(m_Scene->GetDirectionalLightCount(), 1u));
-		lighting.AddSpecializationConstant(m_Scene->GetPointLightCount());
-		lighting.AddSpecializationConstant(hasDirectionalLights & m_Config.EnableDirectionalLights);
-		lighting.AddSpecializationConstant(hasPointLights & m_Config.EnablePointLights);
-		lighting.AddSpecializationConstant(SHADOW_FAR_PLANE);
-
-		VkFormat colorAttachmentFormats[]{ m_HDRIRenderTarget->GetFormat() };
-
-		vkc::PipelineBuilder builder{ m_Context };
-		vkc::Pipeline        pipeline = builder
-								 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-								 .AddViewport(m_Context.Swapchain.extent)
-								 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-								 .SetCullMode(VK_CULL_MODE_NONE)
-								 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-								 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-								 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-								 .AddColorBlendAttachment(blendAttachment)
-								 .SetRenderingAttachments(colorAttachmentFormats, m_DepthFormat, VK_FORMAT_UNDEFINED)
-								 .UseCache(*m_PipelineCache)
-								 .AddShaderStage(quad)
-								 .AddShaderStage(lighting)
-								 .Build(*m_LightingPipelineLayout, true);
-		m_LightingPipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
-	}
-	// blit pipeline
-	{
-		vkc::ShaderStage quad{ m_Context, help::ReadFile("shaders/quad.spv"), VK_SHADER_STAGE_VERTEX_BIT };
-		vkc::ShaderStage blit{ m_Context, help::ReadFile("shaders/blit.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
-
-		VkFormat colorAttachmentFormats[]{ m_Context.Swapchain.image_format };
-
-		vkc::PipelineBuilder builder{ m_Context };
-		vkc::Pipeline        pipeline = builder
-								 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-								 .AddViewport(m_Context.Swapchain.extent)
-								 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-								 .SetCullMode(VK_CULL_MODE_NONE)
-								 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-								 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-								 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-								 .AddColorBlendAttachment(blendAttachment)
-								 .SetRenderingAttachments(colorAttachmentFormats, m_DepthFormat, VK_FORMAT_UNDEFINED)
-								 .UseCache(*m_PipelineCache)
-								 .AddShaderStage(quad)
-								 .AddShaderStage(blit)
-								 .Build(*m_BlitPipelineLayout, true);
-		m_BlitPipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
-	}
+	m_Pipelines = std::make_unique<PipelineManager>(m_Context, *m_PipelineCache, m_FramesInFlight);
+	PipelineInputs const inputs = GetPipelineInputs();
+	m_Pipelines->Request(DEPTH_PREPASS_PIPELINE
+						 , { "basic_transform.vert", "alpha_discard.frag" }
+						 , [this, inputs](vkc::PipelineCache& cache) { return BuildDepthPrepPipeline(cache, inputs); });
+	m_Pipelines->Request(GBUFFER_PIPELINE
+						 , { "transform_w_normals.vert", "gbuffer_generation.frag" }
+						 , [this, inputs](vkc::PipelineCache& cache) { return BuildGBufferGenPipeline(cache, inputs); });
+	m_Pipelines->Request(BLIT_PIPELINE
+						 , { "quad.vert", "blit.frag" }
+						 , [this, inputs](vkc::PipelineCache& cache) { return BuildBlitPipeline(cache, inputs); });
+	// the variant for the startup config is what later toggles fall back to while their variant compiles
+	m_LightingFallback = GetLightingPipelineKey();
+	RequestLightingPipeline();
+	// shadow pipelines are only used once the geometry is loaded, they compile alongside the others and are joined there
+	m_DirectionalShadowPipeline = m_Pipelines->Compile([this, inputs](vkc::PipelineCache& cache)
+	{
+		return shadow::CreatePipelineForDirectionalShadows(m_Context
+														   , *m_GlobalDescSetLayout
+														   , m_ClusterCuller->GetDrawDescriptorSetLayout()
+														   , inputs.DepthFormat
+														   , SHADOW_MAP_RESOLUTION
+														   , inputs.BoundsMin
+														   , inputs.BoundsMax
+														   , &cache);
+	});
+	m_PointShadowPipeline = m_Pipelines->Compile([this, inputs](vkc::PipelineCache& cache)
+	{
+		return shadow::CreatePipelineForPointShadows(m_Context
+													 , *m_GlobalDescSetLayout
+													 , m_ClusterCuller->GetDrawDescriptorSetLayout()
+													 , inputs.DepthFormat
+													 , SHADOW_MAP_RESOLUTION
+													 , inputs.BoundsMin
+													 , inputs.BoundsMax
+													 , &cache);
+	});
+	// nothing can be drawn before these
+	m_Pipelines->Wait();
+
+	m_ShaderReloader = std::make_unique<ShaderReloader>(*m_Pipelines);
+	m_Context.DeletionQueue.Push([this]
+	{
+		m_ShaderReloader->Destroy();
+		// closed before the shadow maps were generated
+		for (auto* shadowPipeline: { &m_DirectionalShadowPipeline, &m_PointShadowPipeline })
+			if (shadowPipeline->valid())
+			{
+				auto [layout, pipeline] = shadowPipeline->get();
+				pipeline.Destroy(m_Context);
+				layout.Destroy(m_Context);
+			}
+		for (auto* shadowPass: { &m_DirectionalShadowPass, &m_PointShadowPass })
+			if (shadowPass->has_value())
+			{
+				auto& [layout, pipeline] = **shadowPass;
+				pipeline.Destroy(m_Context);
+				layout.Destroy(m_Context);
+			}
+		m_Pipelines->Destroy();
+	});
+}
+
+std::string App::GetLightingPipelineKey() const
+{
+	return std::format("lighting (directional {}, point {})"
+					   , m_Config.EnableDirectionalLights ? "on" : "off"
+					   , m_Config.EnablePointLights ? "on" : "off");
+}
+
+void App::RequestLightingPipeline()
+{
+	VkBool32 const directional = m_Config.EnableDirectionalLights;
+	VkBool32 const point       = m_Config.EnablePointLights;
+	m_Pipelines->Request(GetLightingPipelineKey()
+						 , { "quad.vert", "lighting.frag" }
+						 , [this, inputs = GetPipelineInputs(), directional, point](vkc::PipelineCache& cache)
+						 {
+							 return BuildLightingPipeline(cache, inputs, directional, point);
+						 }
+						 , m_LightingFallback);
+}
+
+App::PipelineInputs App::GetPipelineInputs() const
+{
+	return {
+		.Extent = m_Context.Swapchain.extent
+		, .SwapchainFormat = m_Context.Swapchain.image_format
+		, .DepthFormat = m_DepthFormat
+		, .AlbedoFormat = m_AlbedoImage->GetFormat()
+		, .MaterialFormat = m_MaterialImage->GetFormat()
+		, .HDRIFormat = m_HDRIRenderTarget->GetFormat()
+		, .BoundsMin = m_Scene->GetBoundsMin()
+		, .BoundsMax = m_Scene->GetBoundsMax()
+		, .DirectionalLightCount = m_Scene->GetDirectionalLightCount()
+		, .PointLightCount = m_Scene->GetPointLightCount()
+	};
+}
+
+vkc::Pipeline App::BuildDepthPrepPipeline(vkc::PipelineCache& cache, PipelineInputs const& inputs)
+{
+	vkc::ShaderStage vert{ m_Context, help::ReadFile("shaders/basic_transform.spv"), VK_SHADER_STAGE_VERTEX_BIT };
+	vkc::ShaderStage alphaDiscard{ m_Context, help::ReadFile("shaders/alpha_discard.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
+	vertex_packing::AddDequantizationConstants(vert, inputs.BoundsMin, inputs.BoundsMax);
+
+	vkc::PipelineBuilder builder{ m_Context };
+	vkc::Pipeline        pipeline = builder
+							 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+							 .AddViewport(inputs.Extent)
+							 .SetPolygonMode(VK_POLYGON_MODE_FILL)
+							 .SetCullMode(VK_CULL_MODE_BACK_BIT)
+							 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+							 .SetVertexDescription(PackedVertex::GetBindingDescription(), PackedVertex::GetAttributeDescription())
+							 .UseCache(cache)
+							 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+							 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+							 .SetRenderingAttachments({}, inputs.DepthFormat, VK_FORMAT_UNDEFINED)
+							 .EnableDepthTest(VK_COMPARE_OP_LESS)
+							 .EnableDepthWrite()
+							 .AddShaderStage(vert)
+							 .AddShaderStage(alphaDiscard)
+							 .Build(*m_DepthPrepPipelineLayout, false);
+	return pipeline;
+}
+
+vkc::Pipeline App::BuildGBufferGenPipeline(vkc::PipelineCache& cache, PipelineInputs const& inputs)
+{
+	vkc::ShaderStage vert{ m_Context, help::ReadFile("shaders/transform_w_normals.spv"), VK_SHADER_STAGE_VERTEX_BIT };
+	vkc::ShaderStage frag{ m_Context, help::ReadFile("shaders/gbuffer_generation.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
+	vertex_packing::AddDequantizationConstants(vert, inputs.BoundsMin, inputs.BoundsMax);
+
+	VkFormat colorAttachmentFormats[]{ inputs.AlbedoFormat, inputs.MaterialFormat };
+
+	VkPipelineColorBlendAttachmentState const blendAttachment = OpaqueBlendAttachment();
+
+	vkc::PipelineBuilder builder{ m_Context };
+	vkc::Pipeline        pipeline = builder
+							 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+							 .AddViewport(inputs.Extent)
+							 .SetPolygonMode(VK_POLYGON_MODE_FILL)
+							 .SetCullMode(VK_CULL_MODE_BACK_BIT)
+							 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+							 .SetVertexDescription(PackedVertex::GetBindingDescription(), PackedVertex::GetAttributeDescription())
+							 .UseCache(cache)
+							 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+							 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+							 .AddColorBlendAttachment(blendAttachment)
+							 .AddColorBlendAttachment(blendAttachment)
+							 .SetRenderingAttachments(colorAttachmentFormats, inputs.DepthFormat, VK_FORMAT_UNDEFINED)
+							 .EnableDepthTest(VK_COMPARE_OP_EQUAL)
+							 .AddShaderStage(vert)
+							 .AddShaderStage(frag)
+							 .Build(*m_GBufferGenPipelineLayout, false);
+	return pipeline;
+}
+
+vkc::Pipeline App::BuildLightingPipeline
+(
+	vkc::PipelineCache&     cache
+	, PipelineInputs const& inputs
+	, VkBool32              directionalLights
+	, VkBool32              pointLights
+)
+{
+	vkc::ShaderStage quad{ m_Context, help::ReadFile("shaders/quad.spv"), VK_SHADER_STAGE_VERTEX_BIT };
+	vkc::ShaderStage lighting{ m_Context, help::ReadFile("shaders/lighting.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
+	lighting.AddSpecializationConstant(inputs.DirectionalLightCount + inputs.PointLightCount);
+	VkBool32 const hasDirectionalLights = inputs.DirectionalLightCount > 0 ? VK_TRUE : VK_FALSE;
+	VkBool32 const hasPointLights       = inputs.PointLightCount > 0 ? VK_TRUE : VK_FALSE;
+	lighting.AddSpecializationConstant(std::max(inputs.DirectionalLightCount, 1u));
+	lighting.AddSpecializationConstant(inputs.PointLightCount);
+	lighting.AddSpecializationConstant(hasDirectionalLights & directionalLights);
+	lighting.AddSpecializationConstant(hasPointLights & pointLights);
+	lighting.AddSpecializationConstant(SHADOW_FAR_PLANE);
+	lighting.AddSpecializationConstant(LightClusterer::GRID_X);
+	lighting.AddSpecializationConstant(LightClusterer::GRID_Y);
+	lighting.AddSpecializationConstant(LightClusterer::GRID_Z);
+	lighting.AddSpecializationConstant(LightClusterer::MAX_LIGHTS_PER_CLUSTER);
+
+	VkFormat colorAttachmentFormats[]{ inputs.HDRIFormat };
+
+	VkPipelineColorBlendAttachmentState const blendAttachment = OpaqueBlendAttachment();
+
+	vkc::PipelineBuilder builder{ m_Context };
+	vkc::Pipeline        pipeline = builder
+							 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+							 .AddViewport(inputs.Extent)
+							 .SetPolygonMode(VK_POLYGON_MODE_FILL)
+							 .SetCullMode(VK_CULL_MODE_NONE)
+							 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+							 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+							 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+							 .AddColorBlendAttachment(blendAttachment)
+							 .SetRenderingAttachments(colorAttachmentFormats, inputs.DepthFormat, VK_FORMAT_UNDEFINED)
+							 .UseCache(cache)
+							 .AddShaderStage(quad)
+							 .AddShaderStage(lighting)
+							 .Build(*m_LightingPipelineLayout, false);
+	return pipeline;
+}
+
+vkc::Pipeline App::BuildBlitPipeline(vkc::PipelineCache& cache, PipelineInputs const& inputs)
+{
+	vkc::ShaderStage quad{ m_Context, help::ReadFile("shaders/quad.spv"), VK_SHADER_STAGE_VERTEX_BIT };
+	vkc::ShaderStage blit{ m_Context, help::ReadFile("shaders/blit.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
+
+	VkFormat colorAttachmentFormats[]{ inputs.SwapchainFormat };
+
+	VkPipelineColorBlendAttachmentState const blendAttachment = OpaqueBlendAttachment();
+
+	vkc::PipelineBuilder builder{ m_Context };
+	vkc::Pipeline        pipeline = builder
+							 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+							 .AddViewport(inputs.Extent)
+							 .SetPolygonMode(VK_POLYGON_MODE_FILL)
+							 .SetCullMode(VK_CULL_MODE_NONE)
+							 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+							 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+							 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+							 .AddColorBlendAttachment(blendAttachment)
+							 .SetRenderingAttachments(colorAttachmentFormats, inputs.DepthFormat, VK_FORMAT_UNDEFINED)
+							 .UseCache(cache)
+							 .AddShaderStage(quad)
+							 .AddShaderStage(blit)
+							 .Build(*m_BlitPipelineLayout, false);
+	return pipeline;
 }
 
 void App::CreateCmdPool()
 {
+	startup_timeline::Scope const scope{ "CreateCmdPool" };
 	m_CommandPool = std::make_unique<vkc::CommandPool>(m_Context
 													   , m_Context.Device.get_queue_index(vkb::QueueType::graphics).value()
 													   , m_FramesInFlight
 													   , VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+	// init work is not waited on, so it must not share buffers the frames cycle through
+	m_InitCommandPool = std::make_unique<vkc::CommandPool>(m_Context
+														   , m_Context.Device.get_queue_index(vkb::QueueType::graphics).value()
+														   , 1
+														   , VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+	m_ParallelRecorder = std::make_unique<ParallelRecorder>(m_Context
+															, m_Context.Device.get_queue_index(vkb::QueueType::graphics).value()
+															, static_cast<uint32_t>(m_Config.RecordingThreadCount));
+	m_Context.DeletionQueue.Push([this]
+	{
+		m_ParallelRecorder->Destroy();
+	});
+
+	m_Uploader = std::make_unique<Uploader>(m_Context);
+	m_Context.DeletionQueue.Push([this]
+	{
+		m_Uploader->Destroy();
+	});
 }
 
 void App::CreateScene()
 {
-	m_Scene = std::make_unique<Scene>(m_Context, *m_CommandPool);
-	m_Scene->Load("data/glTF/Sponza.gltf");
+	startup_timeline::Scope const scope{ "CreateScene" };
+	m_Scene = std::make_unique<Scene>(m_Context, *m_Uploader, m_FramesInFlight);
+	if constexpr (PROGRESSIVE_LOADING)
+		m_Scene->Open("data/glTF/Sponza.gltf");
+	else
+		m_Scene->Load("data/glTF/Sponza.gltf");
+	m_Context.DeletionQueue.Push([this]
+	{
+		m_Scene->GetTextureStreamer().Destroy();
+	});
 	m_Scene->AddLight(-glm::normalize(glm::vec3{ 0.3f, -0.4f, -0.f }), false, { .877f, .877f, .577f }, 100.f);
 	// m_Scene->AddLight(-glm::normalize(glm::vec3{ .999f, -.577f, .0f }), false, { .877f, .877f, .3f }, 50.f);
 	// m_Scene->AddLight({ -2.f, 1.f, .0f }, true, { 1.f, .0f, .0f }, 125.f);
@@ -1033,6 +1620,7 @@ void App::CreateScene()
 
 void App::CreateResources()
 {
+	startup_timeline::Scope const scope{ "CreateResources" };
 	// mvp ubo
 	{
 		vkc::BufferBuilder builder{ m_Context };
@@ -1041,6 +1629,33 @@ void App::CreateResources()
 		for (uint32_t index{}; index < m_FramesInFlight; ++index)
 			m_MVPUBOs.emplace_back(builder.Build(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(ModelViewProj)));
 	}
+	// unshadowed point lights scattered over the scene with a fixed seed, so every run shades the same ones
+	{
+		std::vector<VkBuffer> cameraBuffers;
+		for (vkc::Buffer const& buffer: m_MVPUBOs)
+			cameraBuffers.emplace_back(buffer);
+		m_LightClusterer = std::make_unique<LightClusterer>(m_Context, cameraBuffers, *m_PipelineCache);
+		m_Context.DeletionQueue.Push([this]
+		{
+			m_LightClusterer->Destroy();
+		});
+
+		glm::vec3 const                       boundsMin = m_Scene->GetBoundsMin();
+		glm::vec3 const                       boundsMax = m_Scene->GetBoundsMax();
+		float const                           extent    = glm::length(boundsMax - boundsMin);
+		std::mt19937                          generator{ 1337 };
+		std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+		std::uniform_real_distribution<float> radius{ .02f * extent, .06f * extent };
+		std::uniform_real_distribution<float> colour{ .2f, 1.f };
+		std::uniform_real_distribution<float> lumen{ 50.f, 150.f };
+		m_ClusteredLights.reserve(LightClusterer::MAX_LIGHT_COUNT);
+		for (uint32_t index{}; index < LightClusterer::MAX_LIGHT_COUNT; ++index)
+		{
+			glm::vec3 const position = glm::mix(boundsMin, boundsMax, glm::vec3{ unit(generator), unit(generator), unit(generator) });
+			m_ClusteredLights.emplace_back(glm::vec4{ position, radius(generator) }
+										   , glm::vec4{ colour(generator), colour(generator), colour(generator), lumen(generator) });
+		}
+	}
 	// lights ssbo
 	{
 		vkc::BufferBuilder builder{ m_Context };
@@ -1072,13 +1687,41 @@ void App::CreateResources()
 								 , "Light SSBO");
 			}
 	}
+	// one culling view per frame in flight for the camera, then one per directional light and per point light face.
+	// only the camera views are occlusion culled
+	{
+		uint32_t const viewCount = m_FramesInFlight + m_Scene->GetDirectionalLightCount() + 6 * m_Scene->GetPointLightCount();
+		m_ClusterCuller          = std::make_unique<ClusterCuller>(m_Context, *m_Scene, viewCount, m_FramesInFlight, *m_PipelineCache);
+		m_Context.DeletionQueue.Push([this]
+		{
+			m_ClusterCuller->Destroy();
+		});
+	}
+	// precise occlusion queries count every sample passing the depth test instead of only whether any did
+	{
+		VkQueryPoolCreateInfo createInfo{};
+		createInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		createInfo.queryType  = VK_QUERY_TYPE_OCCLUSION;
+		createInfo.queryCount = m_FramesInFlight;
+		if (m_Context.DispatchTable.createQueryPool(&createInfo, nullptr, &m_OverdrawQueryPool) != VK_SUCCESS)
+			throw std::runtime_error("failed to create overdraw query pool");
+		m_OverdrawQueried.resize(m_FramesInFlight);
+		m_Context.DeletionQueue.Push([this]
+		{
+			m_Context.DispatchTable.destroyQueryPool(m_OverdrawQueryPool, nullptr);
+		});
+	}
 	CreateDepth();
+	m_DepthPyramid = std::make_unique<DepthPyramid>(m_Context, *m_PipelineCache);
+	m_DepthPyramid->Resize(*m_DepthImage, *m_DepthImageView);
+	m_ClusterCuller->SetDepthPyramid(*m_DepthPyramid);
 	CreateGBuffer();
 	m_HDRIRenderTarget = std::make_unique<HDRIRenderTarget>(m_Context);
 	m_Context.DeletionQueue.Push([this]
 	{
 		m_DepthImage->Destroy(m_Context);
 		m_DepthImageView->Destroy(m_Context);
+		m_DepthPyramid->Destroy();
 		m_AlbedoImage->Destroy(m_Context);
 		m_AlbedoView->Destroy(m_Context);
 		m_MaterialImage->Destroy(m_Context);
@@ -1150,6 +1793,8 @@ void App::RecreateSwapchain()
 
 	CreateSwapchain();
 	CreateDepth();
+	m_DepthPyramid->Resize(*m_DepthImage, *m_DepthImageView);
+	m_ClusterCuller->SetDepthPyramid(*m_DepthPyramid);
 	CreateGBuffer();
 	m_HDRIRenderTarget = std::make_unique<HDRIRenderTarget>(m_Context);
 	m_Camera->SetNewAspectRatio(static_cast<float>(m_Context.Swapchain.extent.width)
@@ -1161,20 +1806,85 @@ void App::RecreateSwapchain()
 void App::RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageIndex)
 {
 	using namespace std::placeholders;
+	// passes sampling scene textures are recorded under separate entries per sampler so both results stay visible
+	bool const useMips          = m_Config.UseTextureMips;
+	bool const occlusionCulling = m_Config.OcclusionCulling;
+
+	ClusterCuller::ViewParameters const cameraView
+	{
+		m_Camera->GetProjection() * m_Camera->CalculateViewMatrix()
+		, glm::vec4{ m_Camera->GetPosition(), 1.f }
+		, static_cast<float>(m_Context.Swapchain.extent.height)
+		, m_Config.LodPixelError
+		, m_Config.CameraDrawOrder
+	};
+	// with occlusion culling the prepass draws last frame's visible clusters first, the clusters the pyramid of their
+	// depth cannot reject are drawn by a second prepass and the gbuffer pass draws both
 	m_QueryPool->RecordWholePipe(commandBuffer
-								 , "Depth prepass"
-								 , 0
-								 , [this, &commandBuffer, imageIndex]
+								 , "Cluster culling"
+								 , 4
+								 , [this, &commandBuffer, &cameraView, occlusionCulling]
 								 {
-									 DoDepthPrepass(commandBuffer, imageIndex);
+									 m_ClusterCuller->UpdateMeshData();
+									 if (occlusionCulling)
+										 m_ClusterCuller->CullEarly(commandBuffer, m_CurrentFrame, cameraView);
+									 else
+										 m_ClusterCuller->Cull(commandBuffer, m_CurrentFrame, cameraView);
 								 });
+	m_CPUTimings[42] = Timing{ "Draw sorting (camera view)", m_ClusterCuller->GetSortDuration(m_CurrentFrame) };
+
+	// counts the samples both prepasses write
+	m_Context.DispatchTable.cmdResetQueryPool(commandBuffer, m_OverdrawQueryPool, m_CurrentFrame, 1);
+	m_Context.DispatchTable.cmdBeginQuery(commandBuffer, m_OverdrawQueryPool, m_CurrentFrame, VK_QUERY_CONTROL_PRECISE_BIT);
 	m_QueryPool->RecordWholePipe(commandBuffer
-								 , "GBuffer generation"
-								 , 1
+								 , useMips ? "Depth prepass" : "Depth prepass (no mips)"
+								 , useMips ? 0 : 10
+								 , [this, &commandBuffer]
+								 {
+									 DoDepthPrepass(commandBuffer, m_CurrentFrame, VK_ATTACHMENT_LOAD_OP_CLEAR);
+								 });
+	if (occlusionCulling)
+	{
+		m_QueryPool->RecordWholePipe(commandBuffer
+									 , "Depth pyramid"
+									 , 5
+									 , [this, &commandBuffer]
+									 {
+										 m_DepthPyramid->Build(commandBuffer, *m_DepthImage);
+									 });
+		m_QueryPool->RecordWholePipe(commandBuffer
+									 , "Occlusion culling"
+									 , 6
+									 , [this, &commandBuffer, &cameraView]
+									 {
+										 m_ClusterCuller->CullLate(commandBuffer, m_CurrentFrame, cameraView);
+									 });
+		m_QueryPool->RecordWholePipe(commandBuffer
+									 , useMips ? "Late depth prepass" : "Late depth prepass (no mips)"
+									 , useMips ? 7 : 12
+									 , [this, &commandBuffer]
+									 {
+										 DoDepthPrepass(commandBuffer
+														, m_ClusterCuller->GetLateView(m_CurrentFrame)
+														, VK_ATTACHMENT_LOAD_OP_LOAD);
+									 });
+	}
+	m_Context.DispatchTable.cmdEndQuery(commandBuffer, m_OverdrawQueryPool, m_CurrentFrame);
+	m_OverdrawQueried[m_CurrentFrame] = true;
+	m_QueryPool->RecordWholePipe(commandBuffer
+								 , useMips ? "GBuffer generation" : "GBuffer generation (no mips)"
+								 , useMips ? 1 : 11
 								 , [this, &commandBuffer, imageIndex]
 								 {
 									 DoGBufferPass(commandBuffer, imageIndex);
 								 });
+	m_QueryPool->RecordWholePipe(commandBuffer
+								 , "Light clustering"
+								 , 8
+								 , [this, &commandBuffer]
+								 {
+									 m_LightClusterer->Build(commandBuffer, m_CurrentFrame);
+								 });
 	m_QueryPool->RecordWholePipe(commandBuffer
 								 , "Lighting pass"
 								 , 2
@@ -1191,18 +1901,24 @@ void App::RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageInd
 								 });
 }
 
-void App::Submit(vkc::CommandBuffer& commandBuffer) const
+void App::Submit(vkc::CommandBuffer& commandBuffer, uint64_t uploadValue) const
 {
 	VkSemaphoreSubmitInfo waitSemaphoreSubmitInfo{};
 	waitSemaphoreSubmitInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
 	waitSemaphoreSubmitInfo.semaphore = m_ImageAvailableSemaphores[m_CurrentFrame];
 	waitSemaphoreSubmitInfo.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
 
+	// already signaled once the scene is resident, until then the frame waits on the gpu instead of the cpu
+	VkSemaphoreSubmitInfo const uploadWaitSubmitInfo = m_Uploader->CreateWaitInfo(uploadValue
+																				  , VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT |
+																				  VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT |
+																				  VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+
 	VkSemaphoreSubmitInfo signalSemaphoreSubmitInfo{};
 	signalSemaphoreSubmitInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
 	signalSemaphoreSubmitInfo.semaphore = m_RenderFinishedSemaphores[m_CurrentFrame];
 
-	VkSemaphoreSubmitInfo waitSemaphoreInfos[]{ waitSemaphoreSubmitInfo };
+	VkSemaphoreSubmitInfo waitSemaphoreInfos[]{ waitSemaphoreSubmitInfo, uploadWaitSubmitInfo };
 	VkSemaphoreSubmitInfo signalSemaphoreInfos[]{ signalSemaphoreSubmitInfo };
 
 	commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, waitSemaphoreInfos, signalSemaphoreInfos, m_InFlightFences[m_CurrentFrame]);
@@ -1227,6 +1943,8 @@ void App::Present(uint32_t imageIndex)
 
 void App::End()
 {
+	// the workers compiled into caches of their own
+	m_Pipelines->MergeCaches();
 	auto const    cache = m_PipelineCache->AcquireCache(m_Context);
 	std::ofstream cacheOutput{
 		std::format("data/pipelines_{}_{}.cache"
@@ -1236,6 +1954,15 @@ void App::End()
 	};
 	cacheOutput.write(cache.Cache.data(), cache.Cache.size() * sizeof(cache.Cache[0]));
 
+	try
+	{
+		startup_timeline::WriteJson("data/startup_timeline.json");
+	}
+	catch (std::runtime_error const& error)
+	{
+		std::cerr << error.what() << std::endl;
+	}
+
 	ImGui_ImplVulkan_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
@@ -1320,7 +2047,7 @@ void App::DoBlitPass(vkc::CommandBuffer& commandBuffer, size_t imageIndex)
 			, m_GbufferDescriptorSets[m_CurrentFrame]
 		};
 
-		m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_BlitPipeline);
+		m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipelines->Get(BLIT_PIPELINE));
 		m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
 													  , VK_PIPELINE_BIND_POINT_GRAPHICS
 													  , *m_BlitPipelineLayout
@@ -1440,9 +2167,10 @@ void App::DoLightingPass(vkc::CommandBuffer& commandBuffer, size_t) const
 			m_GlobalDescriptorSets[m_CurrentFrame]
 			, m_FrameDescriptorSets[m_CurrentFrame]
 			, m_GbufferDescriptorSets[m_CurrentFrame]
+			, m_LightClusterer->GetLightingDescriptorSet(m_CurrentFrame)
 		};
 
-		m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_LightingPipeline);
+		m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipelines->Get(GetLightingPipelineKey()));
 		m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
 													  , VK_PIPELINE_BIND_POINT_GRAPHICS
 													  , *m_LightingPipelineLayout
@@ -1556,9 +2284,12 @@ void App::DoGBufferPass(vkc::CommandBuffer& commandBuffer, size_t) const
 
 		m_Context.DispatchTable.cmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-		VkDescriptorSet const sets[]{ m_GlobalDescriptorSets[m_CurrentFrame], m_FrameDescriptorSets[m_CurrentFrame] };
+		VkDescriptorSet const sets[]
+		{
+			m_GlobalDescriptorSets[m_CurrentFrame], m_FrameDescriptorSets[m_CurrentFrame], m_ClusterCuller->GetDrawDescriptorSet()
+		};
 
-		m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_GBufferGenPipeline);
+		m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipelines->Get(GBUFFER_PIPELINE));
 		m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
 													  , VK_PIPELINE_BIND_POINT_GRAPHICS
 													  , *m_GBufferGenPipelineLayout
@@ -1568,41 +2299,23 @@ void App::DoGBufferPass(vkc::CommandBuffer& commandBuffer, size_t) const
 													  , 0
 													  , nullptr);
 
-		VkDeviceSize constexpr offsets[] = { {} };
-
-		for (auto const& meshes = m_Scene->GetMeshes();
-			 Mesh const& mesh: meshes)
-		{
-			m_Context.DispatchTable.cmdBindVertexBuffers(commandBuffer
-														 , 0
-														 , 1
-														 , mesh.GetVertexBuffer()
-														 , offsets);
-
-			m_Context.DispatchTable.cmdBindIndexBuffer(commandBuffer, mesh.GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-			m_Context.DispatchTable.cmdPushConstants(commandBuffer
-													 , *m_GBufferGenPipelineLayout
-													 , VK_SHADER_STAGE_FRAGMENT_BIT
-													 , 0
-													 , sizeof(TextureIndices)
-													 , &mesh.GetTextureIndices());
-
-			m_Context.DispatchTable.cmdDrawIndexed(commandBuffer
-												   , static_cast<uint32_t>(mesh.GetIndexBuffer().GetSize() / sizeof(uint32_t))
-												   , 1
-												   , 0
-												   , 0
-												   , 0);
-		}
+		// the late view is empty unless it was occlusion culled this frame
+		m_ClusterCuller->Draw(commandBuffer, m_CurrentFrame, *m_GBufferGenPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0);
+		m_ClusterCuller->Draw(commandBuffer
+							  , m_ClusterCuller->GetLateView(m_CurrentFrame)
+							  , *m_GBufferGenPipelineLayout
+							  , VK_SHADER_STAGE_VERTEX_BIT
+							  , 0);
 	}
 	m_Context.DispatchTable.cmdEndRendering(commandBuffer);
 	m_Context.DispatchTable.cmdEndDebugUtilsLabelEXT(commandBuffer);
 }
 
-void App::DoDepthPrepass(vkc::CommandBuffer const& commandBuffer, size_t) const
+void App::DoDepthPrepass(vkc::CommandBuffer const& commandBuffer, uint32_t view, VkAttachmentLoadOp loadOp) const
 {
-	std::string const    label{ "Depth prepass" };
+	// loading means the depth of the early prepass is extended by the late one
+	bool const           late = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+	std::string const    label{ late ? "Late depth prepass" : "Depth prepass" };
 	VkDebugUtilsLabelEXT debugLabel{};
 	debugLabel.sType      = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
 	debugLabel.pLabelName = label.c_str();
@@ -1615,9 +2328,9 @@ void App::DoDepthPrepass(vkc::CommandBuffer const& commandBuffer, size_t) const
 		vkc::Image::Transition transition{};
 		//
 		{
-			transition.SrcAccessMask = VK_ACCESS_2_NONE;
-			transition.DstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			transition.SrcAccessMask = late ? VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : VK_ACCESS_2_NONE;
+			transition.DstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			transition.SrcStageMask  = late ? VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT : VK_PIPELINE_STAGE_2_NONE;
 			transition.DstStageMask  = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT;
 			transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 		}
@@ -1629,7 +2342,7 @@ void App::DoDepthPrepass(vkc::CommandBuffer const& commandBuffer, size_t) const
 	depthAttachmentInfo.clearValue  = { .depthStencil{ 1.f, 0 } };
 	depthAttachmentInfo.imageLayout = m_DepthImage->GetLayout();
 	depthAttachmentInfo.imageView   = *m_DepthImageView;
-	depthAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depthAttachmentInfo.loadOp      = loadOp;
 	depthAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
 
 	VkRenderingInfo renderingInfo{};
@@ -1656,9 +2369,12 @@ void App::DoDepthPrepass(vkc::CommandBuffer const& commandBuffer, size_t) const
 
 		m_Context.DispatchTable.cmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-		VkDescriptorSet const sets[]{ m_GlobalDescriptorSets[m_CurrentFrame], m_FrameDescriptorSets[m_CurrentFrame] };
+		VkDescriptorSet const sets[]
+		{
+			m_GlobalDescriptorSets[m_CurrentFrame], m_FrameDescriptorSets[m_CurrentFrame], m_ClusterCuller->GetDrawDescriptorSet()
+		};
 
-		m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_DepthPrepPipeline);
+		m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipelines->Get(DEPTH_PREPASS_PIPELINE));
 		m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
 													  , VK_PIPELINE_BIND_POINT_GRAPHICS
 													  , *m_DepthPrepPipelineLayout
@@ -1668,33 +2384,7 @@ void App::DoDepthPrepass(vkc::CommandBuffer const& commandBuffer, size_t) const
 													  , 0
 													  , nullptr);
 
-		VkDeviceSize constexpr offsets[] = { {} };
-
-		for (auto const& meshes = m_Scene->GetMeshes();
-			 Mesh const& mesh: meshes)
-		{
-			m_Context.DispatchTable.cmdBindVertexBuffers(commandBuffer
-														 , 0
-														 , 1
-														 , mesh.GetVertexBuffer()
-														 , offsets);
-
-			m_Context.DispatchTable.cmdBindIndexBuffer(commandBuffer, mesh.GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-			m_Context.DispatchTable.cmdPushConstants(commandBuffer
-													 , *m_DepthPrepPipelineLayout
-													 , VK_SHADER_STAGE_FRAGMENT_BIT
-													 , 0
-													 , sizeof(TextureIndices::Diffuse)
-													 , &mesh.GetTextureIndices().Diffuse);
-
-			m_Context.DispatchTable.cmdDrawIndexed(commandBuffer
-												   , static_cast<uint32_t>(mesh.GetIndexBuffer().GetSize() / sizeof(uint32_t))
-												   , 1
-												   , 0
-												   , 0
-												   , 0);
-		}
+		m_ClusterCuller->Draw(commandBuffer, view, *m_DepthPrepPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0);
 	}
 	m_Context.DispatchTable.cmdEndRendering(commandBuffer);
 	m_Context.DispatchTable.cmdEndDebugUtilsLabelEXT(commandBuffer);
@@ -0,0 +1,347 @@
+#include "block_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	uint32_t constexpr TEXEL_COUNT{ block_compression::BLOCK_DIMENSION * block_compression::BLOCK_DIMENSION };
+	uint32_t constexpr CHANNEL_COUNT{ 4 };
+
+	using Block = std::array<std::array<float, CHANNEL_COUNT>, TEXEL_COUNT>;
+
+	Block FetchBlock(std::span<unsigned char const> pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY)
+	{
+		Block block{};
+		for (uint32_t y{}; y < block_compression::BLOCK_DIMENSION; ++y)
+			for (uint32_t x{}; x < block_compression::BLOCK_DIMENSION; ++x)
+			{
+				uint32_t const pixelX = std::min(blockX * block_compression::BLOCK_DIMENSION + x, width - 1);
+				uint32_t const pixelY = std::min(blockY * block_compression::BLOCK_DIMENSION + y, height - 1);
+
+				unsigned char const* texel = pixels.data() + (static_cast<size_t>(pixelY) * width + pixelX) * CHANNEL_COUNT;
+				for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+					block[y * block_compression::BLOCK_DIMENSION + x][channel] = texel[channel];
+			}
+		return block;
+	}
+
+	template<typename Encoder>
+	std::vector<unsigned char> EncodeBlocks(uint32_t width, uint32_t height, uint32_t blockSize, Encoder&& encoder)
+	{
+		uint32_t const blocksX = (width + block_compression::BLOCK_DIMENSION - 1) / block_compression::BLOCK_DIMENSION;
+		uint32_t const blocksY = (height + block_compression::BLOCK_DIMENSION - 1) / block_compression::BLOCK_DIMENSION;
+
+		std::vector<unsigned char> result(static_cast<size_t>(blocksX) * blocksY * blockSize);
+		for (uint32_t blockY{}; blockY < blocksY; ++blockY)
+			for (uint32_t blockX{}; blockX < blocksX; ++blockX)
+				encoder(blockX, blockY, result.data() + (static_cast<size_t>(blockY) * blocksX + blockX) * blockSize);
+		return result;
+	}
+
+	void EncodeBC4Block(Block const& block, uint32_t channel, unsigned char* output)
+	{
+		float minValue{ 255.f };
+		float maxValue{};
+		for (auto const& texel: block)
+		{
+			minValue = std::min(minValue, texel[channel]);
+			maxValue = std::max(maxValue, texel[channel]);
+		}
+
+		auto const red0 = static_cast<unsigned char>(maxValue);
+		auto const red1 = static_cast<unsigned char>(minValue);
+
+		uint64_t bits = red0 | static_cast<uint64_t>(red1) << 8;
+		// equal endpoints select the 6 value mode, where index 0 still decodes to red0
+		if (red0 != red1)
+		{
+			float const range = static_cast<float>(red0 - red1);
+			for (uint32_t texelIndex{}; texelIndex < TEXEL_COUNT; ++texelIndex)
+			{
+				// step from red0 towards red1, palette entries 2..7 sit between the endpoints
+				auto const step  = static_cast<uint32_t>(std::lround((red0 - block[texelIndex][channel]) / range * 7.f));
+				uint64_t   index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+				bits |= index << (16 + texelIndex * 3);
+			}
+		}
+		std::memcpy(output, &bits, sizeof(bits));
+	}
+
+	class BitWriter final
+	{
+	public:
+		void Write(uint32_t value, uint32_t count)
+		{
+			for (uint32_t bit{}; bit < count; ++bit, ++m_Position)
+				if (value >> bit & 1)
+					m_Bytes[m_Position / 8] |= static_cast<unsigned char>(1 << m_Position % 8);
+		}
+
+		[[nodiscard]] std::array<unsigned char, 16> const& GetBytes() const
+		{
+			return m_Bytes;
+		}
+
+	private:
+		std::array<unsigned char, 16> m_Bytes{};
+		uint32_t                      m_Position{};
+	};
+
+	uint32_t constexpr BC7_WEIGHTS[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	using Colour = std::array<float, CHANNEL_COUNT>;
+
+	struct BC7Candidate
+	{
+		std::array<uint32_t, CHANNEL_COUNT> Endpoints[2];
+		uint32_t                            PBits[2];
+		uint32_t                            Indices[TEXEL_COUNT];
+		float                               Error;
+	};
+
+	// mode 6 endpoints are 7 bits per channel plus a shared lowest bit per endpoint
+	BC7Candidate EvaluateBC7(Block const& block, Colour const& endpoint0, Colour const& endpoint1, uint32_t pBit0, uint32_t pBit1)
+	{
+		BC7Candidate candidate{};
+		candidate.PBits[0] = pBit0;
+		candidate.PBits[1] = pBit1;
+
+		Colour decoded[2]{};
+		for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+		{
+			Colour const* const endpoints[]{ &endpoint0, &endpoint1 };
+			for (uint32_t endpoint{}; endpoint < 2; ++endpoint)
+			{
+				float const value     = ((*endpoints[endpoint])[channel] - static_cast<float>(candidate.PBits[endpoint])) * .5f;
+				auto const  quantized = static_cast<uint32_t>(std::clamp(std::lround(value), 0l, 127l));
+
+				candidate.Endpoints[endpoint][channel] = quantized;
+				decoded[endpoint][channel]             = static_cast<float>(quantized << 1 | candidate.PBits[endpoint]);
+			}
+		}
+
+		Colour palette[16]{};
+		for (uint32_t index{}; index < 16; ++index)
+			for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+			{
+				auto const     value0   = static_cast<uint32_t>(decoded[0][channel]);
+				auto const     value1   = static_cast<uint32_t>(decoded[1][channel]);
+				uint32_t const weight   = BC7_WEIGHTS[index];
+				palette[index][channel] = static_cast<float>(((64 - weight) * value0 + weight * value1 + 32) >> 6);
+			}
+
+		Colour axis{};
+		float  axisLengthSquared{};
+		for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+		{
+			axis[channel] = decoded[1][channel] - decoded[0][channel];
+			axisLengthSquared += axis[channel] * axis[channel];
+		}
+
+		for (uint32_t texelIndex{}; texelIndex < TEXEL_COUNT; ++texelIndex)
+		{
+			Colour const& texel = block[texelIndex];
+
+			float projection{};
+			for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+				projection += (texel[channel] - decoded[0][channel]) * axis[channel];
+			float const t = axisLengthSquared > .0f ? std::clamp(projection / axisLengthSquared, .0f, 1.f) : .0f;
+
+			// weights are nearly uniform, checking the neighbours of the rounded guess is enough
+			auto const guess = static_cast<int32_t>(std::lround(t * 15.f));
+			float      bestError{ FLT_MAX };
+			for (int32_t index = std::max(guess - 1, 0); index <= std::min(guess + 1, 15); ++index)
+			{
+				float error{};
+				for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+				{
+					float const difference = palette[index][channel] - texel[channel];
+					error += difference * difference;
+				}
+				if (error < bestError)
+				{
+					bestError                     = error;
+					candidate.Indices[texelIndex] = static_cast<uint32_t>(index);
+				}
+			}
+			candidate.Error += bestError;
+		}
+		return candidate;
+	}
+
+	BC7Candidate FindBestPBits(Block const& block, Colour const& endpoint0, Colour const& endpoint1)
+	{
+		BC7Candidate best{};
+		best.Error = FLT_MAX;
+		for (uint32_t pBits{}; pBits < 4; ++pBits)
+			if (BC7Candidate candidate = EvaluateBC7(block, endpoint0, endpoint1, pBits & 1, pBits >> 1);
+				candidate.Error < best.Error)
+				best = candidate;
+		return best;
+	}
+
+	void EncodeBC7Block(Block const& block, unsigned char* output)
+	{
+		Colour mean{};
+		for (auto const& texel: block)
+			for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+				mean[channel] += texel[channel] / TEXEL_COUNT;
+
+		float covariance[CHANNEL_COUNT][CHANNEL_COUNT]{};
+		for (auto const& texel: block)
+			for (uint32_t row{}; row < CHANNEL_COUNT; ++row)
+				for (uint32_t column{}; column < CHANNEL_COUNT; ++column)
+					covariance[row][column] += (texel[row] - mean[row]) * (texel[column] - mean[column]);
+
+		// principal axis by power iteration
+		Colour axis{ 1.f, 1.f, 1.f, 1.f };
+		for (uint32_t iteration{}; iteration < 8; ++iteration)
+		{
+			Colour next{};
+			for (uint32_t row{}; row < CHANNEL_COUNT; ++row)
+				for (uint32_t column{}; column < CHANNEL_COUNT; ++column)
+					next[row] += covariance[row][column] * axis[column];
+
+			float length{};
+			for (float const value: next)
+				length += value * value;
+			length = std::sqrt(length);
+			if (length < 1e-6f)
+				break;
+			for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+				axis[channel] = next[channel] / length;
+		}
+
+		float minProjection{ FLT_MAX };
+		float maxProjection{ -FLT_MAX };
+		for (auto const& texel: block)
+		{
+			float projection{};
+			for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+				projection += (texel[channel] - mean[channel]) * axis[channel];
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		Colour endpoint0{};
+		Colour endpoint1{};
+		for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+		{
+			endpoint0[channel] = std::clamp(mean[channel] + axis[channel] * minProjection, .0f, 255.f);
+			endpoint1[channel] = std::clamp(mean[channel] + axis[channel] * maxProjection, .0f, 255.f);
+		}
+
+		BC7Candidate best = FindBestPBits(block, endpoint0, endpoint1);
+
+		// one least squares pass over the endpoints with the chosen weights
+		//
+		{
+			float  sumAlphaSquared{};
+			float  sumBetaSquared{};
+			float  sumAlphaBeta{};
+			Colour sumAlphaTexel{};
+			Colour sumBetaTexel{};
+			for (uint32_t texelIndex{}; texelIndex < TEXEL_COUNT; ++texelIndex)
+			{
+				float const beta  = static_cast<float>(BC7_WEIGHTS[best.Indices[texelIndex]]) / 64.f;
+				float const alpha = 1.f - beta;
+				sumAlphaSquared += alpha * alpha;
+				sumBetaSquared += beta * beta;
+				sumAlphaBeta += alpha * beta;
+				for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+				{
+					sumAlphaTexel[channel] += alpha * block[texelIndex][channel];
+					sumBetaTexel[channel] += beta * block[texelIndex][channel];
+				}
+			}
+
+			if (float const determinant = sumAlphaSquared * sumBetaSquared - sumAlphaBeta * sumAlphaBeta;
+				std::abs(determinant) > 1e-6f)
+			{
+				Colour refined0{};
+				Colour refined1{};
+				for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+				{
+					refined0[channel] = std::clamp((sumBetaSquared * sumAlphaTexel[channel] - sumAlphaBeta * sumBetaTexel[channel]) / determinant
+												   , .0f
+												   , 255.f);
+					refined1[channel] = std::clamp((sumAlphaSquared * sumBetaTexel[channel] - sumAlphaBeta * sumAlphaTexel[channel]) / determinant
+												   , .0f
+												   , 255.f);
+				}
+				if (BC7Candidate refined = FindBestPBits(block, refined0, refined1);
+					refined.Error < best.Error)
+					best = refined;
+			}
+		}
+
+		// the first texel's index is stored with an implicit zero top bit
+		if (best.Indices[0] >= 8)
+		{
+			std::swap(best.Endpoints[0], best.Endpoints[1]);
+			std::swap(best.PBits[0], best.PBits[1]);
+			for (uint32_t& index: best.Indices)
+				index = 15 - index;
+		}
+
+		BitWriter writer{};
+		writer.Write(1 << 6, 7);
+		for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+		{
+			writer.Write(best.Endpoints[0][channel], 7);
+			writer.Write(best.Endpoints[1][channel], 7);
+		}
+		writer.Write(best.PBits[0], 1);
+		writer.Write(best.PBits[1], 1);
+		for (uint32_t texelIndex{}; texelIndex < TEXEL_COUNT; ++texelIndex)
+			writer.Write(best.Indices[texelIndex], texelIndex == 0 ? 3 : 4);
+
+		std::memcpy(output, writer.GetBytes().data(), writer.GetBytes().size());
+	}
+}
+
+uint64_t block_compression::CalculateSize(uint32_t width, uint32_t height, uint32_t blockSize)
+{
+	return static_cast<uint64_t>((width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION) *
+		   ((height + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION) * blockSize;
+}
+
+std::vector<unsigned char> block_compression::EncodeBC4
+(std::span<unsigned char const> pixels, uint32_t width, uint32_t height, uint32_t channel)
+{
+	return EncodeBlocks(width
+						, height
+						, 8
+						, [&](uint32_t blockX, uint32_t blockY, unsigned char* output)
+						{
+							EncodeBC4Block(FetchBlock(pixels, width, height, blockX, blockY), channel, output);
+						});
+}
+
+std::vector<unsigned char> block_compression::EncodeBC5(std::span<unsigned char const> pixels, uint32_t width, uint32_t height)
+{
+	return EncodeBlocks(width
+						, height
+						, 16
+						, [&](uint32_t blockX, uint32_t blockY, unsigned char* output)
+						{
+							Block const block = FetchBlock(pixels, width, height, blockX, blockY);
+							EncodeBC4Block(block, 0, output);
+							EncodeBC4Block(block, 1, output + 8);
+						});
+}
+
+std::vector<unsigned char> block_compression::EncodeBC7(std::span<unsigned char const> pixels, uint32_t width, uint32_t height)
+{
+	return EncodeBlocks(width
+						, height
+						, 16
+						, [&](uint32_t blockX, uint32_t blockY, unsigned char* output)
+						{
+							EncodeBC7Block(FetchBlock(pixels, width, height, blockX, blockY), output);
+						});
+}
@@ -0,0 +1,465 @@
+#include "cluster_culling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+#include "datatypes.h"
+#include "depth_pyramid.h"
+#include "geometry_arena.h"
+#include "helper.h"
+#include "mesh.h"
+#include "pipeline_cache.h"
+#include "scene.h"
+
+namespace
+{
+	uint32_t constexpr WORKGROUP_SIZE{ 64 };
+
+	VkDeviceSize constexpr DRAW_STRIDE{ sizeof(VkDrawIndexedIndirectCommand) };
+
+	// visible clusters, submitted triangles, visible meshes and occluded clusters
+	uint32_t constexpr STATISTICS_PER_VIEW{ 4 };
+
+	// 16 and 32 bit index draws
+	uint32_t constexpr COUNTS_PER_VIEW{ 2 };
+}
+
+// the late passes get draw slots, counts and statistics of their own after those of every view
+ClusterCuller::ClusterCuller
+(
+	vkc::Context&         context
+	, Scene const&        scene
+	, uint32_t            viewCount
+	, uint32_t            occlusionViewCount
+	, vkc::PipelineCache& cache
+)
+	: m_Context{ context }
+	, m_Scene{ scene }
+	, m_ClusterCount{ scene.GetGeometry().GetClusterCapacity() }
+	, m_ShortIndexClusterCount{ scene.GetShortIndexClusterCount() }
+	, m_ViewCount{ viewCount }
+	, m_OcclusionViewCount{ occlusionViewCount }
+	, m_InvocationCounts(viewCount)
+	, m_SortDurations(viewCount)
+	, m_DrawBuffer{ vkc::BufferBuilder{ context }
+					.SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+					.Build(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+						   , std::max<VkDeviceSize>(static_cast<VkDeviceSize>(viewCount + occlusionViewCount) * m_ClusterCount * DRAW_STRIDE
+													, DRAW_STRIDE)) }
+	, m_DrawDataBuffer{ vkc::BufferBuilder{ context }
+						.SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+						.Build(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+							   , std::max<VkDeviceSize>(static_cast<VkDeviceSize>(viewCount + occlusionViewCount) * m_ClusterCount
+														* sizeof(TextureIndices)
+														, sizeof(TextureIndices))) }
+	, m_CountBuffer{ vkc::BufferBuilder{ context }
+					 .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+					 .Build(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+							, std::max<VkDeviceSize>(static_cast<VkDeviceSize>(viewCount + occlusionViewCount) * COUNTS_PER_VIEW
+													 * sizeof(uint32_t)
+													 , sizeof(uint32_t))) }
+	, m_VisibilityBuffer{ vkc::BufferBuilder{ context }
+						  .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+						  .Build(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+								 , std::max<VkDeviceSize>(static_cast<VkDeviceSize>(m_ClusterCount) * sizeof(uint32_t), sizeof(uint32_t))) }
+	, m_DescriptorSetLayout{ vkc::DescriptorSetLayoutBuilder{ context }
+							 .AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(9, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .Build() }
+	, m_DrawDescriptorSetLayout{ vkc::DescriptorSetLayoutBuilder{ context }
+								 .AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+								 .Build() }
+	// clusters, draws, counts, statistics, draw ranges, mesh data, draw data, visibility, occlusion views and the depth
+	// pyramid for the cull, draw data for the passes
+	, m_DescriptorPool{ vkc::DescriptorPoolBuilder{ context }
+						.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 10)
+						.AddPoolSize(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1)
+						.Build(2) }
+	, m_PipelineLayout{ vkc::PipelineLayoutBuilder{ context }
+						.AddDescriptorSetLayout(m_DescriptorSetLayout)
+						.AddPushConstant(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants))
+						.Build() }
+{
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkBuffer>(m_DrawBuffer)), VK_OBJECT_TYPE_BUFFER, "cluster draws");
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkBuffer>(m_DrawDataBuffer)), VK_OBJECT_TYPE_BUFFER, "cluster draw data");
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkBuffer>(m_CountBuffer)), VK_OBJECT_TYPE_BUFFER, "cluster draw counts");
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkBuffer>(m_VisibilityBuffer)), VK_OBJECT_TYPE_BUFFER, "cluster visibility");
+	m_Statistics = help::CreateMappedBuffer(m_Context
+											, static_cast<VkDeviceSize>(m_ViewCount + m_OcclusionViewCount) * STATISTICS_PER_VIEW * sizeof(uint32_t)
+											, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+											, "cluster statistics");
+	m_OcclusionViews = help::CreateMappedBuffer(m_Context
+												, std::max<VkDeviceSize>(static_cast<VkDeviceSize>(m_OcclusionViewCount) * sizeof(OcclusionView)
+																		 , sizeof(OcclusionView))
+												, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+												, "cluster occlusion views");
+	// a mesh has at least one cluster, so a view never lists more meshes than the arena holds clusters
+	m_DrawRanges = help::CreateMappedBuffer(m_Context
+											, static_cast<VkDeviceSize>(m_ViewCount) * (m_ClusterCount + 1) * sizeof(glm::uvec2)
+											, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+											, "cluster draw ranges");
+	m_MeshData = help::CreateMappedBuffer(m_Context
+										  , std::max<VkDeviceSize>(static_cast<VkDeviceSize>(m_ClusterCount) * sizeof(MeshData), sizeof(MeshData))
+										  , VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+										  , "cluster mesh data");
+	CreatePipelines(cache);
+
+	std::vector<VkDescriptorSetLayout> const layouts{ m_DescriptorSetLayout, m_DrawDescriptorSetLayout };
+	m_DescriptorSets = vkc::DescriptorSetBuilder{ m_Context }.Build(m_DescriptorPool, layouts);
+
+	VkDescriptorBufferInfo const clusterInfo{ scene.GetGeometry().GetClusterBuffer(), 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const drawInfo{ m_DrawBuffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const countInfo{ m_CountBuffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const statisticsInfo{ m_Statistics.Buffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const drawRangeInfo{ m_DrawRanges.Buffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const meshDataInfo{ m_MeshData.Buffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const drawDataInfo{ m_DrawDataBuffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const visibilityInfo{ m_VisibilityBuffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const occlusionViewInfo{ m_OcclusionViews.Buffer, 0, VK_WHOLE_SIZE };
+	m_DescriptorSets[0]
+		.AddWriteDescriptor({ &clusterInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0, 0)
+		.AddWriteDescriptor({ &drawInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, 0)
+		.AddWriteDescriptor({ &countInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, 0)
+		.AddWriteDescriptor({ &statisticsInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3, 0)
+		.AddWriteDescriptor({ &drawRangeInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4, 0)
+		.AddWriteDescriptor({ &meshDataInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5, 0)
+		.AddWriteDescriptor({ &drawDataInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 6, 0)
+		.AddWriteDescriptor({ &visibilityInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 7, 0)
+		.AddWriteDescriptor({ &occlusionViewInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 8, 0)
+		.Update(m_Context);
+	m_DescriptorSets[1]
+		.AddWriteDescriptor({ &drawDataInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0, 0)
+		.Update(m_Context);
+}
+
+void ClusterCuller::Destroy()
+{
+	for (VkPipeline const pipeline: m_Pipelines)
+		m_Context.DispatchTable.destroyPipeline(pipeline, nullptr);
+	help::DestroyMappedBuffer(m_Context, m_Statistics);
+	help::DestroyMappedBuffer(m_Context, m_OcclusionViews);
+	help::DestroyMappedBuffer(m_Context, m_DrawRanges);
+	help::DestroyMappedBuffer(m_Context, m_MeshData);
+}
+
+void ClusterCuller::SetDepthPyramid(DepthPyramid const& depthPyramid)
+{
+	m_DepthExtent     = depthPyramid.GetDepthExtent();
+	m_DepthLevelCount = depthPyramid.GetLevelCount();
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageView   = depthPyramid.GetView();
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	m_DescriptorSets[0]
+		.AddWriteDescriptor({ &imageInfo, 1 }, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 9, 0)
+		.Update(m_Context);
+}
+
+void ClusterCuller::Cull
+(
+	VkCommandBuffer         commandBuffer
+	, uint32_t              view
+	, ViewParameters const& parameters
+) const
+{
+	Record(commandBuffer, view, parameters, Phase::All);
+}
+
+void ClusterCuller::CullEarly
+(
+	VkCommandBuffer         commandBuffer
+	, uint32_t              view
+	, ViewParameters const& parameters
+) const
+{
+	Record(commandBuffer, view, parameters, Phase::Early);
+}
+
+void ClusterCuller::CullLate
+(
+	VkCommandBuffer         commandBuffer
+	, uint32_t              view
+	, ViewParameters const& parameters
+) const
+{
+	OcclusionView& occlusionView = static_cast<OcclusionView*>(m_OcclusionViews.Data)[view];
+	occlusionView.ViewProjection = parameters.ViewProjection;
+	occlusionView.DepthSize      = glm::uvec2{ m_DepthExtent.width, m_DepthExtent.height };
+	occlusionView.LevelCount     = m_DepthLevelCount;
+
+	Record(commandBuffer, view, parameters, Phase::Late);
+}
+
+void ClusterCuller::Record
+(
+	VkCommandBuffer         commandBuffer
+	, uint32_t              view
+	, ViewParameters const& parameters
+	, Phase                 phase
+) const
+{
+	frustum_culling::Planes const planes = frustum_culling::ExtractPlanes(parameters.ViewProjection);
+
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType              = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.memoryBarrierCount = 1;
+
+	if (phase == Phase::Late)
+	{
+		// the early pass of the view read the visibility the late one overwrites and counted into the same statistics
+		VkMemoryBarrier2 earlyBarrier{};
+		earlyBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		earlyBarrier.srcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		earlyBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+		earlyBarrier.dstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		earlyBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+
+		dependencyInfo.pMemoryBarriers = &earlyBarrier;
+		m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+	else
+	{
+		// the late pass reuses the order and LODs picked for the early one
+		SelectLods(view, parameters, planes);
+
+		// earlier draws of this view may still be reading its slots
+		VkMemoryBarrier2 reuseBarrier{};
+		reuseBarrier.sType        = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		reuseBarrier.srcStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+		reuseBarrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+
+		dependencyInfo.pMemoryBarriers = &reuseBarrier;
+		m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+		auto const clear = [this, commandBuffer](uint32_t clearedView)
+		{
+			m_Context.DispatchTable.cmdFillBuffer(commandBuffer
+												  , m_CountBuffer
+												  , clearedView * COUNTS_PER_VIEW * sizeof(uint32_t)
+												  , COUNTS_PER_VIEW * sizeof(uint32_t)
+												  , 0);
+			m_Context.DispatchTable.cmdFillBuffer(commandBuffer
+												  , m_Statistics.Buffer
+												  , clearedView * STATISTICS_PER_VIEW * sizeof(uint32_t)
+												  , STATISTICS_PER_VIEW * sizeof(uint32_t)
+												  , 0);
+		};
+		clear(view);
+		// drawn after the early draws whether or not the late pass runs
+		if (view < m_OcclusionViewCount)
+			clear(GetLateView(view));
+		if (phase == Phase::Early && !m_VisibilityCleared)
+		{
+			m_Context.DispatchTable.cmdFillBuffer(commandBuffer, m_VisibilityBuffer, 0, VK_WHOLE_SIZE, 0);
+			m_VisibilityCleared = true;
+		}
+
+		// the last late pass wrote the visibility the early one reads
+		VkMemoryBarrier2 clearBarrier{};
+		clearBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		clearBarrier.srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		clearBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+		clearBarrier.dstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+
+		dependencyInfo.pMemoryBarriers = &clearBarrier;
+		m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+
+	PushConstants constants{};
+	std::ranges::copy(planes, constants.Planes);
+	constants.Eye          = parameters.Eye;
+	constants.View         = view;
+	constants.ClusterCount           = m_ClusterCount;
+	constants.ShortIndexClusterCount = m_ShortIndexClusterCount;
+
+	VkDescriptorSet const descriptorSet = m_DescriptorSets[0];
+	m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipelines[static_cast<size_t>(phase)]);
+	m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
+												  , VK_PIPELINE_BIND_POINT_COMPUTE
+												  , m_PipelineLayout
+												  , 0
+												  , 1
+												  , &descriptorSet
+												  , 0
+												  , nullptr);
+	m_Context.DispatchTable.cmdPushConstants(commandBuffer
+											 , m_PipelineLayout
+											 , VK_SHADER_STAGE_COMPUTE_BIT
+											 , 0
+											 , sizeof(PushConstants)
+											 , &constants);
+	m_Context.DispatchTable.cmdDispatch(commandBuffer, (m_InvocationCounts[view] + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+	VkMemoryBarrier2 drawBarrier{};
+	drawBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	drawBarrier.srcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	drawBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+	drawBarrier.dstStageMask  = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_HOST_BIT;
+	drawBarrier.dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_HOST_READ_BIT;
+
+	dependencyInfo.pMemoryBarriers = &drawBarrier;
+	m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void ClusterCuller::UpdateMeshData() const
+{
+	auto* meshData = static_cast<MeshData*>(m_MeshData.Data);
+	for (Mesh const& mesh: m_Scene.GetMeshes())
+		meshData[mesh.GetFirstCluster()] = MeshData{ mesh.GetTextureIndices() };
+}
+
+void ClusterCuller::SelectLods(uint32_t view, ViewParameters const& parameters, frustum_culling::Planes const& planes) const
+{
+	// one set of lists per recording thread. indices into the scene's mesh list that passed the host frustum test, the
+	// LOD picked for each of them and their sort keys
+	thread_local std::vector<uint32_t>           visibleMeshes;
+	thread_local std::vector<Mesh::Lod const*>   lods;
+	thread_local std::vector<draw_sorting::Item> items;
+	thread_local std::vector<draw_sorting::Item> scratch;
+	frustum_culling::Spheres const&              bounds = m_Scene.GetMeshBounds();
+	frustum_culling::Cull(planes, bounds, visibleMeshes);
+
+	lods.clear();
+	items.clear();
+	auto visibleMesh = visibleMeshes.cbegin();
+	auto mesh        = m_Scene.GetMeshes().cbegin();
+	for (uint32_t meshIndex{}; visibleMesh != visibleMeshes.cend(); ++meshIndex, ++mesh)
+	{
+		// the visible indices ascend in list order
+		if (*visibleMesh != meshIndex)
+			continue;
+		++visibleMesh;
+
+		// clip space z grows with the distance for perspective and orthographic projections alike
+		glm::vec4 const center{ bounds.GetX()[meshIndex], bounds.GetY()[meshIndex], bounds.GetZ()[meshIndex], 1.f };
+		float const     depth = (parameters.ViewProjection * center).z;
+		// the index buffer binding is the only state the draws of a pass switch
+		uint16_t const state = mesh->GetIndexType() == VK_INDEX_TYPE_UINT32 ? 1 : 0;
+		items.emplace_back(draw_sorting::MakeKey(parameters.DrawOrder, state, mesh->GetTextureIndices().Diffuse, depth)
+						   , static_cast<uint32_t>(lods.size()));
+		lods.emplace_back(&mesh->GetLods()[mesh->SelectLod(parameters.ViewProjection
+														   , parameters.ViewportHeight
+														   , parameters.LodPixelError)]);
+	}
+
+	auto const sortStart = std::chrono::steady_clock::now();
+	draw_sorting::Sort(items, scratch);
+	auto const sortEnd    = std::chrono::steady_clock::now();
+	m_SortDurations[view] = std::chrono::duration<double>(sortEnd - sortStart).count();
+
+	auto*    drawRanges = static_cast<glm::uvec2*>(m_DrawRanges.Data) + static_cast<size_t>(view) * (m_ClusterCount + 1);
+	uint32_t invocationCount{};
+	for (uint32_t index{}; index < items.size(); ++index)
+	{
+		Mesh::Lod const& lod  = *lods[items[index].Value];
+		drawRanges[index + 1] = glm::uvec2{ invocationCount, lod.FirstCluster };
+		invocationCount += lod.ClusterCount;
+	}
+	drawRanges[0]            = glm::uvec2{ static_cast<uint32_t>(items.size()), invocationCount };
+	m_InvocationCounts[view] = invocationCount;
+}
+
+void ClusterCuller::Draw
+(
+	VkCommandBuffer      commandBuffer
+	, uint32_t           view
+	, VkPipelineLayout   pipelineLayout
+	, VkShaderStageFlags pushConstantStages
+	, uint32_t           pushConstantOffset
+) const
+{
+	GeometryArena const& geometry = m_Scene.GetGeometry();
+	geometry.BindVertexBuffer(commandBuffer);
+
+	std::pair<VkIndexType, uint32_t> const sections[]
+	{
+		{ VK_INDEX_TYPE_UINT16, m_ShortIndexClusterCount }
+		, { VK_INDEX_TYPE_UINT32, m_ClusterCount - m_ShortIndexClusterCount }
+	};
+	uint32_t firstDraw = view * m_ClusterCount;
+	for (uint32_t section{}; section < COUNTS_PER_VIEW; ++section)
+	{
+		auto const [indexType, maxDrawCount] = sections[section];
+		if (maxDrawCount > 0)
+		{
+			geometry.BindIndexBuffer(commandBuffer, indexType);
+			m_Context.DispatchTable.cmdPushConstants(commandBuffer
+													 , pipelineLayout
+													 , pushConstantStages
+													 , pushConstantOffset
+													 , sizeof(uint32_t)
+													 , &firstDraw);
+			m_Context.DispatchTable.cmdDrawIndexedIndirectCount(commandBuffer
+																, m_DrawBuffer
+																, firstDraw * DRAW_STRIDE
+																, m_CountBuffer
+																, (view * COUNTS_PER_VIEW + section) * sizeof(uint32_t)
+																, maxDrawCount
+																, static_cast<uint32_t>(DRAW_STRIDE));
+		}
+		firstDraw += maxDrawCount;
+	}
+}
+
+ClusterCuller::Statistics ClusterCuller::GetStatistics(uint32_t firstView, uint32_t viewCount) const
+{
+	uint32_t const meshCount = static_cast<uint32_t>(m_Scene.GetMeshes().size());
+	Statistics     statistics{ 0, viewCount * m_Scene.GetResidentClusterCount(), 0, 0, viewCount * meshCount, 0 };
+	auto const*    counts = static_cast<uint32_t const*>(m_Statistics.Data);
+	auto const     add    = [&statistics, counts](uint32_t view)
+	{
+		statistics.Visible += counts[view * STATISTICS_PER_VIEW];
+		statistics.Triangles += counts[view * STATISTICS_PER_VIEW + 1];
+		statistics.VisibleMeshes += counts[view * STATISTICS_PER_VIEW + 2];
+		statistics.Occluded += counts[view * STATISTICS_PER_VIEW + 3];
+	};
+	for (uint32_t view{ firstView }; view < firstView + viewCount && view < m_ViewCount; ++view)
+	{
+		add(view);
+		if (view < m_OcclusionViewCount)
+			add(GetLateView(view));
+	}
+	return statistics;
+}
+
+void ClusterCuller::CreatePipelines(vkc::PipelineCache& cache)
+{
+	// the phase and where the late draws start, compiled in since the push constants are full
+	struct Specialization
+	{
+		uint32_t Phase;
+		uint32_t ViewCount;
+	};
+
+	VkSpecializationMapEntry const entries[]
+	{
+		{ 0, offsetof(Specialization, Phase), sizeof(uint32_t) }
+		, { 1, offsetof(Specialization, ViewCount), sizeof(uint32_t) }
+	};
+
+	std::array<Specialization, 3>       specializations{};
+	std::array<VkSpecializationInfo, 3> specializationInfos{};
+	for (uint32_t phase{}; phase < specializationInfos.size(); ++phase)
+	{
+		specializations[phase] = Specialization{ phase, m_ViewCount };
+
+		specializationInfos[phase].mapEntryCount = static_cast<uint32_t>(std::size(entries));
+		specializationInfos[phase].pMapEntries   = entries;
+		specializationInfos[phase].dataSize      = sizeof(Specialization);
+		specializationInfos[phase].pData         = &specializations[phase];
+	}
+
+	std::string_view const names[]{ "cluster culling", "early cluster culling", "late cluster culling" };
+	help::CreateComputePipelines(m_Context, cache, m_PipelineLayout, "shaders/cluster_cull.spv", specializationInfos, names, m_Pipelines);
+}
@@ -0,0 +1,170 @@
+#include "cooked_scene.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	char constexpr MAGIC[4]{ 'V', 'R', 'S', 'C' };
+	size_t constexpr SECTION_ALIGNMENT{ 16 };
+
+	static_assert(std::is_trivially_copyable_v<CookedScene::Header>);
+	static_assert(std::is_trivially_copyable_v<MeshRecord>);
+	static_assert(std::is_trivially_copyable_v<Meshlet>);
+	static_assert(std::is_trivially_copyable_v<MeshLod>);
+	static_assert(std::is_trivially_copyable_v<PackedVertex>);
+
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// FNV-1a
+	uint64_t Hash(std::span<std::byte const> bytes, uint64_t hash)
+	{
+		for (std::byte const byte: bytes)
+		{
+			hash ^= static_cast<uint64_t>(byte);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	void WritePadding(std::ofstream& file, uint64_t alignment)
+	{
+		static char constexpr zeros[SECTION_ALIGNMENT]{};
+		auto const position = static_cast<uint64_t>(file.tellp());
+		file.write(zeros, static_cast<std::streamsize>(AlignUp(position, alignment) - position));
+	}
+
+	template<typename T>
+	void WriteSpan(std::ofstream& file, std::span<T const> data)
+	{
+		file.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size_bytes()));
+	}
+}
+
+CookedScene::CookedScene(std::string_view path, uint64_t expectedSourceHash)
+	: m_File{ path }
+{
+	if (m_File.GetSize() < sizeof(Header))
+		throw std::runtime_error("cooked scene is truncated");
+
+	m_Header = m_File.GetView<Header>(0, 1).data();
+	if (std::memcmp(m_Header->Magic, MAGIC, sizeof(MAGIC)) != 0 || m_Header->Version != VERSION)
+		throw std::runtime_error("cooked scene has unsupported format");
+	if (m_Header->SourceHash != expectedSourceHash)
+		throw std::runtime_error("cooked scene is stale");
+	if (m_Header->FileSize != m_File.GetSize())
+		throw std::runtime_error("cooked scene is truncated");
+
+	m_View.Vertices = m_File.GetView<PackedVertex>(m_Header->VerticesOffset, m_Header->VertexCount);
+	m_View.Indices  = m_File.GetView<uint32_t>(m_Header->IndicesOffset, m_Header->IndexCount);
+	m_View.Meshes   = m_File.GetView<MeshRecord>(m_Header->MeshesOffset, m_Header->MeshCount);
+	m_View.Meshlets = m_File.GetView<Meshlet>(m_Header->MeshletsOffset, m_Header->MeshletCount);
+	m_View.Lods     = m_File.GetView<MeshLod>(m_Header->LodsOffset, m_Header->LodCount);
+
+	std::span const table = m_File.GetView<std::byte>(m_Header->TexturesOffset, m_Header->TextureTableSize);
+	size_t          offset{};
+	m_Textures.reserve(m_Header->TextureCount);
+	for (uint32_t index{}; index < m_Header->TextureCount; ++index)
+	{
+		uint32_t entry[2]{};
+		if (offset + sizeof(entry) > table.size())
+			throw std::runtime_error("cooked scene texture table is corrupted");
+		std::memcpy(entry, table.data() + offset, sizeof(entry));
+		offset += sizeof(entry);
+
+		auto const& [usage, length] = entry;
+		if (offset + length > table.size())
+			throw std::runtime_error("cooked scene texture table is corrupted");
+		m_Textures.push_back(TextureEntry{
+			std::string{ reinterpret_cast<char const*>(table.data() + offset), length }
+			, static_cast<TextureUsage>(usage)
+		});
+		offset = AlignUp(offset + length, sizeof(uint32_t));
+	}
+
+	m_View.Textures        = m_Textures;
+	m_View.AABBMin         = m_Header->AABBMin;
+	m_View.AABBMax         = m_Header->AABBMax;
+	m_View.ContainsPBRInfo = m_Header->ContainsPBRInfo != 0;
+}
+
+std::string cooked_scene::GetCachePath(std::string_view sourcePath)
+{
+	return std::filesystem::path{ sourcePath }.replace_extension(".scene").string();
+}
+
+uint64_t cooked_scene::HashSource(std::string_view sourcePath)
+{
+	uint64_t hash = Hash(std::as_bytes(std::span{ &CookedScene::VERSION, 1 }), 0xcbf29ce484222325ull);
+	hash          = Hash(MappedFile{ sourcePath }.GetData(), hash);
+
+	// glTF keeps geometry in an external buffer, a re-export may touch only that file
+	if (std::filesystem::path const buffer = std::filesystem::path{ sourcePath }.replace_extension(".bin");
+		std::filesystem::exists(buffer))
+		hash = Hash(MappedFile{ buffer.string() }.GetData(), hash);
+
+	return hash;
+}
+
+void cooked_scene::Write(std::string_view path, SceneData const& data, uint64_t sourceHash, double importDuration)
+{
+	std::vector<char> textureTable;
+	for (auto const& [texturePath, usage]: data.Textures)
+	{
+		uint32_t const entry[2]{ static_cast<uint32_t>(usage), static_cast<uint32_t>(texturePath.size()) };
+		textureTable.insert(textureTable.end()
+							, reinterpret_cast<char const*>(entry)
+							, reinterpret_cast<char const*>(entry) + sizeof(entry));
+		textureTable.insert(textureTable.end(), texturePath.begin(), texturePath.end());
+		textureTable.resize(AlignUp(textureTable.size(), sizeof(uint32_t)));
+	}
+
+	CookedScene::Header header{};
+	std::memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+	header.Version          = CookedScene::VERSION;
+	header.SourceHash       = sourceHash;
+	header.ImportDuration   = importDuration;
+	header.AABBMin          = data.AABBMin;
+	header.AABBMax          = data.AABBMax;
+	header.ContainsPBRInfo  = data.ContainsPBRInfo;
+	header.MeshCount        = static_cast<uint32_t>(data.Meshes.size());
+	header.TextureCount     = static_cast<uint32_t>(data.Textures.size());
+	header.TextureTableSize = static_cast<uint32_t>(textureTable.size());
+	header.MeshletCount     = static_cast<uint32_t>(data.Meshlets.size());
+	header.LodCount         = static_cast<uint32_t>(data.Lods.size());
+	header.VertexCount      = data.Vertices.size();
+	header.IndexCount       = data.Indices.size();
+
+	header.MeshesOffset   = AlignUp(sizeof(header), SECTION_ALIGNMENT);
+	header.MeshletsOffset = AlignUp(header.MeshesOffset + data.Meshes.size() * sizeof(MeshRecord), SECTION_ALIGNMENT);
+	header.LodsOffset     = AlignUp(header.MeshletsOffset + data.Meshlets.size() * sizeof(Meshlet), SECTION_ALIGNMENT);
+	header.VerticesOffset = AlignUp(header.LodsOffset + data.Lods.size() * sizeof(MeshLod), SECTION_ALIGNMENT);
+	header.IndicesOffset  = AlignUp(header.VerticesOffset + data.Vertices.size() * sizeof(PackedVertex), SECTION_ALIGNMENT);
+	header.TexturesOffset = AlignUp(header.IndicesOffset + data.Indices.size() * sizeof(uint32_t), SECTION_ALIGNMENT);
+	header.FileSize       = header.TexturesOffset + textureTable.size();
+
+	std::ofstream file{ std::string{ path }, std::ios::binary | std::ios::out | std::ios::trunc };
+	if (!file.is_open())
+		throw std::runtime_error("failed to open " + std::string{ path } + " for writing");
+
+	WriteSpan(file, std::span<CookedScene::Header const>{ &header, 1 });
+	WritePadding(file, SECTION_ALIGNMENT);
+	WriteSpan(file, std::span<MeshRecord const>{ data.Meshes });
+	WritePadding(file, SECTION_ALIGNMENT);
+	WriteSpan(file, std::span<Meshlet const>{ data.Meshlets });
+	WritePadding(file, SECTION_ALIGNMENT);
+	WriteSpan(file, std::span<MeshLod const>{ data.Lods });
+	WritePadding(file, SECTION_ALIGNMENT);
+	WriteSpan(file, std::span<PackedVertex const>{ data.Vertices });
+	WritePadding(file, SECTION_ALIGNMENT);
+	WriteSpan(file, std::span<uint32_t const>{ data.Indices });
+	WritePadding(file, SECTION_ALIGNMENT);
+	WriteSpan(file, std::span<char const>{ textureTable });
+
+	if (!file)
+		throw std::runtime_error("failed to write cooked scene " + std::string{ path });
+}
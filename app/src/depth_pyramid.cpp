@@ -0,0 +1,188 @@
+#include "depth_pyramid.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "command_buffer.h"
+#include "helper.h"
+#include "pipeline_cache.h"
+
+namespace
+{
+	uint32_t constexpr WORKGROUP_SIZE{ 8 };
+
+	VkExtent2D HalveRoundingUp(VkExtent2D extent)
+	{
+		return { (extent.width + 1) / 2, (extent.height + 1) / 2 };
+	}
+}
+
+DepthPyramid::DepthPyramid(vkc::Context& context, vkc::PipelineCache& cache)
+	: m_Context{ context }
+	, m_DescriptorSetLayout{ vkc::DescriptorSetLayoutBuilder{ context }
+							 .AddBinding(0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .Build() }
+	, m_DescriptorPool{ vkc::DescriptorPoolBuilder{ context }
+						.AddPoolSize(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, MAX_LEVEL_COUNT)
+						.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MAX_LEVEL_COUNT)
+						.Build(MAX_LEVEL_COUNT) }
+	, m_PipelineLayout{ vkc::PipelineLayoutBuilder{ context }
+						.AddDescriptorSetLayout(m_DescriptorSetLayout)
+						.Build() }
+{
+	CreatePipeline(cache);
+
+	std::vector<VkDescriptorSetLayout> const layouts(MAX_LEVEL_COUNT, m_DescriptorSetLayout);
+	m_DescriptorSets = vkc::DescriptorSetBuilder{ m_Context }.Build(m_DescriptorPool, layouts);
+}
+
+void DepthPyramid::Destroy()
+{
+	m_Context.DispatchTable.destroyPipeline(m_Pipeline, nullptr);
+	DestroyImage();
+}
+
+void DepthPyramid::Resize(vkc::Image const& depthImage, VkImageView depthView)
+{
+	DestroyImage();
+
+	m_DepthExtent = depthImage.GetExtent();
+
+	VkExtent2D const firstExtent = HalveRoundingUp(m_DepthExtent);
+	auto const       levelCount  = static_cast<uint32_t>(std::bit_width(std::max(firstExtent.width, firstExtent.height)));
+	if (levelCount > MAX_LEVEL_COUNT)
+		throw std::runtime_error("depth buffer too large for the depth pyramid");
+
+	vkc::Image image = vkc::ImageBuilder{ m_Context }
+					   .SetType(VK_IMAGE_TYPE_2D)
+					   .SetFormat(VK_FORMAT_R32_SFLOAT)
+					   .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
+					   .SetExtent(firstExtent)
+					   .SetMipLevels(levelCount)
+					   .Build(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, false);
+	m_Image = std::make_unique<vkc::Image>(std::move(image));
+	m_View  = std::make_unique<vkc::ImageView>(m_Image->CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D, 0, 1, 0, levelCount, false));
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkImage>(*m_Image)), VK_OBJECT_TYPE_IMAGE, "depth pyramid");
+
+	VkExtent2D extent = firstExtent;
+	m_Levels.reserve(levelCount);
+	for (uint32_t level{}; level < levelCount; ++level)
+	{
+		m_Levels.emplace_back(extent, m_Image->CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D, 0, 1, level, 1, false));
+		extent = HalveRoundingUp(extent);
+	}
+
+	for (uint32_t level{}; level < levelCount; ++level)
+	{
+		VkDescriptorImageInfo sourceInfo{};
+		sourceInfo.imageView   = level == 0 ? depthView : static_cast<VkImageView>(m_Levels[level - 1].View);
+		sourceInfo.imageLayout = level == 0 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+		VkDescriptorImageInfo destinationInfo{};
+		destinationInfo.imageView   = m_Levels[level].View;
+		destinationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		m_DescriptorSets[level]
+			.AddWriteDescriptor({ &sourceInfo, 1 }, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0, 0)
+			.AddWriteDescriptor({ &destinationInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, 0)
+			.Update(m_Context);
+	}
+}
+
+void DepthPyramid::Build(vkc::CommandBuffer const& commandBuffer, vkc::Image& depthImage)
+{
+	// depth image to read only optimal
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		depthImage.MakeTransition(m_Context, commandBuffer, transition);
+	}
+	// every level to general, the previous frame's occlusion tests may still be reading it
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_NONE;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_GENERAL;
+			transition.LevelCount    = GetLevelCount();
+		}
+		m_Image->MakeTransition(m_Context, commandBuffer, transition);
+	}
+
+	// each level reads the one written before it
+	VkMemoryBarrier2 levelBarrier{};
+	levelBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	levelBarrier.srcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	levelBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+	levelBarrier.dstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	levelBarrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType              = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.memoryBarrierCount = 1;
+	dependencyInfo.pMemoryBarriers    = &levelBarrier;
+
+	m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+	for (uint32_t level{}; level < GetLevelCount(); ++level)
+	{
+		VkDescriptorSet const descriptorSet = m_DescriptorSets[level];
+		m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
+													  , VK_PIPELINE_BIND_POINT_COMPUTE
+													  , m_PipelineLayout
+													  , 0
+													  , 1
+													  , &descriptorSet
+													  , 0
+													  , nullptr);
+		VkExtent2D const extent = m_Levels[level].Extent;
+		m_Context.DispatchTable.cmdDispatch(commandBuffer
+											, (extent.width + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE
+											, (extent.height + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE
+											, 1);
+		m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+
+	// depth image back to attachment optimal for the passes drawing after the occlusion tests
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_NONE;
+			transition.DstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		}
+		depthImage.MakeTransition(m_Context, commandBuffer, transition);
+	}
+}
+
+void DepthPyramid::DestroyImage()
+{
+	for (Level& level: m_Levels)
+		level.View.Destroy(m_Context);
+	m_Levels.clear();
+	if (m_View)
+		m_View->Destroy(m_Context);
+	if (m_Image)
+		m_Image->Destroy(m_Context);
+	m_View.reset();
+	m_Image.reset();
+}
+
+void DepthPyramid::CreatePipeline(vkc::PipelineCache& cache)
+{
+	m_Pipeline = help::CreateComputePipeline(m_Context, cache, m_PipelineLayout, "shaders/depth_pyramid.spv", "depth pyramid");
+}
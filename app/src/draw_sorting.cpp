@@ -0,0 +1,73 @@
+#include "draw_sorting.h"
+
+#include <array>
+#include <bit>
+#include <cassert>
+
+namespace
+{
+	uint32_t constexpr DIGIT_BITS{ 8 };
+	uint32_t constexpr RADIX{ 1u << DIGIT_BITS };
+	uint32_t constexpr PASS_COUNT{ 64 / DIGIT_BITS };
+
+	uint32_t GetDigit(uint64_t key, uint32_t pass)
+	{
+		return static_cast<uint32_t>(key >> pass * DIGIT_BITS) & (RADIX - 1);
+	}
+
+	// the bits of a non negative float order the same way its values do, the top half keeps the exponent and 7 bits
+	// of mantissa. negative and nan depths count as zero
+	uint64_t QuantizeDepth(float depth)
+	{
+		return std::bit_cast<uint32_t>(depth > 0.f ? depth : 0.f) >> 16;
+	}
+}
+
+uint64_t draw_sorting::MakeKey(Order order, uint16_t state, uint32_t material, float depth)
+{
+	uint64_t const stateBits = static_cast<uint64_t>(state) << 48;
+	switch (order)
+	{
+	case Order::FrontToBack:
+		return stateBits | QuantizeDepth(depth) << 32 | material;
+	case Order::MaterialMajor:
+		// only 16 bits sit between the state and the depth, a wider material would corrupt the state
+		assert(material < 65536 && "material does not fit the material major key");
+		return stateBits | (static_cast<uint64_t>(material) & 0xFFFF) << 16 | QuantizeDepth(depth);
+	case Order::Scene:
+		break;
+	}
+	return stateBits;
+}
+
+void draw_sorting::Sort(std::vector<Item>& items, std::vector<Item>& scratch)
+{
+	if (items.size() < 2)
+		return;
+
+	// the counts of every pass are gathered in one read of the keys
+	std::array<std::array<uint32_t, RADIX>, PASS_COUNT> histograms{};
+	for (Item const& item: items)
+		for (uint32_t pass{}; pass < PASS_COUNT; ++pass)
+			++histograms[pass][GetDigit(item.Key, pass)];
+
+	scratch.resize(items.size());
+	for (uint32_t pass{}; pass < PASS_COUNT; ++pass)
+	{
+		std::array<uint32_t, RADIX>& histogram = histograms[pass];
+		if (histogram[GetDigit(items.front().Key, pass)] == items.size())
+			continue;
+
+		// counts to the first position of each digit
+		uint32_t offset{};
+		for (uint32_t& count: histogram)
+		{
+			uint32_t const digitCount = count;
+			count                     = offset;
+			offset += digitCount;
+		}
+		for (Item const& item: items)
+			scratch[histogram[GetDigit(item.Key, pass)]++] = item;
+		items.swap(scratch);
+	}
+}
@@ -0,0 +1,152 @@
+#include "frustum_culling.h"
+
+#include <bit>
+#include <cfloat>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+	void AppendSetBits(uint32_t bits, uint32_t first, std::vector<uint32_t>& visible)
+	{
+		while (bits != 0)
+		{
+			visible.emplace_back(first + static_cast<uint32_t>(std::countr_zero(bits)));
+			bits &= bits - 1;
+		}
+	}
+#endif
+
+#if defined(__AVX__)
+	uint32_t constexpr WIDTH{ 8 };
+
+	// bits set for the spheres starting at first that are inside or intersect every plane
+	uint32_t TestBlock(frustum_culling::Planes const& planes, frustum_culling::Spheres const& spheres, uint32_t first)
+	{
+		__m256 const x              = _mm256_loadu_ps(spheres.GetX() + first);
+		__m256 const y              = _mm256_loadu_ps(spheres.GetY() + first);
+		__m256 const z              = _mm256_loadu_ps(spheres.GetZ() + first);
+		__m256 const negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.GetRadius() + first));
+		__m256       inside         = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (glm::vec4 const& plane: planes)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)), _mm256_mul_ps(y, _mm256_set1_ps(plane.y)));
+			distance        = _mm256_add_ps(distance, _mm256_mul_ps(z, _mm256_set1_ps(plane.z)));
+			distance        = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+			inside          = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+		return static_cast<uint32_t>(_mm256_movemask_ps(inside));
+	}
+#elif defined(__SSE2__) || defined(_M_X64)
+	uint32_t constexpr WIDTH{ 4 };
+
+	// bits set for the spheres starting at first that are inside or intersect every plane
+	uint32_t TestBlock(frustum_culling::Planes const& planes, frustum_culling::Spheres const& spheres, uint32_t first)
+	{
+		__m128 const x              = _mm_loadu_ps(spheres.GetX() + first);
+		__m128 const y              = _mm_loadu_ps(spheres.GetY() + first);
+		__m128 const z              = _mm_loadu_ps(spheres.GetZ() + first);
+		__m128 const negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.GetRadius() + first));
+		__m128       inside         = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (glm::vec4 const& plane: planes)
+		{
+			__m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y)));
+			distance        = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane.z)));
+			distance        = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+			inside          = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+		return static_cast<uint32_t>(_mm_movemask_ps(inside));
+	}
+#endif
+}
+
+frustum_culling::Planes frustum_culling::ExtractPlanes(glm::mat4 const& viewProjection)
+{
+	glm::mat4 const rows = glm::transpose(viewProjection);
+	Planes          planes
+	{
+		rows[3] + rows[0]
+		, rows[3] - rows[0]
+		, rows[3] + rows[1]
+		, rows[3] - rows[1]
+		, rows[2]
+		, rows[3] - rows[2]
+	};
+	for (glm::vec4& plane: planes)
+		plane /= glm::length(glm::vec3{ plane });
+	return planes;
+}
+
+void frustum_culling::Spheres::Add(glm::vec4 const& sphere)
+{
+	// the padding is overwritten in place, then a new block is appended once this one is full
+	if (m_Count == m_X.size())
+	{
+		m_X.resize(m_Count + BLOCK_SIZE, 0.f);
+		m_Y.resize(m_Count + BLOCK_SIZE, 0.f);
+		m_Z.resize(m_Count + BLOCK_SIZE, 0.f);
+		// no distance is ever at least FLT_MAX, so padding fails the first plane
+		m_Radius.resize(m_Count + BLOCK_SIZE, -FLT_MAX);
+	}
+	m_X[m_Count]      = sphere.x;
+	m_Y[m_Count]      = sphere.y;
+	m_Z[m_Count]      = sphere.z;
+	m_Radius[m_Count] = sphere.w;
+	++m_Count;
+}
+
+void frustum_culling::Spheres::Clear()
+{
+	m_X.clear();
+	m_Y.clear();
+	m_Z.clear();
+	m_Radius.clear();
+	m_Count = 0;
+}
+
+void frustum_culling::Cull(Planes const& planes, Spheres const& spheres, std::vector<uint32_t>& visible)
+{
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+	visible.clear();
+	visible.reserve(spheres.GetCount());
+	// BLOCK_SIZE is a multiple of WIDTH, so every load stays inside the padding
+	for (uint32_t first{}; first < spheres.GetPaddedCount(); first += WIDTH)
+		AppendSetBits(TestBlock(planes, spheres, first), first, visible);
+#else
+	CullScalar(planes, spheres, visible);
+#endif
+}
+
+void frustum_culling::CullScalar(Planes const& planes, Spheres const& spheres, std::vector<uint32_t>& visible)
+{
+	visible.clear();
+	visible.reserve(spheres.GetCount());
+	for (uint32_t index{}; index < spheres.GetCount(); ++index)
+	{
+		glm::vec3 const center{ spheres.GetX()[index], spheres.GetY()[index], spheres.GetZ()[index] };
+		float const     radius = spheres.GetRadius()[index];
+		bool            inside{ true };
+		for (glm::vec4 const& plane: planes)
+			if (glm::dot(glm::vec3{ plane }, center) + plane.w < -radius)
+			{
+				inside = false;
+				break;
+			}
+		if (inside)
+			visible.emplace_back(index);
+	}
+}
+
+char const* frustum_culling::GetInstructionSet()
+{
+#if defined(__AVX__)
+	return "AVX";
+#elif defined(__SSE2__) || defined(_M_X64)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
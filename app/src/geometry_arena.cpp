@@ -0,0 +1,132 @@
+#include "geometry_arena.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "datatypes.h"
+#include "helper.h"
+#include "uploader.h"
+
+namespace
+{
+	VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+GeometryArena::GeometryArena
+(
+	vkc::Context& context
+	, uint64_t    vertexCount
+	, uint64_t    shortIndexCount
+	, uint64_t    indexCount
+	, uint64_t    clusterCount
+)
+	: m_Context{ context }
+	, m_IndexSectionOffset{ AlignUp(shortIndexCount * sizeof(uint16_t), sizeof(uint32_t)) }
+	, m_VertexBuffer{ vkc::BufferBuilder{ context }
+					  .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+					  .Build(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+							 , std::max<VkDeviceSize>(vertexCount * sizeof(PackedVertex), sizeof(PackedVertex))) }
+	, m_IndexBuffer{ vkc::BufferBuilder{ context }
+					 .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+					 .Build(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+							, std::max<VkDeviceSize>(m_IndexSectionOffset + indexCount * sizeof(uint32_t), sizeof(uint32_t))) }
+	, m_ClusterBuffer{ vkc::BufferBuilder{ context }
+					   .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+					   .Build(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+							  , std::max<VkDeviceSize>(clusterCount * sizeof(Cluster), sizeof(Cluster))) }
+	, m_ClusterCapacity{ static_cast<uint32_t>(clusterCount) }
+{
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkBuffer>(m_VertexBuffer)), VK_OBJECT_TYPE_BUFFER, "geometry vertices");
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkBuffer>(m_IndexBuffer)), VK_OBJECT_TYPE_BUFFER, "geometry indices");
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkBuffer>(m_ClusterBuffer)), VK_OBJECT_TYPE_BUFFER, "geometry clusters");
+}
+
+GeometryArena::Range GeometryArena::Upload
+(
+	vkc::CommandBuffer const&        commandBuffer
+	, StagingRing::Allocation const& vertices
+	, StagingRing::Allocation const& indices
+	, VkIndexType                    indexType
+)
+{
+	bool const   isShort    = indexType == VK_INDEX_TYPE_UINT16;
+	size_t const indexSize  = isShort ? sizeof(uint16_t) : sizeof(uint32_t);
+	uint32_t&    indexCount = isShort ? m_ShortIndexCount : m_IndexCount;
+
+	VkDeviceSize const vertexOffset = m_VertexCount * sizeof(PackedVertex);
+	VkDeviceSize const indexOffset  = (isShort ? 0 : m_IndexSectionOffset) + indexCount * indexSize;
+	if (vertexOffset + vertices.Data.size() > m_VertexBuffer.GetSize() ||
+		indexOffset + indices.Data.size() > (isShort ? m_IndexSectionOffset : m_IndexBuffer.GetSize()))
+		throw std::runtime_error("geometry arena is full");
+
+	VkBufferCopy const vertexRegion{ vertices.Offset, vertexOffset, vertices.Data.size() };
+	VkBufferCopy const indexRegion{ indices.Offset, indexOffset, indices.Data.size() };
+	m_Context.DispatchTable.cmdCopyBuffer(commandBuffer, vertices.Buffer, m_VertexBuffer, 1, &vertexRegion);
+	m_Context.DispatchTable.cmdCopyBuffer(commandBuffer, indices.Buffer, m_IndexBuffer, 1, &indexRegion);
+
+	Range const range{ indexCount, static_cast<int32_t>(m_VertexCount) };
+	m_VertexCount += static_cast<uint32_t>(vertices.Data.size() / sizeof(PackedVertex));
+	indexCount += static_cast<uint32_t>(indices.Data.size() / indexSize);
+	return range;
+}
+
+void GeometryArena::UploadClusters(vkc::CommandBuffer const& commandBuffer, StagingRing::Allocation const& clusters)
+{
+	VkDeviceSize const offset = m_ClusterCount * sizeof(Cluster);
+	if (offset + clusters.Data.size() > m_ClusterBuffer.GetSize())
+		throw std::runtime_error("geometry arena is full");
+
+	VkBufferCopy const region{ clusters.Offset, offset, clusters.Data.size() };
+	m_Context.DispatchTable.cmdCopyBuffer(commandBuffer, clusters.Buffer, m_ClusterBuffer, 1, &region);
+	m_ClusterCount += static_cast<uint32_t>(clusters.Data.size() / sizeof(Cluster));
+}
+
+void GeometryArena::ReleaseWritten(Uploader& uploader)
+{
+	if (m_VertexCount > m_ReleasedVertexCount)
+		uploader.ReleaseBuffer(m_VertexBuffer
+							   , VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT
+							   , VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT
+							   , m_ReleasedVertexCount * sizeof(PackedVertex)
+							   , (m_VertexCount - m_ReleasedVertexCount) * sizeof(PackedVertex));
+	if (m_ShortIndexCount > m_ReleasedShortIndexCount)
+		uploader.ReleaseBuffer(m_IndexBuffer
+							   , VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT
+							   , VK_ACCESS_2_INDEX_READ_BIT
+							   , m_ReleasedShortIndexCount * sizeof(uint16_t)
+							   , (m_ShortIndexCount - m_ReleasedShortIndexCount) * sizeof(uint16_t));
+	if (m_IndexCount > m_ReleasedIndexCount)
+		uploader.ReleaseBuffer(m_IndexBuffer
+							   , VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT
+							   , VK_ACCESS_2_INDEX_READ_BIT
+							   , m_IndexSectionOffset + m_ReleasedIndexCount * sizeof(uint32_t)
+							   , (m_IndexCount - m_ReleasedIndexCount) * sizeof(uint32_t));
+	if (m_ClusterCount > m_ReleasedClusterCount)
+		uploader.ReleaseBuffer(m_ClusterBuffer
+							   , VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+							   , VK_ACCESS_2_SHADER_STORAGE_READ_BIT
+							   , m_ReleasedClusterCount * sizeof(Cluster)
+							   , (m_ClusterCount - m_ReleasedClusterCount) * sizeof(Cluster));
+
+	m_ReleasedVertexCount     = m_VertexCount;
+	m_ReleasedShortIndexCount = m_ShortIndexCount;
+	m_ReleasedIndexCount      = m_IndexCount;
+	m_ReleasedClusterCount    = m_ClusterCount;
+}
+
+void GeometryArena::BindVertexBuffer(VkCommandBuffer commandBuffer) const
+{
+	VkDeviceSize constexpr offsets[] = { {} };
+	m_Context.DispatchTable.cmdBindVertexBuffers(commandBuffer, 0, 1, m_VertexBuffer, offsets);
+}
+
+void GeometryArena::BindIndexBuffer(VkCommandBuffer commandBuffer, VkIndexType indexType) const
+{
+	m_Context.DispatchTable.cmdBindIndexBuffer(commandBuffer
+											   , m_IndexBuffer
+											   , indexType == VK_INDEX_TYPE_UINT16 ? 0 : m_IndexSectionOffset
+											   , indexType);
+}
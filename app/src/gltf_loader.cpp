@@ -0,0 +1,633 @@
+#include "gltf_loader.h"
+#include "json.h"
+#include "mapped_file.h"
+#include "startup_timeline.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+namespace
+{
+	uint32_t constexpr GLB_MAGIC{ 0x46546C67 };
+	uint32_t constexpr GLB_CHUNK_JSON{ 0x4E4F534A };
+	uint32_t constexpr GLB_CHUNK_BIN{ 0x004E4942 };
+
+	uint32_t constexpr MODE_TRIANGLES{ 4 };
+
+	uint32_t constexpr COMPONENT_BYTE{ 5120 };
+	uint32_t constexpr COMPONENT_UNSIGNED_BYTE{ 5121 };
+	uint32_t constexpr COMPONENT_SHORT{ 5122 };
+	uint32_t constexpr COMPONENT_UNSIGNED_SHORT{ 5123 };
+	uint32_t constexpr COMPONENT_UNSIGNED_INT{ 5125 };
+	uint32_t constexpr COMPONENT_FLOAT{ 5126 };
+
+	// the texture the Assimp import falls back to, shared so both paths produce the same texture table
+	char const* const MISSING_TEXTURE{ "200px-Debugempty.png" };
+
+	// the json and every buffer the accessors point into, mapped files are read in place
+	struct Document
+	{
+		MappedFile                              File;
+		json::Value                             Root;
+		std::vector<MappedFile>                 BufferFiles;
+		std::vector<std::vector<std::byte>>     DecodedBuffers;
+		std::vector<std::span<std::byte const>> Buffers;
+	};
+
+	// strided window into a buffer view, components are converted to float while they are read
+	struct AccessorView
+	{
+		std::byte const* Data;
+		size_t           Stride;
+		uint32_t         Count;
+		uint32_t         ComponentType;
+		uint32_t         ComponentCount;
+		bool             Normalized;
+	};
+
+	struct LoadContext
+	{
+		Document const&                           Gltf;
+		SourceScene&                              Scene;
+		std::unordered_map<std::string, uint32_t> TextureLookup;
+		uint32_t                                  SkippedPrimitives;
+	};
+
+	uint32_t GetComponentSize(uint32_t componentType)
+	{
+		switch (componentType)
+		{
+		case COMPONENT_BYTE:
+		case COMPONENT_UNSIGNED_BYTE:
+			return 1;
+		case COMPONENT_SHORT:
+		case COMPONENT_UNSIGNED_SHORT:
+			return 2;
+		case COMPONENT_UNSIGNED_INT:
+		case COMPONENT_FLOAT:
+			return 4;
+		default:
+			throw std::runtime_error("unknown glTF component type " + std::to_string(componentType));
+		}
+	}
+
+	uint32_t GetComponentCount(std::string const& type)
+	{
+		if (type == "SCALAR")
+			return 1;
+		if (type == "VEC2")
+			return 2;
+		if (type == "VEC3")
+			return 3;
+		if (type == "VEC4")
+			return 4;
+		if (type == "MAT4")
+			return 16;
+		throw std::runtime_error("unsupported glTF accessor type " + type);
+	}
+
+	std::string DecodeUri(std::string_view uri)
+	{
+		std::string decoded;
+		decoded.reserve(uri.size());
+		for (size_t index{}; index < uri.size(); ++index)
+			if (uri[index] == '%' && index + 2 < uri.size())
+			{
+				decoded += static_cast<char>(std::stoi(std::string{ uri.substr(index + 1, 2) }, nullptr, 16));
+				index += 2;
+			}
+			else
+				decoded += uri[index];
+		return decoded;
+	}
+
+	std::vector<std::byte> DecodeBase64(std::string_view text)
+	{
+		auto const decode = [](char character) -> uint32_t
+		{
+			if (character >= 'A' && character <= 'Z')
+				return character - 'A';
+			if (character >= 'a' && character <= 'z')
+				return character - 'a' + 26;
+			if (character >= '0' && character <= '9')
+				return character - '0' + 52;
+			if (character == '+' || character == '-')
+				return 62;
+			if (character == '/' || character == '_')
+				return 63;
+			throw std::runtime_error("invalid base64 in glTF data uri");
+		};
+
+		std::vector<std::byte> bytes;
+		bytes.reserve(text.size() / 4 * 3);
+		uint32_t bits{};
+		uint32_t bitCount{};
+		for (char const character: text)
+		{
+			if (character == '=')
+				break;
+			bits = bits << 6 | decode(character);
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				bytes.push_back(static_cast<std::byte>(bits >> bitCount & 0xFF));
+			}
+		}
+		return bytes;
+	}
+
+	void OpenBuffers(Document& document, std::filesystem::path const& directory, std::span<std::byte const> binaryChunk)
+	{
+		json::Value const* buffers = document.Root.Find("buffers");
+		if (!buffers)
+			return;
+
+		document.BufferFiles.reserve(buffers->GetArray().size());
+		document.DecodedBuffers.reserve(buffers->GetArray().size());
+		for (json::Value const& buffer: buffers->GetArray())
+		{
+			uint32_t const     byteLength = buffer["byteLength"].GetUint();
+			json::Value const* uri        = buffer.Find("uri");
+
+			std::span<std::byte const> data;
+			if (!uri)
+				data = binaryChunk;
+			else if (std::string const& string = uri->GetString();
+				string.starts_with("data:"))
+			{
+				size_t const comma = string.find(";base64,");
+				if (comma == std::string::npos)
+					throw std::runtime_error("glTF data uri is not base64 encoded");
+				data = document.DecodedBuffers.emplace_back(DecodeBase64(std::string_view{ string }.substr(comma + 8)));
+			}
+			else
+				data = document.BufferFiles.emplace_back((directory / DecodeUri(string)).string()).GetData();
+
+			if (data.size() < byteLength)
+				throw std::runtime_error("glTF buffer is shorter than its byteLength");
+			document.Buffers.emplace_back(data.first(byteLength));
+		}
+	}
+
+	Document Open(std::string_view filename)
+	{
+		startup_timeline::Scope const scope{ "Parse glTF" };
+		Document                      document{ MappedFile{ filename }, {}, {}, {}, {} };
+
+		std::span<std::byte const> const file = document.File.GetData();
+		std::string_view                 text{ reinterpret_cast<char const*>(file.data()), file.size() };
+		std::span<std::byte const>       binaryChunk;
+
+		// header, json chunk and an optional binary chunk, every chunk starts with its length and type
+		uint32_t magic{};
+		if (file.size() >= 12)
+			std::memcpy(&magic, file.data(), sizeof(magic));
+		if (magic == GLB_MAGIC)
+		{
+			size_t offset{ 12 };
+			text = {};
+			while (offset + 8 <= file.size())
+			{
+				uint32_t chunk[2];
+				std::memcpy(chunk, file.data() + offset, sizeof(chunk));
+				offset += 8;
+				if (offset + chunk[0] > file.size())
+					throw std::runtime_error("glb chunk exceeds the file " + std::string{ filename });
+
+				if (chunk[1] == GLB_CHUNK_JSON)
+					text = { reinterpret_cast<char const*>(file.data() + offset), chunk[0] };
+				else if (chunk[1] == GLB_CHUNK_BIN)
+					binaryChunk = file.subspan(offset, chunk[0]);
+				offset += chunk[0];
+			}
+		}
+
+		document.Root = json::Parse(text);
+		if (std::string const& version = document.Root["asset"]["version"].GetString();
+			!version.starts_with("2."))
+			throw std::runtime_error("unsupported glTF version " + version + " in " + std::string{ filename });
+
+		OpenBuffers(document, std::filesystem::path{ filename }.parent_path(), binaryChunk);
+		return document;
+	}
+
+	AccessorView GetAccessor(Document const& document, uint32_t index)
+	{
+		json::Value const& accessor = document.Root["accessors"][index];
+		if (accessor.Find("sparse"))
+			throw std::runtime_error("sparse glTF accessors are not supported");
+
+		AccessorView view{};
+		view.Count          = accessor["count"].GetUint();
+		view.ComponentType  = accessor["componentType"].GetUint();
+		view.ComponentCount = GetComponentCount(accessor["type"].GetString());
+		view.Normalized     = accessor.Find("normalized") && accessor["normalized"].GetBool();
+
+		size_t const elementSize = static_cast<size_t>(GetComponentSize(view.ComponentType)) * view.ComponentCount;
+		if (!accessor.Find("bufferView"))
+			throw std::runtime_error("glTF accessors without a buffer view are not supported");
+
+		json::Value const&               bufferView = document.Root["bufferViews"][accessor["bufferView"].GetUint()];
+		std::span<std::byte const> const buffer     = document.Buffers.at(bufferView["buffer"].GetUint());
+		size_t const                     offset     = bufferView.GetUint("byteOffset", 0) + accessor.GetUint("byteOffset", 0);
+
+		// tightly packed unless the view interleaves attributes
+		view.Stride = bufferView.GetUint("byteStride", static_cast<uint32_t>(elementSize));
+
+		if (view.Count > 0 && offset + view.Stride * (view.Count - 1) + elementSize > buffer.size())
+			throw std::runtime_error("glTF accessor " + std::to_string(index) + " exceeds its buffer");
+		view.Data = buffer.data() + offset;
+		return view;
+	}
+
+	float ReadComponent(AccessorView const& view, std::byte const* element, uint32_t component)
+	{
+		switch (view.ComponentType)
+		{
+		case COMPONENT_FLOAT:
+		{
+			float value;
+			std::memcpy(&value, element + component * sizeof(float), sizeof(value));
+			return value;
+		}
+		case COMPONENT_UNSIGNED_BYTE:
+		{
+			float const value = static_cast<float>(std::to_integer<uint8_t>(element[component]));
+			return view.Normalized ? value / 255.f : value;
+		}
+		case COMPONENT_BYTE:
+		{
+			float const value = static_cast<float>(static_cast<int8_t>(element[component]));
+			return view.Normalized ? std::max(value / 127.f, -1.f) : value;
+		}
+		case COMPONENT_UNSIGNED_SHORT:
+		{
+			uint16_t value;
+			std::memcpy(&value, element + component * sizeof(value), sizeof(value));
+			return view.Normalized ? static_cast<float>(value) / 65535.f : static_cast<float>(value);
+		}
+		case COMPONENT_SHORT:
+		{
+			int16_t value;
+			std::memcpy(&value, element + component * sizeof(value), sizeof(value));
+			return view.Normalized ? std::max(static_cast<float>(value) / 32767.f, -1.f) : static_cast<float>(value);
+		}
+		default:
+			throw std::runtime_error("glTF vertex attributes do not support component type " + std::to_string(view.ComponentType));
+		}
+	}
+
+	// float attributes, which is all Sponza stores, are copied as they are
+	template<glm::length_t N>
+	glm::vec<N, float> Read(AccessorView const& view, uint32_t index)
+	{
+		std::byte const*   element = view.Data + view.Stride * index;
+		glm::vec<N, float> value{};
+		if (view.ComponentType == COMPONENT_FLOAT && view.ComponentCount >= static_cast<uint32_t>(N))
+			std::memcpy(&value, element, sizeof(value));
+		else
+			for (glm::length_t component{}; component < std::min<glm::length_t>(N, view.ComponentCount); ++component)
+				value[component] = ReadComponent(view, element, component);
+		return value;
+	}
+
+	uint32_t ReadIndex(AccessorView const& view, uint32_t index)
+	{
+		std::byte const* element = view.Data + view.Stride * index;
+		switch (view.ComponentType)
+		{
+		case COMPONENT_UNSIGNED_BYTE:
+			return std::to_integer<uint32_t>(*element);
+		case COMPONENT_UNSIGNED_SHORT:
+		{
+			uint16_t value;
+			std::memcpy(&value, element, sizeof(value));
+			return value;
+		}
+		case COMPONENT_UNSIGNED_INT:
+		{
+			uint32_t value;
+			std::memcpy(&value, element, sizeof(value));
+			return value;
+		}
+		default:
+			throw std::runtime_error("invalid glTF index component type " + std::to_string(view.ComponentType));
+		}
+	}
+
+	glm::mat4 GetLocalTransform(json::Value const& node)
+	{
+		if (json::Value const* matrix = node.Find("matrix"))
+		{
+			std::array<float, 16> elements{};
+			for (size_t index{}; index < elements.size(); ++index)
+				elements[index] = static_cast<float>((*matrix)[index].GetNumber());
+			return glm::make_mat4(elements.data());
+		}
+
+		glm::vec3 translation{ .0f };
+		glm::quat rotation{ 1.f, .0f, .0f, .0f };
+		glm::vec3 scale{ 1.f };
+		if (json::Value const* value = node.Find("translation"))
+			for (glm::length_t index{}; index < 3; ++index)
+				translation[index] = static_cast<float>((*value)[index].GetNumber());
+		// stored as x, y, z, w
+		if (json::Value const* value = node.Find("rotation"))
+			rotation = glm::quat{
+				static_cast<float>((*value)[3].GetNumber())
+				, static_cast<float>((*value)[0].GetNumber())
+				, static_cast<float>((*value)[1].GetNumber())
+				, static_cast<float>((*value)[2].GetNumber())
+			};
+		if (json::Value const* value = node.Find("scale"))
+			for (glm::length_t index{}; index < 3; ++index)
+				scale[index] = static_cast<float>((*value)[index].GetNumber());
+
+		return glm::translate(glm::mat4{ 1.f }, translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4{ 1.f }, scale);
+	}
+
+	uint32_t AddTexture(LoadContext& context, json::Value const* textureInfo, TextureUsage usage)
+	{
+		std::string path{ MISSING_TEXTURE };
+		if (textureInfo)
+		{
+			json::Value const& texture = context.Gltf.Root["textures"][(*textureInfo)["index"].GetUint()];
+			if (json::Value const* source = texture.Find("source"))
+			{
+				json::Value const& image = context.Gltf.Root["images"][source->GetUint()];
+				// textures are processed from the texture directory, images embedded into buffers have no file there
+				if (json::Value const* uri = image.Find("uri");
+					uri && !uri->GetString().starts_with("data:"))
+					path = DecodeUri(uri->GetString());
+				else
+					std::cerr << "glTF image " << source->GetUint() << " is embedded, using the missing texture" << std::endl;
+			}
+		}
+
+		// keyed by usage as well, textures are processed per usage and glTF shares one image for metalness and roughness
+		std::string const key = path + '#' + std::to_string(static_cast<uint32_t>(usage));
+		if (auto const it = context.TextureLookup.find(key);
+			it != context.TextureLookup.end())
+			return it->second;
+
+		auto const index = static_cast<uint32_t>(context.Scene.Data.Textures.size());
+		context.Scene.Data.Textures.push_back(TextureEntry{ std::move(path), usage });
+		context.TextureLookup.emplace(key, index);
+		return index;
+	}
+
+	TextureIndices AddMaterial(LoadContext& context, json::Value const* material)
+	{
+		json::Value const* pbr               = material ? material->Find("pbrMetallicRoughness") : nullptr;
+		json::Value const* metallicRoughness = pbr ? pbr->Find("metallicRoughnessTexture") : nullptr;
+
+		TextureIndices textures{};
+		textures.Diffuse   = AddTexture(context, pbr ? pbr->Find("baseColorTexture") : nullptr, TextureUsage::Albedo);
+		textures.Normals   = AddTexture(context, material ? material->Find("normalTexture") : nullptr, TextureUsage::Normals);
+		textures.Metalness = AddTexture(context, metallicRoughness, TextureUsage::Metalness);
+		textures.Roughness = AddTexture(context, metallicRoughness, TextureUsage::Roughness);
+		return textures;
+	}
+
+	// area weighted smooth normals for primitives that come without them
+	void GenerateNormals(std::span<Vertex> vertices, std::span<uint32_t const> indices)
+	{
+		for (Vertex& vertex: vertices)
+			vertex.Normal = glm::vec3{ .0f };
+		for (size_t first{}; first + 2 < indices.size(); first += 3)
+		{
+			Vertex&         a      = vertices[indices[first]];
+			Vertex&         b      = vertices[indices[first + 1]];
+			Vertex&         c      = vertices[indices[first + 2]];
+			glm::vec3 const normal = glm::cross(b.Position - a.Position, c.Position - a.Position);
+			a.Normal += normal;
+			b.Normal += normal;
+			c.Normal += normal;
+		}
+		for (Vertex& vertex: vertices)
+			vertex.Normal = glm::length(vertex.Normal) > .0f ? glm::normalize(vertex.Normal) : glm::vec3{ .0f, 1.f, .0f };
+	}
+
+	// per triangle uv derivatives accumulated per vertex and orthogonalized against the normal,
+	// for primitives that come without tangents
+	void GenerateTangents(std::span<Vertex> vertices, std::span<uint32_t const> indices)
+	{
+		for (Vertex& vertex: vertices)
+		{
+			vertex.Tangent   = glm::vec3{ .0f };
+			vertex.Bitangent = glm::vec3{ .0f };
+		}
+		for (size_t first{}; first + 2 < indices.size(); first += 3)
+		{
+			Vertex&         a           = vertices[indices[first]];
+			Vertex&         b           = vertices[indices[first + 1]];
+			Vertex&         c           = vertices[indices[first + 2]];
+			glm::vec3 const edge0       = b.Position - a.Position;
+			glm::vec3 const edge1       = c.Position - a.Position;
+			glm::vec2 const delta0      = b.UV - a.UV;
+			glm::vec2 const delta1      = c.UV - a.UV;
+			float const     determinant = delta0.x * delta1.y - delta1.x * delta0.y;
+			if (std::abs(determinant) <= FLT_MIN)
+				continue;
+
+			glm::vec3 const tangent   = (edge0 * delta1.y - edge1 * delta0.y) / determinant;
+			glm::vec3 const bitangent = (edge1 * delta0.x - edge0 * delta1.x) / determinant;
+			for (Vertex* vertex: { &a, &b, &c })
+			{
+				vertex->Tangent += tangent;
+				vertex->Bitangent += bitangent;
+			}
+		}
+		for (Vertex& vertex: vertices)
+		{
+			glm::vec3 tangent = vertex.Tangent - vertex.Normal * glm::dot(vertex.Normal, vertex.Tangent);
+			if (glm::length(tangent) <= FLT_MIN)
+				tangent = glm::cross(vertex.Normal, std::abs(vertex.Normal.x) < .9f ? glm::vec3{ 1.f, .0f, .0f } : glm::vec3{ .0f, 1.f, .0f });
+			vertex.Tangent = glm::normalize(tangent);
+
+			float const sign = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < .0f ? -1.f : 1.f;
+			vertex.Bitangent = glm::cross(vertex.Normal, vertex.Tangent) * sign;
+		}
+	}
+
+	void AddPrimitive(LoadContext& context, json::Value const& primitive, glm::mat4 const& transform)
+	{
+		if (primitive.GetUint("mode", MODE_TRIANGLES) != MODE_TRIANGLES)
+		{
+			++context.SkippedPrimitives;
+			return;
+		}
+
+		SourceScene&       scene      = context.Scene;
+		json::Value const& attributes = primitive["attributes"];
+		AccessorView const positions  = GetAccessor(context.Gltf, attributes["POSITION"].GetUint());
+
+		std::optional<AccessorView> normals;
+		std::optional<AccessorView> tangents;
+		std::optional<AccessorView> uvs;
+		if (json::Value const* accessor = attributes.Find("NORMAL"))
+			normals = GetAccessor(context.Gltf, accessor->GetUint());
+		if (json::Value const* accessor = attributes.Find("TANGENT"))
+			tangents = GetAccessor(context.Gltf, accessor->GetUint());
+		if (json::Value const* accessor = attributes.Find("TEXCOORD_0"))
+			uvs = GetAccessor(context.Gltf, accessor->GetUint());
+
+		MeshRecord record{};
+		record.FirstVertex = static_cast<uint32_t>(scene.Vertices.size());
+		record.VertexCount = positions.Count;
+		record.FirstIndex  = static_cast<uint32_t>(scene.Data.Indices.size());
+
+		// normals follow the inverse transpose so non uniform scale keeps them perpendicular to the surface
+		glm::mat3 const linear       = glm::mat3{ transform };
+		glm::mat3 const normalMatrix = glm::transpose(glm::inverse(linear));
+
+		scene.Vertices.resize(scene.Vertices.size() + positions.Count);
+		std::span const vertices = std::span{ scene.Vertices }.subspan(record.FirstVertex, record.VertexCount);
+		for (uint32_t index{}; index < positions.Count; ++index)
+		{
+			Vertex& vertex  = vertices[index];
+			vertex.Position = glm::vec3{ transform * glm::vec4{ Read<3>(positions, index), 1.f } };
+			vertex.UV       = uvs ? Read<2>(*uvs, index) : glm::vec2{ .0f };
+			if (normals)
+				vertex.Normal = glm::normalize(normalMatrix * Read<3>(*normals, index));
+			// w holds the handedness of the bitangent
+			if (normals && tangents)
+			{
+				glm::vec4 const tangent = Read<4>(*tangents, index);
+				vertex.Tangent          = glm::normalize(linear * glm::vec3{ tangent });
+				vertex.Bitangent        = glm::cross(vertex.Normal, vertex.Tangent) * (tangent.w < .0f ? -1.f : 1.f);
+			}
+
+			scene.Data.AABBMin = glm::min(scene.Data.AABBMin, vertex.Position);
+			scene.Data.AABBMax = glm::max(scene.Data.AABBMax, vertex.Position);
+		}
+
+		if (json::Value const* accessor = primitive.Find("indices"))
+		{
+			AccessorView const indices = GetAccessor(context.Gltf, accessor->GetUint());
+			scene.Data.Indices.reserve(scene.Data.Indices.size() + indices.Count);
+			for (uint32_t index{}; index < indices.Count; ++index)
+				scene.Data.Indices.push_back(ReadIndex(indices, index));
+		}
+		else
+			for (uint32_t index{}; index < positions.Count; ++index)
+				scene.Data.Indices.push_back(index);
+		record.IndexCount = static_cast<uint32_t>(scene.Data.Indices.size()) - record.FirstIndex;
+
+		std::span const indices = std::span{ scene.Data.Indices }.subspan(record.FirstIndex, record.IndexCount);
+		if (std::ranges::any_of(indices
+								, [&record](uint32_t index)
+								{
+									return index >= record.VertexCount;
+								}))
+			throw std::runtime_error("glTF primitive indexes past its vertices");
+		if (!normals)
+			GenerateNormals(vertices, indices);
+		if (!normals || !tangents)
+			GenerateTangents(vertices, indices);
+
+		json::Value const* material = nullptr;
+		if (json::Value const* index = primitive.Find("material"))
+			material = &context.Gltf.Root["materials"][index->GetUint()];
+		record.Textures = AddMaterial(context, material);
+
+		scene.Data.Meshes.push_back(record);
+	}
+
+	void AddNode(LoadContext& context, uint32_t nodeIndex, glm::mat4 const& parentTransform, uint32_t depth)
+	{
+		// a cycle in the node graph would never end
+		if (depth > context.Gltf.Root["nodes"].GetArray().size())
+			throw std::runtime_error("glTF node hierarchy contains a cycle");
+
+		json::Value const& node      = context.Gltf.Root["nodes"][nodeIndex];
+		glm::mat4 const    transform = parentTransform * GetLocalTransform(node);
+		if (json::Value const* mesh = node.Find("mesh"))
+			for (json::Value const& primitive: context.Gltf.Root["meshes"][mesh->GetUint()]["primitives"].GetArray())
+				AddPrimitive(context, primitive, transform);
+		if (json::Value const* children = node.Find("children"))
+			for (json::Value const& child: children->GetArray())
+				AddNode(context, child.GetUint(), transform, depth + 1);
+	}
+
+	// the default scene's roots, or every node no other node parents when the file lists no scenes
+	std::vector<uint32_t> GetRootNodes(json::Value const& root)
+	{
+		std::vector<uint32_t> roots;
+		if (json::Value const* scenes = root.Find("scenes"))
+		{
+			json::Value const& scene = (*scenes)[root.GetUint("scene", 0)];
+			if (json::Value const* nodes = scene.Find("nodes"))
+				for (json::Value const& node: nodes->GetArray())
+					roots.push_back(node.GetUint());
+			return roots;
+		}
+
+		json::Value const* nodes = root.Find("nodes");
+		if (!nodes)
+			return roots;
+		std::vector<bool> isChild(nodes->GetArray().size());
+		for (json::Value const& node: nodes->GetArray())
+			if (json::Value const* children = node.Find("children"))
+				for (json::Value const& child: children->GetArray())
+					isChild.at(child.GetUint()) = true;
+		for (uint32_t index{}; index < isChild.size(); ++index)
+			if (!isChild[index])
+				roots.push_back(index);
+		return roots;
+	}
+}
+
+bool gltf_loader::CanLoad(std::string_view filename)
+{
+	std::string extension = std::filesystem::path{ filename }.extension().string();
+	std::ranges::transform(extension
+						   , extension.begin()
+						   , [](char character)
+						   {
+							   return static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+						   });
+	return extension == ".gltf" || extension == ".glb";
+}
+
+SourceScene gltf_loader::Load(std::string_view filename)
+{
+	Document const document = Open(filename);
+
+	SourceScene scene{};
+	if (json::Value const* materials = document.Root.Find("materials"))
+		scene.Data.ContainsPBRInfo = std::ranges::any_of(materials->GetArray()
+														 , [](json::Value const& material)
+														 {
+															 json::Value const* pbr = material.Find("pbrMetallicRoughness");
+															 return material.Find("normalTexture") && pbr &&
+																	pbr->Find("metallicRoughnessTexture");
+														 });
+
+	startup_timeline::Scope const conversion{ "Convert glTF accessors" };
+	LoadContext                   context{ document, scene, {}, 0 };
+	for (uint32_t const root: GetRootNodes(document.Root))
+		AddNode(context, root, glm::mat4{ 1.f }, 0);
+	conversion.AddItems(scene.Vertices.size(), "vertices");
+	conversion.AddBytes(scene.Vertices.size() * sizeof(Vertex) + scene.Data.Indices.size() * sizeof(uint32_t));
+
+	if (context.SkippedPrimitives > 0)
+		std::cerr << context.SkippedPrimitives << " glTF primitives are not triangle lists and were skipped" << std::endl;
+	if (scene.Data.Meshes.empty())
+		throw std::runtime_error("glTF file contains no triangle meshes " + std::string{ filename });
+	return scene;
+}
@@ -2,16 +2,49 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
 help::ImageData::~ImageData()
 {
 	stbi_image_free(Pixels);
 }
 
+help::ImageData::ImageData(ImageData&& other) noexcept
+	: Width{ other.Width }
+	, Height{ other.Height }
+	, Channels{ other.Channels }
+	, Pixels{ std::exchange(other.Pixels, nullptr) }
+	, Size{ std::exchange(other.Size, 0) } {}
+
+help::ImageData& help::ImageData::operator=(ImageData&& other) noexcept
+{
+	if (this != &other)
+	{
+		stbi_image_free(Pixels);
+		Width    = other.Width;
+		Height   = other.Height;
+		Channels = other.Channels;
+		Pixels   = std::exchange(other.Pixels, nullptr);
+		Size     = std::exchange(other.Size, 0);
+	}
+	return *this;
+}
+
 help::ImageData help::LoadImage(std::string_view path)
 {
 	ImageData data{};
 
-	data.Pixels = stbi_load(path.data(), &data.Width, &data.Height, &data.Channels, STBI_rgb_alpha);
+	// decoded straight out of the mapping instead of through stdio reads
+	MappedFile const                 file{ path };
+	std::span<std::byte const> const encoded = file.GetData();
+	data.Pixels                               = stbi_load_from_memory(reinterpret_cast<stbi_uc const*>(encoded.data())
+																	  , static_cast<int>(encoded.size())
+																	  , &data.Width
+																	  , &data.Height
+																	  , &data.Channels
+																	  , STBI_rgb_alpha);
 	data.Size   = static_cast<VkDeviceSize>(data.Width) * data.Height * 4;
 
 	if (!data.Pixels)
@@ -19,3 +52,99 @@ help::ImageData help::LoadImage(std::string_view path)
 
 	return data;
 }
+
+help::MappedBuffer help::CreateMappedBuffer
+(
+	vkc::Context const&  context
+	, VkDeviceSize       size
+	, VkBufferUsageFlags usage
+	, std::string const& name
+)
+{
+	MappedBuffer mapped{};
+
+	VkBufferCreateInfo createInfo{};
+	createInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	createInfo.size        = size;
+	createInfo.usage       = usage;
+	createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (context.DispatchTable.createBuffer(&createInfo, nullptr, &mapped.Buffer) != VK_SUCCESS)
+		throw std::runtime_error("failed to create " + name + " buffer");
+
+	VkMemoryRequirements requirements{};
+	context.DispatchTable.getBufferMemoryRequirements(mapped.Buffer, &requirements);
+
+	VkMemoryAllocateInfo allocateInfo{};
+	allocateInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize  = requirements.size;
+	allocateInfo.memoryTypeIndex = FindMemoryType(context
+												  , requirements.memoryTypeBits
+												  , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	if (context.DispatchTable.allocateMemory(&allocateInfo, nullptr, &mapped.Memory) != VK_SUCCESS)
+		throw std::runtime_error("failed to allocate " + name + " memory");
+	if (context.DispatchTable.bindBufferMemory(mapped.Buffer, mapped.Memory, 0) != VK_SUCCESS)
+		throw std::runtime_error("failed to bind " + name + " memory");
+	if (context.DispatchTable.mapMemory(mapped.Memory, 0, VK_WHOLE_SIZE, 0, &mapped.Data) != VK_SUCCESS)
+		throw std::runtime_error("failed to map " + name + " memory");
+	std::memset(mapped.Data, 0, size);
+
+	NameObject(context, reinterpret_cast<uint64_t>(mapped.Buffer), VK_OBJECT_TYPE_BUFFER, name);
+	return mapped;
+}
+
+void help::DestroyMappedBuffer(vkc::Context const& context, MappedBuffer const& buffer)
+{
+	context.DispatchTable.unmapMemory(buffer.Memory);
+	context.DispatchTable.destroyBuffer(buffer.Buffer, nullptr);
+	context.DispatchTable.freeMemory(buffer.Memory, nullptr);
+}
+
+void help::CreateComputePipelines
+(
+	vkc::Context const&                     context
+	, VkPipelineCache                       cache
+	, VkPipelineLayout                      layout
+	, std::string const&                    shaderPath
+	, std::span<VkSpecializationInfo const> specializations
+	, std::span<std::string_view const>     names
+	, std::span<VkPipeline>                 outPipelines
+)
+{
+	// the module is created straight from the mapping, which is page aligned
+	MappedFile const                shader{ shaderPath };
+	std::span<uint32_t const> const code = shader.GetView<uint32_t>(0, shader.GetSize() / sizeof(uint32_t));
+
+	VkShaderModuleCreateInfo moduleInfo{};
+	moduleInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	moduleInfo.codeSize = code.size_bytes();
+	moduleInfo.pCode    = code.data();
+
+	VkShaderModule shaderModule{};
+	if (context.DispatchTable.createShaderModule(&moduleInfo, nullptr, &shaderModule) != VK_SUCCESS)
+		throw std::runtime_error("failed to create shader module from " + shaderPath);
+
+	std::vector<VkComputePipelineCreateInfo> createInfos(specializations.size());
+	for (size_t index{}; index < createInfos.size(); ++index)
+	{
+		VkComputePipelineCreateInfo& createInfo = createInfos[index];
+		createInfo.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		createInfo.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		createInfo.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+		createInfo.stage.module              = shaderModule;
+		createInfo.stage.pName               = "main";
+		createInfo.stage.pSpecializationInfo = &specializations[index];
+		createInfo.layout                    = layout;
+	}
+
+	VkResult const result = context.DispatchTable.createComputePipelines(cache
+																		 , static_cast<uint32_t>(createInfos.size())
+																		 , createInfos.data()
+																		 , nullptr
+																		 , outPipelines.data());
+	context.DispatchTable.destroyShaderModule(shaderModule, nullptr);
+	if (result != VK_SUCCESS)
+		throw std::runtime_error("failed to create " + std::string{ names.front() } + " pipeline");
+
+	for (size_t index{}; index < outPipelines.size(); ++index)
+		NameObject(context, reinterpret_cast<uint64_t>(outPipelines[index]), VK_OBJECT_TYPE_PIPELINE, names[index]);
+}
@@ -0,0 +1,346 @@
+#include "json.h"
+
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+namespace
+{
+	class Parser final
+	{
+	public:
+		explicit Parser(std::string_view text)
+			: m_Text{ text } {}
+
+		json::Value ParseDocument()
+		{
+			json::Value value = ParseValue();
+			SkipWhitespace();
+			if (m_Position != m_Text.size())
+				Fail("trailing characters");
+			return value;
+		}
+
+	private:
+		// documents nested deeper than this are not scene descriptions
+		static size_t constexpr MAX_DEPTH{ 256 };
+
+		[[noreturn]] void Fail(std::string_view reason) const
+		{
+			throw std::runtime_error("malformed json at byte " + std::to_string(m_Position) + ": " + std::string{ reason });
+		}
+
+		void SkipWhitespace()
+		{
+			while (m_Position < m_Text.size() &&
+				   (m_Text[m_Position] == ' ' || m_Text[m_Position] == '\t' || m_Text[m_Position] == '\n' || m_Text[m_Position] == '\r'))
+				++m_Position;
+		}
+
+		char Peek()
+		{
+			SkipWhitespace();
+			if (m_Position == m_Text.size())
+				Fail("unexpected end");
+			return m_Text[m_Position];
+		}
+
+		void Expect(char character)
+		{
+			if (Peek() != character)
+				Fail(std::string{ "expected " } + character);
+			++m_Position;
+		}
+
+		bool Consume(std::string_view literal)
+		{
+			if (m_Text.substr(m_Position, literal.size()) != literal)
+				return false;
+			m_Position += literal.size();
+			return true;
+		}
+
+		json::Value ParseValue()
+		{
+			if (++m_Depth > MAX_DEPTH)
+				Fail("nested too deep");
+
+			json::Value value;
+			switch (Peek())
+			{
+			case '{':
+				value = ParseObject();
+				break;
+			case '[':
+				value = ParseArray();
+				break;
+			case '"':
+				value = json::Value{ ParseString() };
+				break;
+			case 't':
+			case 'f':
+			case 'n':
+				if (Consume("true"))
+					value = json::Value{ true };
+				else if (Consume("false"))
+					value = json::Value{ false };
+				else if (!Consume("null"))
+					Fail("unknown literal");
+				break;
+			default:
+				value = json::Value{ ParseNumber() };
+				break;
+			}
+
+			--m_Depth;
+			return value;
+		}
+
+		json::Value ParseObject()
+		{
+			Expect('{');
+			json::Value::Object object;
+			if (Peek() == '}')
+			{
+				++m_Position;
+				return json::Value{ std::move(object) };
+			}
+			while (true)
+			{
+				if (Peek() != '"')
+					Fail("expected member name");
+				std::string key = ParseString();
+				Expect(':');
+				object.emplace_back(std::move(key), ParseValue());
+				if (Peek() == '}')
+				{
+					++m_Position;
+					return json::Value{ std::move(object) };
+				}
+				Expect(',');
+			}
+		}
+
+		json::Value ParseArray()
+		{
+			Expect('[');
+			json::Value::Array array;
+			if (Peek() == ']')
+			{
+				++m_Position;
+				return json::Value{ std::move(array) };
+			}
+			while (true)
+			{
+				array.emplace_back(ParseValue());
+				if (Peek() == ']')
+				{
+					++m_Position;
+					return json::Value{ std::move(array) };
+				}
+				Expect(',');
+			}
+		}
+
+		uint32_t ParseHex()
+		{
+			if (m_Position + 4 > m_Text.size())
+				Fail("truncated escape");
+			uint32_t   code{};
+			auto const result = std::from_chars(m_Text.data() + m_Position, m_Text.data() + m_Position + 4, code, 16);
+			if (result.ec != std::errc{} || result.ptr != m_Text.data() + m_Position + 4)
+				Fail("invalid escape");
+			m_Position += 4;
+			return code;
+		}
+
+		static void AppendUtf8(std::string& string, uint32_t code)
+		{
+			if (code < 0x80)
+				string += static_cast<char>(code);
+			else if (code < 0x800)
+			{
+				string += static_cast<char>(0xC0 | code >> 6);
+				string += static_cast<char>(0x80 | (code & 0x3F));
+			}
+			else if (code < 0x10000)
+			{
+				string += static_cast<char>(0xE0 | code >> 12);
+				string += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+				string += static_cast<char>(0x80 | (code & 0x3F));
+			}
+			else
+			{
+				string += static_cast<char>(0xF0 | code >> 18);
+				string += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+				string += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+				string += static_cast<char>(0x80 | (code & 0x3F));
+			}
+		}
+
+		std::string ParseString()
+		{
+			Expect('"');
+			std::string string;
+			while (true)
+			{
+				// runs without escapes are copied in one go
+				size_t const end = m_Text.find_first_of("\"\\", m_Position);
+				if (end == std::string_view::npos)
+					Fail("unterminated string");
+				string.append(m_Text.substr(m_Position, end - m_Position));
+				m_Position = end + 1;
+				if (m_Text[end] == '"')
+					return string;
+
+				if (m_Position == m_Text.size())
+					Fail("unterminated string");
+				switch (m_Text[m_Position++])
+				{
+				case '"':
+					string += '"';
+					break;
+				case '\\':
+					string += '\\';
+					break;
+				case '/':
+					string += '/';
+					break;
+				case 'b':
+					string += '\b';
+					break;
+				case 'f':
+					string += '\f';
+					break;
+				case 'n':
+					string += '\n';
+					break;
+				case 'r':
+					string += '\r';
+					break;
+				case 't':
+					string += '\t';
+					break;
+				case 'u':
+				{
+					uint32_t code = ParseHex();
+					// characters outside the basic plane arrive as a surrogate pair
+					if (code >= 0xD800 && code < 0xDC00 && Consume("\\u"))
+						code = 0x10000 + ((code - 0xD800) << 10) + (ParseHex() - 0xDC00);
+					AppendUtf8(string, code);
+					break;
+				}
+				default:
+					Fail("invalid escape");
+				}
+			}
+		}
+
+		double ParseNumber()
+		{
+			size_t const start = m_Position;
+			while (m_Position < m_Text.size() &&
+				   (std::isdigit(static_cast<unsigned char>(m_Text[m_Position])) || m_Text[m_Position] == '-' ||
+					m_Text[m_Position] == '+' || m_Text[m_Position] == '.' || m_Text[m_Position] == 'e' || m_Text[m_Position] == 'E'))
+				++m_Position;
+
+			double     number{};
+			auto const result = std::from_chars(m_Text.data() + start, m_Text.data() + m_Position, number);
+			if (start == m_Position || result.ec != std::errc{} || result.ptr != m_Text.data() + m_Position)
+			{
+				m_Position = start;
+				Fail("invalid number");
+			}
+			return number;
+		}
+
+		std::string_view m_Text;
+		size_t           m_Position{};
+		size_t           m_Depth{};
+	};
+
+	template<typename T>
+	T const& Get(std::variant<std::monostate, bool, double, std::string, json::Value::Array, json::Value::Object> const& value
+				 , char const* expected)
+	{
+		if (T const* result = std::get_if<T>(&value))
+			return *result;
+		throw std::runtime_error(std::string{ "json value is not " } + expected);
+	}
+}
+
+bool json::Value::GetBool() const
+{
+	return Get<bool>(m_Value, "a bool");
+}
+
+double json::Value::GetNumber() const
+{
+	return Get<double>(m_Value, "a number");
+}
+
+uint32_t json::Value::GetUint() const
+{
+	double const number = GetNumber();
+	if (number < 0 || number > UINT32_MAX || number != static_cast<double>(static_cast<uint32_t>(number)))
+		throw std::runtime_error("json number is not an unsigned integer");
+	return static_cast<uint32_t>(number);
+}
+
+std::string const& json::Value::GetString() const
+{
+	return Get<std::string>(m_Value, "a string");
+}
+
+json::Value::Array const& json::Value::GetArray() const
+{
+	return Get<Array>(m_Value, "an array");
+}
+
+json::Value::Object const& json::Value::GetObject() const
+{
+	return Get<Object>(m_Value, "an object");
+}
+
+json::Value const* json::Value::Find(std::string_view key) const
+{
+	Object const* object = std::get_if<Object>(&m_Value);
+	if (!object)
+		return nullptr;
+	for (auto const& [name, value]: *object)
+		if (name == key)
+			return &value;
+	return nullptr;
+}
+
+json::Value const& json::Value::operator[](std::string_view key) const
+{
+	if (Value const* value = Find(key))
+		return *value;
+	throw std::runtime_error("json object has no member " + std::string{ key });
+}
+
+json::Value const& json::Value::operator[](size_t index) const
+{
+	Array const& array = GetArray();
+	if (index >= array.size())
+		throw std::runtime_error("json array index " + std::to_string(index) + " is out of bounds");
+	return array[index];
+}
+
+uint32_t json::Value::GetUint(std::string_view key, uint32_t fallback) const
+{
+	Value const* value = Find(key);
+	return value ? value->GetUint() : fallback;
+}
+
+double json::Value::GetNumber(std::string_view key, double fallback) const
+{
+	Value const* value = Find(key);
+	return value ? value->GetNumber() : fallback;
+}
+
+json::Value json::Parse(std::string_view text)
+{
+	return Parser{ text }.ParseDocument();
+}
@@ -0,0 +1,216 @@
+#include "ktx2.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "block_compression.h"
+#include "mapped_file.h"
+
+namespace
+{
+	unsigned char constexpr IDENTIFIER[12]{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	struct Header
+	{
+		unsigned char Identifier[12];
+		uint32_t      Format;
+		uint32_t      TypeSize;
+		uint32_t      PixelWidth;
+		uint32_t      PixelHeight;
+		uint32_t      PixelDepth;
+		uint32_t      LayerCount;
+		uint32_t      FaceCount;
+		uint32_t      LevelCount;
+		uint32_t      SupercompressionScheme;
+		uint32_t      DFDByteOffset;
+		uint32_t      DFDByteLength;
+		uint32_t      KVDByteOffset;
+		uint32_t      KVDByteLength;
+		uint64_t      SGDByteOffset;
+		uint64_t      SGDByteLength;
+	};
+
+	struct LevelIndex
+	{
+		uint64_t ByteOffset;
+		uint64_t ByteLength;
+		uint64_t UncompressedByteLength;
+	};
+
+	static_assert(sizeof(Header) == 80);
+	static_assert(sizeof(LevelIndex) == 24);
+
+	// values from the Khronos data format specification
+	uint32_t constexpr KHR_DF_MODEL_BC4{ 131 };
+	uint32_t constexpr KHR_DF_MODEL_BC5{ 132 };
+	uint32_t constexpr KHR_DF_MODEL_BC7{ 134 };
+	uint32_t constexpr KHR_DF_PRIMARIES_BT709{ 1 };
+	uint32_t constexpr KHR_DF_TRANSFER_LINEAR{ 1 };
+	uint32_t constexpr KHR_DF_TRANSFER_SRGB{ 2 };
+
+	// data format descriptor with a single basic block, one sample per stored channel
+	std::vector<uint32_t> BuildDFD(VkFormat format)
+	{
+		uint32_t model{};
+		uint32_t sampleCount{ 1 };
+		uint32_t transfer{ KHR_DF_TRANSFER_LINEAR };
+		switch (format)
+		{
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			model = KHR_DF_MODEL_BC4;
+			break;
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+			model       = KHR_DF_MODEL_BC5;
+			sampleCount = 2;
+			break;
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			transfer = KHR_DF_TRANSFER_SRGB;
+			[[fallthrough]];
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+			model = KHR_DF_MODEL_BC7;
+			break;
+		default:
+			throw std::runtime_error("unsupported KTX2 format " + std::to_string(format));
+		}
+
+		uint32_t const blockSize           = ktx2::GetBlockSize(format);
+		uint32_t const bitsPerSample       = blockSize * 8 / sampleCount;
+		uint32_t const descriptorBlockSize = 24 + 16 * sampleCount;
+
+		std::vector<uint32_t> dfd;
+		dfd.emplace_back(4 + descriptorBlockSize);
+		dfd.emplace_back(0); // vendor and descriptor type
+		dfd.emplace_back(2 | descriptorBlockSize << 16);
+		dfd.emplace_back(model | KHR_DF_PRIMARIES_BT709 << 8 | transfer << 16);
+		dfd.emplace_back(3 | 3 << 8); // 4x4 texel blocks
+		dfd.emplace_back(blockSize);
+		dfd.emplace_back(0);
+		for (uint32_t sample{}; sample < sampleCount; ++sample)
+		{
+			dfd.emplace_back(sample * bitsPerSample | (bitsPerSample - 1) << 16 | sample << 24);
+			dfd.emplace_back(0);
+			dfd.emplace_back(0);
+			dfd.emplace_back(UINT32_MAX);
+		}
+		return dfd;
+	}
+
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+uint32_t ktx2::GetBlockSize(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+		return 8;
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return 16;
+	default:
+		throw std::runtime_error("unsupported KTX2 format " + std::to_string(format));
+	}
+}
+
+void ktx2::Write(std::string_view path, Texture const& texture)
+{
+	std::vector<uint32_t> const dfd        = BuildDFD(texture.Format);
+	uint32_t const              blockSize  = GetBlockSize(texture.Format);
+	auto const                  levelCount = static_cast<uint32_t>(texture.Chain.Levels.size());
+
+	Header header{};
+	std::memcpy(header.Identifier, IDENTIFIER, sizeof(IDENTIFIER));
+	header.Format        = texture.Format;
+	header.TypeSize      = 1;
+	header.PixelWidth    = texture.Chain.Levels[0].Width;
+	header.PixelHeight   = texture.Chain.Levels[0].Height;
+	header.FaceCount     = 1;
+	header.LevelCount    = levelCount;
+	header.DFDByteOffset = static_cast<uint32_t>(sizeof(Header) + sizeof(LevelIndex) * levelCount);
+	header.DFDByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+	// level data is stored smallest mip first, each level aligned to the block size
+	std::vector<LevelIndex> levels(levelCount);
+	uint64_t                offset = header.DFDByteOffset + header.DFDByteLength;
+	for (uint32_t level = levelCount; level-- > 0;)
+	{
+		offset                               = AlignUp(offset, blockSize);
+		levels[level].ByteOffset             = offset;
+		levels[level].ByteLength             = texture.Chain.Levels[level].Size;
+		levels[level].UncompressedByteLength = texture.Chain.Levels[level].Size;
+		offset += texture.Chain.Levels[level].Size;
+	}
+
+	std::ofstream file{ std::string{ path }, std::ios::binary | std::ios::out | std::ios::trunc };
+	if (!file.is_open())
+		throw std::runtime_error("failed to open " + std::string{ path } + " for writing");
+
+	file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+	file.write(reinterpret_cast<char const*>(levels.data()), static_cast<std::streamsize>(levels.size() * sizeof(LevelIndex)));
+	file.write(reinterpret_cast<char const*>(dfd.data()), header.DFDByteLength);
+	for (uint32_t level = levelCount; level-- > 0;)
+	{
+		static char constexpr zeros[16]{};
+		auto const position = static_cast<uint64_t>(file.tellp());
+		file.write(zeros, static_cast<std::streamsize>(levels[level].ByteOffset - position));
+		file.write(reinterpret_cast<char const*>(texture.Chain.Pixels.data() + texture.Chain.Levels[level].Offset)
+				   , static_cast<std::streamsize>(levels[level].ByteLength));
+	}
+
+	if (!file)
+		throw std::runtime_error("failed to write " + std::string{ path });
+}
+
+ktx2::MappedTexture ktx2::Open(std::string_view path)
+{
+	MappedTexture texture{};
+	texture.File = MappedFile{ path };
+	if (texture.File.GetSize() < sizeof(Header))
+		throw std::runtime_error(std::string{ path } + " is truncated");
+
+	Header const& header = texture.File.GetView<Header>(0, 1)[0];
+	if (std::memcmp(header.Identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+		throw std::runtime_error(std::string{ path } + " is not a KTX2 file");
+	if (header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1 || header.LevelCount == 0 ||
+		header.SupercompressionScheme != 0)
+		throw std::runtime_error(std::string{ path } + " has an unsupported layout");
+
+	texture.Format = static_cast<VkFormat>(header.Format);
+
+	uint32_t const  blockSize = GetBlockSize(texture.Format);
+	std::span const levels    = texture.File.GetView<LevelIndex>(sizeof(Header), header.LevelCount);
+	uint64_t        totalSize{};
+	for (uint32_t level{}; level < header.LevelCount; ++level)
+	{
+		uint32_t const width  = std::max(header.PixelWidth >> level, 1u);
+		uint32_t const height = std::max(header.PixelHeight >> level, 1u);
+		uint64_t const size   = block_compression::CalculateSize(width, height, blockSize);
+		if (levels[level].ByteLength != size || levels[level].ByteOffset + size > texture.File.GetSize())
+			throw std::runtime_error(std::string{ path } + " has a corrupted level index");
+
+		texture.Levels.emplace_back(texture_mips::Level{ width, height, totalSize, size });
+		texture.FileOffsets.emplace_back(levels[level].ByteOffset);
+		totalSize += size;
+	}
+	return texture;
+}
+
+void ktx2::CopyLevels(MappedTexture const& texture, uint32_t firstLevel, std::span<std::byte> destination)
+{
+	std::span const data       = texture.File.GetData();
+	uint64_t const  baseOffset = texture.Levels[firstLevel].Offset;
+	for (size_t level{ firstLevel }; level < texture.Levels.size(); ++level)
+	{
+		texture_mips::Level const& layout = texture.Levels[level];
+		if (layout.Offset - baseOffset + layout.Size > destination.size())
+			throw std::runtime_error("texture level does not fit the destination");
+		std::memcpy(destination.data() + layout.Offset - baseOffset, data.data() + texture.FileOffsets[level], layout.Size);
+	}
+}
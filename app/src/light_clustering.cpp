@@ -0,0 +1,196 @@
+#include "light_clustering.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "pipeline_cache.h"
+
+namespace
+{
+	uint32_t constexpr WORKGROUP_SIZE{ 128 };
+
+	// assigned lights, most lights in a cluster and overflowing clusters
+	uint32_t constexpr STATISTICS_COUNT{ 3 };
+}
+
+LightClusterer::LightClusterer(vkc::Context& context, std::span<VkBuffer const> cameraBuffers, vkc::PipelineCache& cache)
+	: m_Context{ context }
+	, m_FrameCount{ static_cast<uint32_t>(cameraBuffers.size()) }
+	, m_LightCounts(cameraBuffers.size())
+	, m_LightGridBuffer{ vkc::BufferBuilder{ context }
+						 .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+						 .Build(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, static_cast<VkDeviceSize>(CLUSTER_COUNT) * sizeof(uint32_t)) }
+	, m_LightIndexBuffer{ vkc::BufferBuilder{ context }
+						  .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+						  .Build(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+								 , static_cast<VkDeviceSize>(CLUSTER_COUNT) * MAX_LIGHTS_PER_CLUSTER * sizeof(uint32_t)) }
+	, m_DescriptorSetLayout{ vkc::DescriptorSetLayoutBuilder{ context }
+							 .AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+							 .Build() }
+	, m_LightingDescriptorSetLayout{ vkc::DescriptorSetLayoutBuilder{ context }
+									 .AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+									 .AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+									 .AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+									 .Build() }
+	// camera, lights, grid, indices and statistics for the build, lights, grid and indices for the lighting pass
+	, m_DescriptorPool{ vkc::DescriptorPoolBuilder{ context }
+						.AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_FrameCount)
+						.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_FrameCount * 7)
+						.Build(m_FrameCount * 2) }
+	, m_PipelineLayout{ vkc::PipelineLayoutBuilder{ context }
+						.AddDescriptorSetLayout(m_DescriptorSetLayout)
+						.AddPushConstant(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants))
+						.Build() }
+{
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkBuffer>(m_LightGridBuffer)), VK_OBJECT_TYPE_BUFFER, "light grid");
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(static_cast<VkBuffer>(m_LightIndexBuffer)), VK_OBJECT_TYPE_BUFFER, "light indices");
+	for (uint32_t frame{}; frame < m_FrameCount; ++frame)
+		m_Lights.emplace_back(help::CreateMappedBuffer(m_Context
+													   , static_cast<VkDeviceSize>(MAX_LIGHT_COUNT) * sizeof(PointLight)
+													   , VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+													   , "clustered point lights"));
+	m_Statistics = help::CreateMappedBuffer(m_Context
+											, STATISTICS_COUNT * sizeof(uint32_t)
+											, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+											, "light clustering statistics");
+	CreatePipeline(cache);
+
+	std::vector<VkDescriptorSetLayout> const layouts(m_FrameCount, m_DescriptorSetLayout);
+	std::vector<VkDescriptorSetLayout> const lightingLayouts(m_FrameCount, m_LightingDescriptorSetLayout);
+	m_DescriptorSets         = vkc::DescriptorSetBuilder{ m_Context }.Build(m_DescriptorPool, layouts);
+	m_LightingDescriptorSets = vkc::DescriptorSetBuilder{ m_Context }.Build(m_DescriptorPool, lightingLayouts);
+
+	VkDescriptorBufferInfo const gridInfo{ m_LightGridBuffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const indexInfo{ m_LightIndexBuffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo const statisticsInfo{ m_Statistics.Buffer, 0, VK_WHOLE_SIZE };
+	for (uint32_t frame{}; frame < m_FrameCount; ++frame)
+	{
+		VkDescriptorBufferInfo const cameraInfo{ cameraBuffers[frame], 0, VK_WHOLE_SIZE };
+		VkDescriptorBufferInfo const lightInfo{ m_Lights[frame].Buffer, 0, VK_WHOLE_SIZE };
+		m_DescriptorSets[frame]
+			.AddWriteDescriptor({ &cameraInfo, 1 }, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, 0)
+			.AddWriteDescriptor({ &lightInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, 0)
+			.AddWriteDescriptor({ &gridInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, 0)
+			.AddWriteDescriptor({ &indexInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3, 0)
+			.AddWriteDescriptor({ &statisticsInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4, 0)
+			.Update(m_Context);
+		m_LightingDescriptorSets[frame]
+			.AddWriteDescriptor({ &lightInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0, 0)
+			.AddWriteDescriptor({ &gridInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, 0)
+			.AddWriteDescriptor({ &indexInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, 0)
+			.Update(m_Context);
+	}
+}
+
+void LightClusterer::Destroy()
+{
+	m_Context.DispatchTable.destroyPipeline(m_Pipeline, nullptr);
+	for (help::MappedBuffer const& lights: m_Lights)
+		help::DestroyMappedBuffer(m_Context, lights);
+	m_Lights.clear();
+	help::DestroyMappedBuffer(m_Context, m_Statistics);
+}
+
+void LightClusterer::Update(uint32_t frame, std::span<PointLight const> lights)
+{
+	size_t const count = std::min<size_t>(lights.size(), MAX_LIGHT_COUNT);
+	std::memcpy(m_Lights[frame].Data, lights.data(), count * sizeof(PointLight));
+	m_LightCounts[frame] = static_cast<uint32_t>(count);
+}
+
+void LightClusterer::Build(VkCommandBuffer commandBuffer, uint32_t frame) const
+{
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType              = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.memoryBarrierCount = 1;
+
+	// the lists are shared by the frames in flight, the previous lighting pass may still be reading them
+	VkMemoryBarrier2 reuseBarrier{};
+	reuseBarrier.sType        = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	reuseBarrier.srcStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+	reuseBarrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+	dependencyInfo.pMemoryBarriers = &reuseBarrier;
+	m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+	m_Context.DispatchTable.cmdFillBuffer(commandBuffer, m_Statistics.Buffer, 0, VK_WHOLE_SIZE, 0);
+
+	VkMemoryBarrier2 clearBarrier{};
+	clearBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	clearBarrier.srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+	clearBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	clearBarrier.dstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	clearBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+
+	dependencyInfo.pMemoryBarriers = &clearBarrier;
+	m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+	PushConstants const   constants{ m_LightCounts[frame] };
+	VkDescriptorSet const descriptorSet = m_DescriptorSets[frame];
+	m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+	m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
+												  , VK_PIPELINE_BIND_POINT_COMPUTE
+												  , m_PipelineLayout
+												  , 0
+												  , 1
+												  , &descriptorSet
+												  , 0
+												  , nullptr);
+	m_Context.DispatchTable.cmdPushConstants(commandBuffer
+											 , m_PipelineLayout
+											 , VK_SHADER_STAGE_COMPUTE_BIT
+											 , 0
+											 , sizeof(PushConstants)
+											 , &constants);
+	m_Context.DispatchTable.cmdDispatch(commandBuffer, (CLUSTER_COUNT + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+	VkMemoryBarrier2 lightingBarrier{};
+	lightingBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	lightingBarrier.srcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	lightingBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+	lightingBarrier.dstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_HOST_BIT;
+	lightingBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_HOST_READ_BIT;
+
+	dependencyInfo.pMemoryBarriers = &lightingBarrier;
+	m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+LightClusterer::Statistics LightClusterer::GetStatistics() const
+{
+	auto const* counts = static_cast<uint32_t const*>(m_Statistics.Data);
+	return { counts[0], counts[1], counts[2] };
+}
+
+void LightClusterer::CreatePipeline(vkc::PipelineCache& cache)
+{
+	// the grid and the list size, the lighting pass is specialized with the same values
+	struct Specialization
+	{
+		uint32_t GridX;
+		uint32_t GridY;
+		uint32_t GridZ;
+		uint32_t MaxLightsPerCluster;
+	};
+
+	VkSpecializationMapEntry const entries[]
+	{
+		{ 0, offsetof(Specialization, GridX), sizeof(uint32_t) }
+		, { 1, offsetof(Specialization, GridY), sizeof(uint32_t) }
+		, { 2, offsetof(Specialization, GridZ), sizeof(uint32_t) }
+		, { 3, offsetof(Specialization, MaxLightsPerCluster), sizeof(uint32_t) }
+	};
+	Specialization const specialization{ GRID_X, GRID_Y, GRID_Z, MAX_LIGHTS_PER_CLUSTER };
+
+	VkSpecializationInfo specializationInfo{};
+	specializationInfo.mapEntryCount = static_cast<uint32_t>(std::size(entries));
+	specializationInfo.pMapEntries   = entries;
+	specializationInfo.dataSize      = sizeof(Specialization);
+	specializationInfo.pData         = &specialization;
+
+	m_Pipeline = help::CreateComputePipeline(m_Context, cache, m_PipelineLayout, "shaders/light_cluster.spv", "light clustering", specializationInfo);
+}
@@ -0,0 +1,132 @@
+#include "mapped_file.h"
+
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::MappedFile(std::string_view path)
+{
+	std::string const filename{ path };
+#ifdef _WIN32
+	HANDLE const file = CreateFileA(filename.c_str()
+									, GENERIC_READ
+									, FILE_SHARE_READ
+									, nullptr
+									, OPEN_EXISTING
+									, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN
+									, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("failed to open file " + filename);
+	m_File = file;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size))
+	{
+		Unmap();
+		throw std::runtime_error("failed to query size of " + filename);
+	}
+	m_Size = static_cast<size_t>(size.QuadPart);
+	if (m_Size == 0)
+		return;
+
+	HANDLE const mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		Unmap();
+		throw std::runtime_error("failed to map file " + filename);
+	}
+	m_Mapping = mapping;
+
+	m_Data = static_cast<std::byte const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_Data)
+	{
+		Unmap();
+		throw std::runtime_error("failed to map view of " + filename);
+	}
+#else
+	int const file = open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::runtime_error("failed to open file " + filename);
+
+	struct stat status{};
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		throw std::runtime_error("failed to query size of " + filename);
+	}
+	m_Size = static_cast<size_t>(status.st_size);
+	if (m_Size == 0)
+	{
+		close(file);
+		return;
+	}
+
+	void* const data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+	// the mapping keeps its own reference to the file
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		m_Size = 0;
+		throw std::runtime_error("failed to map file " + filename);
+	}
+	m_Data = static_cast<std::byte const*>(data);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	Unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: m_Data{ std::exchange(other.m_Data, nullptr) }
+	, m_Size{ std::exchange(other.m_Size, 0) }
+#ifdef _WIN32
+	, m_File{ std::exchange(other.m_File, nullptr) }
+	, m_Mapping{ std::exchange(other.m_Mapping, nullptr) }
+#endif
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Unmap();
+		m_Data = std::exchange(other.m_Data, nullptr);
+		m_Size = std::exchange(other.m_Size, 0);
+#ifdef _WIN32
+		m_File    = std::exchange(other.m_File, nullptr);
+		m_Mapping = std::exchange(other.m_Mapping, nullptr);
+#endif
+	}
+	return *this;
+}
+
+void MappedFile::Unmap()
+{
+#ifdef _WIN32
+	if (m_Data)
+		UnmapViewOfFile(m_Data);
+	if (m_Mapping)
+		CloseHandle(m_Mapping);
+	if (m_File)
+		CloseHandle(m_File);
+	m_Mapping = nullptr;
+	m_File    = nullptr;
+#else
+	if (m_Data)
+		munmap(const_cast<std::byte*>(m_Data), m_Size);
+#endif
+	m_Data = nullptr;
+	m_Size = 0;
+}
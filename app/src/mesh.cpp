@@ -1,30 +1,46 @@
 #include "mesh.h"
+#include "glm/gtc/matrix_access.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/quaternion.hpp"
 #include "glm/gtx/quaternion.hpp"
 
 Mesh::Mesh
 (
-	vkc::Context&               context
-	, vkc::CommandBuffer const& commandBuffer
-	, std::vector<Vertex>&&     vertices, vkc::Buffer const& stagingVert
-	, std::vector<uint32_t>&&   indices, vkc::Buffer const&  stagingIndex
-	, TextureIndices            textureIndices
+	uint32_t           firstIndex
+	, int32_t          vertexOffset
+	, uint32_t         indexCount
+	, VkIndexType      indexType
+	, uint32_t         firstCluster
+	, uint32_t         clusterCount
+	, std::vector<Lod> lods
+	, glm::vec4 const& bounds
+	, TextureIndices   textureIndices
 )
-	: m_Vertices(std::move(vertices))
-	, m_VertexBuffer(vkc::BufferBuilder{ context }
-					 .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
-					 .Build(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
-							, m_Vertices.size() * sizeof(m_Vertices[0])))
-	, m_Indices(std::move(indices))
-	, m_IndexBuffer(vkc::BufferBuilder{ context }
-					.SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
-					.Build(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
-						   , m_Indices.size() * sizeof(m_Indices[0])))
-	, m_TextureIndices(textureIndices)
+	: m_FirstIndex(firstIndex)
+	, m_VertexOffset(vertexOffset)
+	, m_IndexCount(indexCount)
+	, m_IndexType(indexType)
+	, m_FirstCluster(firstCluster)
+	, m_ClusterCount(clusterCount)
+	, m_Lods(std::move(lods))
+	, m_Bounds(bounds)
+	, m_TextureIndices(textureIndices) {}
+
+uint32_t Mesh::SelectLod(glm::mat4 const& viewProjection, float viewportHeight, float pixelError) const
 {
-	stagingVert.CopyTo(context, commandBuffer, m_VertexBuffer);
-	stagingIndex.CopyTo(context, commandBuffer, m_IndexBuffer);
+	// clip w is the view depth for perspective projections and 1 for orthographic ones,
+	// the bounding sphere's nearest point gives the largest projection of the error
+	glm::vec4 const depthRow = glm::row(viewProjection, 3);
+	float const     nearestW = glm::dot(depthRow, glm::vec4{ glm::vec3{ m_Bounds }, 1.f })
+							   - m_Bounds.w * glm::length(glm::vec3{ depthRow });
+	if (nearestW <= .0f)
+		return 0;
+
+	float const pixelsPerUnit = glm::length(glm::vec3{ glm::row(viewProjection, 1) }) * viewportHeight * .5f / nearestW;
+	for (auto lod = static_cast<uint32_t>(m_Lods.size()) - 1; lod > 0; --lod)
+		if (m_Lods[lod].Error * pixelsPerUnit <= pixelError)
+			return lod;
+	return 0;
 }
 
 void Mesh::SetRotation(glm::vec3 const& rotation)
@@ -0,0 +1,224 @@
+#include "mesh_simplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+#include "glm/gtx/hash.hpp"
+
+namespace
+{
+	// symmetric 4x4 matrix summing area weighted squared distances to a set of planes, upper triangle only,
+	// the last element is the summed weight
+	using Quadric = std::array<double, 11>;
+
+	Quadric FromPlane(glm::dvec3 const& normal, double distance, double weight)
+	{
+		double const a = normal.x;
+		double const b = normal.y;
+		double const c = normal.z;
+		return {
+			a * a * weight, a * b * weight, a * c * weight, a * distance * weight
+			, b * b * weight, b * c * weight, b * distance * weight
+			, c * c * weight, c * distance * weight
+			, distance * distance * weight
+			, weight
+		};
+	}
+
+	Quadric operator+(Quadric const& left, Quadric const& right)
+	{
+		Quadric sum;
+		for (size_t index{}; index < sum.size(); ++index)
+			sum[index] = left[index] + right[index];
+		return sum;
+	}
+
+	// mean squared distance of the point to the planes
+	double Evaluate(Quadric const& quadric, glm::dvec3 const& point)
+	{
+		double const x = point.x;
+		double const y = point.y;
+		double const z = point.z;
+		double const sum = quadric[0] * x * x + 2 * quadric[1] * x * y + 2 * quadric[2] * x * z + 2 * quadric[3] * x
+						   + quadric[4] * y * y + 2 * quadric[5] * y * z + 2 * quadric[6] * y
+						   + quadric[7] * z * z + 2 * quadric[8] * z
+						   + quadric[9];
+		return quadric[10] > DBL_MIN ? std::max(sum, .0) / quadric[10] : .0;
+	}
+
+	uint64_t EdgeKey(uint32_t first, uint32_t second)
+	{
+		return static_cast<uint64_t>(std::min(first, second)) << 32 | std::max(first, second);
+	}
+
+	// vertices sharing a position with another vertex sit on an attribute seam, vertices on edges used by a single
+	// triangle sit on an open border, collapsing either would tear the mesh apart
+	std::vector<bool> FindLockedVertices(std::span<Vertex const> vertices, std::span<uint32_t const> indices)
+	{
+		std::vector<bool> locked(vertices.size());
+
+		std::unordered_map<glm::vec3, uint32_t> positions;
+		positions.reserve(vertices.size());
+		for (uint32_t index{}; index < vertices.size(); ++index)
+			if (auto const [it, inserted] = positions.try_emplace(vertices[index].Position, index);
+				!inserted)
+			{
+				locked[index]      = true;
+				locked[it->second] = true;
+			}
+
+		std::unordered_map<uint64_t, uint32_t> edges;
+		edges.reserve(indices.size());
+		for (size_t first{}; first + 2 < indices.size(); first += 3)
+			for (size_t corner{}; corner < 3; ++corner)
+				++edges[EdgeKey(indices[first + corner], indices[first + (corner + 1) % 3])];
+		for (auto const& [key, count]: edges)
+			if (count == 1)
+			{
+				locked[key >> 32]        = true;
+				locked[key & 0xffffffff] = true;
+			}
+
+		return locked;
+	}
+
+	struct Collapse
+	{
+		uint32_t From;
+		uint32_t To;
+		double   Cost;
+	};
+}
+
+mesh_simplifier::Result mesh_simplifier::Simplify
+(
+	std::span<Vertex const>     vertices
+	, std::span<uint32_t const> indices
+	, size_t                    targetIndexCount
+)
+{
+	Result result{ { indices.begin(), indices.end() }, .0f };
+
+	std::vector<bool> const locked = FindLockedVertices(vertices, indices);
+
+	std::vector<Quadric> quadrics(vertices.size(), Quadric{});
+	for (size_t first{}; first + 2 < indices.size(); first += 3)
+	{
+		glm::dvec3 const a      = vertices[indices[first]].Position;
+		glm::dvec3 const normal = glm::cross(glm::dvec3{ vertices[indices[first + 1]].Position } - a
+											 , glm::dvec3{ vertices[indices[first + 2]].Position } - a);
+		double const length = glm::length(normal);
+		if (length <= DBL_MIN)
+			continue;
+
+		Quadric const plane = FromPlane(normal / length, -glm::dot(normal / length, a), length * .5);
+		for (size_t corner{}; corner < 3; ++corner)
+			quadrics[indices[first + corner]] = quadrics[indices[first + corner]] + plane;
+	}
+
+	std::vector<uint32_t>  remap(vertices.size());
+	std::vector<bool>      touched(vertices.size());
+	std::vector<uint32_t>  triangleOffsets(vertices.size() + 1);
+	std::vector<uint32_t>  triangles;
+	std::vector<Collapse>  collapses;
+	std::vector<uint32_t>& current = result.Indices;
+
+	// every pass collapses a set of edges whose neighbourhoods do not overlap, so the adjacency built at its start stays valid
+	while (current.size() > targetIndexCount)
+	{
+		std::ranges::fill(triangleOffsets, 0);
+		for (uint32_t const index: current)
+			++triangleOffsets[index + 1];
+		for (size_t index{}; index < vertices.size(); ++index)
+			triangleOffsets[index + 1] += triangleOffsets[index];
+		triangles.resize(current.size());
+		std::vector<uint32_t> cursor{ triangleOffsets.begin(), triangleOffsets.end() - 1 };
+		for (uint32_t index{}; index < current.size(); ++index)
+			triangles[cursor[current[index]]++] = index / 3;
+
+		collapses.clear();
+		for (size_t first{}; first < current.size(); first += 3)
+			for (size_t corner{}; corner < 3; ++corner)
+			{
+				uint32_t const from = current[first + corner];
+				uint32_t const to   = current[first + (corner + 1) % 3];
+				if (!locked[from])
+					collapses.push_back(Collapse{ from, to, Evaluate(quadrics[from] + quadrics[to], vertices[to].Position) });
+				if (!locked[to])
+					collapses.push_back(Collapse{ to, from, Evaluate(quadrics[from] + quadrics[to], vertices[from].Position) });
+			}
+		std::ranges::sort(collapses
+						  , [](Collapse const& left, Collapse const& right)
+						  {
+							  return left.Cost < right.Cost;
+						  });
+
+		std::iota(remap.begin(), remap.end(), 0u);
+		touched.assign(vertices.size(), false);
+
+		// an interior collapse removes two triangles
+		size_t const budget = std::max<size_t>((current.size() - targetIndexCount) / 6, 1);
+		size_t       collapsed{};
+		for (auto const& [from, to, cost]: collapses)
+		{
+			if (collapsed == budget)
+				break;
+			if (touched[from] || touched[to])
+				continue;
+
+			// moving from onto to must not turn any surviving triangle around
+			bool flips{};
+			for (uint32_t slot{ triangleOffsets[from] }; slot < triangleOffsets[from + 1] && !flips; ++slot)
+			{
+				uint32_t const* triangle = &current[triangles[slot] * 3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+					continue;
+
+				glm::vec3 before[3];
+				glm::vec3 after[3];
+				for (size_t corner{}; corner < 3; ++corner)
+				{
+					before[corner] = vertices[triangle[corner]].Position;
+					after[corner]  = triangle[corner] == from ? vertices[to].Position : before[corner];
+				}
+				glm::vec3 const normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				glm::vec3 const normalAfter  = glm::cross(after[1] - after[0], after[2] - after[0]);
+				flips                        = glm::dot(normalBefore, normalAfter) <= .0f;
+			}
+			if (flips)
+				continue;
+
+			remap[from]   = to;
+			quadrics[to]  = quadrics[to] + quadrics[from];
+			result.Error  = std::max(result.Error, static_cast<float>(std::sqrt(cost)));
+			touched[from] = true;
+			touched[to]   = true;
+			for (uint32_t slot{ triangleOffsets[from] }; slot < triangleOffsets[from + 1]; ++slot)
+				for (size_t corner{}; corner < 3; ++corner)
+					touched[current[triangles[slot] * 3 + corner]] = true;
+			++collapsed;
+		}
+		if (collapsed == 0)
+			break;
+
+		size_t written{};
+		for (size_t first{}; first < current.size(); first += 3)
+		{
+			uint32_t const a = remap[current[first]];
+			uint32_t const b = remap[current[first + 1]];
+			uint32_t const c = remap[current[first + 2]];
+			if (a == b || b == c || c == a)
+				continue;
+			current[written++] = a;
+			current[written++] = b;
+			current[written++] = c;
+		}
+		current.resize(written);
+	}
+
+	return result;
+}
@@ -0,0 +1,113 @@
+#include "meshlet_builder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	Meshlet CalculateBounds(std::span<Vertex const> vertices, std::span<uint32_t const> indices, float padding)
+	{
+		glm::vec3 boundsMin{ FLT_MAX };
+		glm::vec3 boundsMax{ -FLT_MAX };
+		for (uint32_t const index: indices)
+		{
+			boundsMin = glm::min(boundsMin, vertices[index].Position);
+			boundsMax = glm::max(boundsMax, vertices[index].Position);
+		}
+
+		Meshlet meshlet{};
+		meshlet.Center = (boundsMin + boundsMax) * .5f;
+		for (uint32_t const index: indices)
+			meshlet.Radius = std::max(meshlet.Radius, glm::length(vertices[index].Position - meshlet.Center));
+		meshlet.Radius += padding;
+
+		// face normals rather than vertex normals, they decide what the rasterizer culls
+		std::vector<glm::vec3> normals;
+		normals.reserve(indices.size() / 3);
+		glm::vec3 axis{};
+		for (size_t first{}; first + 2 < indices.size(); first += 3)
+		{
+			glm::vec3 const& a = vertices[indices[first]].Position;
+			glm::vec3 const& b = vertices[indices[first + 1]].Position;
+			glm::vec3 const& c = vertices[indices[first + 2]].Position;
+
+			glm::vec3 const normal = glm::cross(b - a, c - a);
+			float const     length = glm::length(normal);
+			if (length <= FLT_MIN)
+				continue;
+			normals.push_back(normal / length);
+			axis += normals.back();
+		}
+
+		// a cutoff of 1 never passes the cull test, used when the normals span a hemisphere or more
+		meshlet.ConeAxis   = glm::vec3{ .0f, .0f, 1.f };
+		meshlet.ConeCutoff = 1.f;
+		float const axisLength = glm::length(axis);
+		if (axisLength <= FLT_MIN)
+			return meshlet;
+
+		axis /= axisLength;
+		float minDot{ 1.f };
+		for (glm::vec3 const& normal: normals)
+			minDot = std::min(minDot, glm::dot(axis, normal));
+
+		meshlet.ConeAxis = axis;
+		if (minDot > .0f)
+			meshlet.ConeCutoff = std::sqrt(1.f - minDot * minDot);
+		return meshlet;
+	}
+}
+
+std::vector<Meshlet> meshlet_builder::Build(std::span<Vertex const> vertices, std::span<uint32_t const> indices, float padding)
+{
+	std::vector<Meshlet> meshlets;
+
+	// meshlet each vertex was last counted for, so every vertex is counted once per meshlet
+	std::vector<uint32_t> owners(vertices.size(), UINT32_MAX);
+	uint32_t              firstIndex{};
+	uint32_t              vertexCount{};
+
+	auto const countNewVertices = [&owners](uint32_t const (&triangle)[3], uint32_t meshletIndex)
+	{
+		uint32_t count{};
+		for (uint32_t corner{}; corner < 3; ++corner)
+			if (owners[triangle[corner]] != meshletIndex &&
+				(corner == 0 || triangle[corner] != triangle[0]) &&
+				(corner < 2 || triangle[corner] != triangle[1]))
+				++count;
+		return count;
+	};
+
+	auto const close = [&](uint32_t endIndex)
+	{
+		Meshlet meshlet    = CalculateBounds(vertices, indices.subspan(firstIndex, endIndex - firstIndex), padding);
+		meshlet.FirstIndex = firstIndex;
+		meshlet.IndexCount = endIndex - firstIndex;
+		meshlets.push_back(meshlet);
+
+		firstIndex  = endIndex;
+		vertexCount = 0;
+	};
+
+	for (uint32_t index{}; index + 2 < indices.size(); index += 3)
+	{
+		uint32_t const triangle[3]{ indices[index], indices[index + 1], indices[index + 2] };
+
+		auto     meshletIndex = static_cast<uint32_t>(meshlets.size());
+		uint32_t newVertices  = countNewVertices(triangle, meshletIndex);
+		if (vertexCount + newVertices > MAX_VERTICES || (index - firstIndex) / 3 == MAX_TRIANGLES)
+		{
+			close(index);
+			newVertices = countNewVertices(triangle, ++meshletIndex);
+		}
+
+		for (uint32_t const vertex: triangle)
+			owners[vertex] = meshletIndex;
+		vertexCount += newVertices;
+	}
+	if (firstIndex < indices.size())
+		close(static_cast<uint32_t>(indices.size()));
+
+	return meshlets;
+}
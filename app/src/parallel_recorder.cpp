@@ -0,0 +1,101 @@
+#include "parallel_recorder.h"
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+#include "helper.h"
+
+ParallelRecorder::ParallelRecorder(vkc::Context& context, uint32_t queueFamily, uint32_t workerCount)
+	: m_Context{ context }
+	, m_ThreadPool{ workerCount }
+{
+	VkCommandPoolCreateInfo createInfo{};
+	createInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	createInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	createInfo.queueFamilyIndex = queueFamily;
+
+	m_Workers.resize(m_ThreadPool.GetThreadCount());
+	for (Worker& worker: m_Workers)
+	{
+		if (m_Context.DispatchTable.createCommandPool(&createInfo, nullptr, &worker.CommandPool) != VK_SUCCESS)
+			throw std::runtime_error("failed to create recording command pool");
+		help::NameObject(m_Context, reinterpret_cast<uint64_t>(worker.CommandPool), VK_OBJECT_TYPE_COMMAND_POOL, "recording worker");
+	}
+}
+
+void ParallelRecorder::Destroy()
+{
+	// frees the buffers with it
+	for (Worker const& worker: m_Workers)
+		m_Context.DispatchTable.destroyCommandPool(worker.CommandPool, nullptr);
+	m_Workers.clear();
+}
+
+void ParallelRecorder::Record(VkCommandBuffer primary, uint32_t count, RecordFunction const& record)
+{
+	if (count == 0)
+		return;
+
+	uint32_t const                 rangeCount = std::min(count, GetWorkerCount());
+	std::vector<VkCommandBuffer>   commandBuffers(rangeCount);
+	std::vector<std::future<void>> jobs;
+	jobs.reserve(rangeCount);
+	for (uint32_t range{}; range < rangeCount; ++range)
+	{
+		// sizes differ by at most one item
+		uint32_t const first = static_cast<uint32_t>(static_cast<uint64_t>(range) * count / rangeCount);
+		uint32_t const last  = static_cast<uint32_t>(static_cast<uint64_t>(range + 1) * count / rangeCount);
+		jobs.emplace_back(m_ThreadPool.Submit([this, &record, &commandBuffers, range, first, last]
+		{
+			Worker& worker = m_Workers[range];
+			if (worker.UsedCount == worker.CommandBuffers.size())
+			{
+				VkCommandBufferAllocateInfo allocateInfo{};
+				allocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocateInfo.commandPool        = worker.CommandPool;
+				allocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+				allocateInfo.commandBufferCount = 1;
+
+				VkCommandBuffer commandBuffer{};
+				if (m_Context.DispatchTable.allocateCommandBuffers(&allocateInfo, &commandBuffer) != VK_SUCCESS)
+					throw std::runtime_error("failed to allocate secondary command buffer");
+				worker.CommandBuffers.emplace_back(commandBuffer);
+			}
+			VkCommandBuffer const commandBuffer = worker.CommandBuffers[worker.UsedCount++];
+
+			// nothing is inherited, the buffer is executed outside of rendering
+			VkCommandBufferInheritanceInfo inheritanceInfo{};
+			inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			beginInfo.pInheritanceInfo = &inheritanceInfo;
+			if (m_Context.DispatchTable.beginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+				throw std::runtime_error("failed to begin secondary command buffer");
+
+			record(commandBuffer, first, last);
+
+			if (m_Context.DispatchTable.endCommandBuffer(commandBuffer) != VK_SUCCESS)
+				throw std::runtime_error("failed to end secondary command buffer");
+			commandBuffers[range] = commandBuffer;
+		}));
+	}
+	// every job is done with the vector before the first failure is rethrown
+	for (std::future<void> const& job: jobs)
+		job.wait();
+	for (std::future<void>& job: jobs)
+		job.get();
+
+	m_Context.DispatchTable.cmdExecuteCommands(primary, rangeCount, commandBuffers.data());
+}
+
+void ParallelRecorder::Reset()
+{
+	for (Worker& worker: m_Workers)
+	{
+		m_Context.DispatchTable.resetCommandPool(worker.CommandPool, 0);
+		worker.UsedCount = 0;
+	}
+}
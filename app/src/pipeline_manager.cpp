@@ -0,0 +1,232 @@
+#include "pipeline_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+
+#include "pipeline_cache.h"
+
+PipelineManager::PipelineManager(vkc::Context& context, vkc::PipelineCache& cache, uint32_t framesInFlight, uint32_t threadCount)
+	: m_Context{ context }
+	, m_Cache{ cache }
+	, m_FramesInFlight{ framesInFlight }
+	, m_ThreadPool{ threadCount }
+{
+	auto const seed = m_Cache.AcquireCache(m_Context);
+	m_CacheSeed.assign(seed.Cache.begin(), seed.Cache.end());
+}
+
+PipelineManager::~PipelineManager() = default;
+
+void PipelineManager::Request(std::string const& key, std::vector<std::string> shaders, Builder builder, std::string fallback)
+{
+	std::lock_guard lock{ m_Mutex };
+	auto [iterator, inserted] = m_Entries.try_emplace(key);
+	if (!inserted)
+		return;
+
+	Entry& entry   = iterator->second;
+	entry.Shaders  = std::move(shaders);
+	entry.Build    = std::move(builder);
+	entry.Fallback = std::move(fallback);
+	Submit(key, entry);
+}
+
+uint32_t PipelineManager::RebuildUsing(std::string const& shader)
+{
+	std::lock_guard lock{ m_Mutex };
+	uint32_t        count{};
+	for (auto& [key, entry]: m_Entries)
+		if (std::ranges::find(entry.Shaders, shader) != entry.Shaders.end())
+		{
+			Submit(key, entry);
+			++count;
+		}
+	return count;
+}
+
+void PipelineManager::Submit(std::string const& key, Entry& entry)
+{
+	uint64_t const generation = ++entry.Requested;
+	m_Pending.emplace_back(m_ThreadPool.Submit([this, key, generation, build = entry.Build]
+	{
+		try
+		{
+			CacheLease const lease{ *this };
+			size_t const     cacheSize = GetCacheSize(lease.Cache);
+			auto const       start     = std::chrono::steady_clock::now();
+			vkc::Pipeline    pipeline  = build(lease.Cache);
+			auto const       end       = std::chrono::steady_clock::now();
+			bool const       cacheHit  = GetCacheSize(lease.Cache) == cacheSize;
+			double const     duration  = std::chrono::duration<double, std::milli>(end - start).count();
+			// the first build of every pipeline is reported through the statistics, rebuilds come from shader edits
+			if (generation > 1)
+				std::cout << "Linked " << key << " pipeline in " << duration << " ms\n";
+
+			std::lock_guard lock{ m_Mutex };
+			m_Compiled.emplace_back(key, generation, std::move(pipeline), duration, cacheHit);
+		}
+		catch (std::exception const& exception)
+		{
+			std::cerr << "Failed to compile " << key << " pipeline: " << exception.what() << '\n';
+		}
+	}));
+}
+
+void PipelineManager::Wait()
+{
+	std::vector<std::future<void>> pending;
+	//
+	{
+		std::lock_guard lock{ m_Mutex };
+		pending.swap(m_Pending);
+	}
+	for (std::future<void>& future: pending)
+		future.wait();
+	Publish();
+}
+
+void PipelineManager::Update()
+{
+	++m_Frame;
+	Publish();
+
+	while (!m_Retired.empty() && m_Retired.front().Frame + m_FramesInFlight <= m_Frame)
+	{
+		m_Retired.front().Pipeline.Destroy(m_Context);
+		m_Retired.pop_front();
+	}
+}
+
+void PipelineManager::Publish()
+{
+	std::lock_guard lock{ m_Mutex };
+	std::erase_if(m_Pending
+				  , [](std::future<void> const& future)
+				  {
+					  return future.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready;
+				  });
+
+	for (CompiledPipeline& compiled: m_Compiled)
+	{
+		Entry& entry = m_Entries.at(compiled.Key);
+		// a rebuild requested later may finish first
+		if (compiled.Generation < entry.Published)
+		{
+			m_Retired.emplace_back(std::move(compiled.Pipeline), m_Frame);
+			continue;
+		}
+
+		if (entry.Pipeline)
+			m_Retired.emplace_back(std::move(*entry.Pipeline), m_Frame);
+		entry.Pipeline            = std::make_unique<vkc::Pipeline>(std::move(compiled.Pipeline));
+		entry.Published           = compiled.Generation;
+		entry.CompileMilliseconds = compiled.Milliseconds;
+		entry.CacheHit            = compiled.CacheHit;
+		++entry.Builds;
+		++(compiled.CacheHit ? m_CacheHits : m_CacheMisses);
+	}
+	m_Compiled.clear();
+}
+
+bool PipelineManager::IsReady(std::string const& key) const
+{
+	auto const iterator = m_Entries.find(key);
+	return iterator != m_Entries.end() && iterator->second.Pipeline;
+}
+
+vkc::Pipeline& PipelineManager::Get(std::string const& key) const
+{
+	auto const iterator = m_Entries.find(key);
+	if (iterator == m_Entries.end())
+		throw std::runtime_error("pipeline " + key + " was never requested");
+
+	Entry const& entry = iterator->second;
+	if (entry.Pipeline)
+		return *entry.Pipeline;
+	if (!entry.Fallback.empty() && IsReady(entry.Fallback))
+		return *m_Entries.at(entry.Fallback).Pipeline;
+	throw std::runtime_error("pipeline " + key + " is not compiled yet and has no ready fallback");
+}
+
+std::vector<PipelineManager::Statistics> PipelineManager::GetStatistics() const
+{
+	std::vector<Statistics> statistics;
+	statistics.reserve(m_Entries.size());
+	for (auto const& [key, entry]: m_Entries)
+		statistics.emplace_back(key, entry.CompileMilliseconds, entry.CacheHit, entry.Builds, entry.Pipeline != nullptr);
+	return statistics;
+}
+
+uint32_t PipelineManager::GetCacheHits() const
+{
+	return m_CacheHits;
+}
+
+uint32_t PipelineManager::GetCacheMisses() const
+{
+	return m_CacheMisses;
+}
+
+void PipelineManager::MergeCaches()
+{
+	std::lock_guard              lock{ m_CacheMutex };
+	std::vector<VkPipelineCache> caches;
+	caches.reserve(m_WorkerCaches.size());
+	for (auto const& cache: m_WorkerCaches)
+		caches.emplace_back(*cache);
+	if (!caches.empty() &&
+		m_Context.DispatchTable.mergePipelineCaches(m_Cache, static_cast<uint32_t>(caches.size()), caches.data()) != VK_SUCCESS)
+		throw std::runtime_error("failed to merge pipeline caches");
+}
+
+void PipelineManager::Destroy()
+{
+	Wait();
+	for (auto const& cache: m_WorkerCaches)
+		cache->Destroy(m_Context);
+	m_WorkerCaches.clear();
+	m_FreeCaches.clear();
+	for (RetiredPipeline& retired: m_Retired)
+		retired.Pipeline.Destroy(m_Context);
+	m_Retired.clear();
+	for (auto& entry: m_Entries | std::views::values)
+		if (entry.Pipeline)
+		{
+			entry.Pipeline->Destroy(m_Context);
+			entry.Pipeline.reset();
+		}
+}
+
+vkc::PipelineCache& PipelineManager::AcquireCache()
+{
+	std::lock_guard lock{ m_CacheMutex };
+	if (m_FreeCaches.empty())
+	{
+		// at most one per worker
+		m_WorkerCaches.emplace_back(std::make_unique<vkc::PipelineCache>(m_Context
+																		 , std::span<char const>{ m_CacheSeed }
+																		 , VkPipelineCacheCreateFlagBits{}));
+		return *m_WorkerCaches.back();
+	}
+	vkc::PipelineCache* cache = m_FreeCaches.back();
+	m_FreeCaches.pop_back();
+	return *cache;
+}
+
+void PipelineManager::ReleaseCache(vkc::PipelineCache& cache)
+{
+	std::lock_guard lock{ m_CacheMutex };
+	m_FreeCaches.emplace_back(&cache);
+}
+
+size_t PipelineManager::GetCacheSize(vkc::PipelineCache& cache) const
+{
+	size_t size{};
+	if (m_Context.DispatchTable.getPipelineCacheData(cache, &size, nullptr) != VK_SUCCESS)
+		return 0;
+	return size;
+}
@@ -1,65 +1,150 @@
 #include "scene.h"
-#include "assimp/Importer.hpp"
-#include "assimp/postprocess.h"
-#include "assimp/scene.h"
 
 #include "datatypes.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <future>
+#include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <utility>
 
 #include "command_pool.h"
 #include "helper.h"
+#include "scene_importer.h"
+#include "startup_timeline.h"
+#include "texture_processing.h"
 #include "glm/ext/matrix_transform.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
-Scene::Scene(vkc::Context& context, vkc::CommandPool& commandPool)
+namespace
+{
+	bool Uses16BitIndices(MeshRecord const& mesh)
+	{
+		return mesh.VertexCount <= UINT16_MAX;
+	}
+
+	VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	StagingRing::Allocation Subrange(StagingRing::Allocation const& allocation, VkDeviceSize offset, VkDeviceSize size)
+	{
+		return { allocation.Buffer, allocation.Offset + offset, allocation.Data.subspan(offset, size) };
+	}
+}
+
+Scene::Scene(vkc::Context& context, Uploader& uploader, uint32_t framesInFlight)
 	: m_Context{ context }
-	, m_CommandPool{ commandPool } {}
+	, m_Uploader{ uploader }
+	, m_FramesInFlight{ framesInFlight }
+	, m_ChangedTextures(framesInFlight) {}
 
 void Scene::Load(std::string_view filename)
 {
-	Assimp::Importer importer;
-	const aiScene*   scene = importer.ReadFile(filename.data()
-											 , aiProcess_Triangulate |
-											   aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices |
-											   aiProcess_ImproveCacheLocality | aiProcess_GenUVCoords |
-											   aiProcess_GenNormals | aiProcess_CalcTangentSpace);
-
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	Open(filename);
+
+	for (uint32_t index{}; index < m_TextureDecodes.size(); ++index)
+		AddTexture(index, m_TextureDecodes[index].get());
+	while (m_NextMesh < m_UploadOrder.size())
 	{
-		throw std::runtime_error("failed to load model " + std::string(importer.GetErrorString()));
+		RecordMesh(m_UploadOrder[m_NextMesh++]);
+		SubmitUploadBatchIfFull();
 	}
-	for (unsigned int i = 0; i < scene->mNumMaterials; ++i)
+	SubmitUploadBatch();
+
+	m_Uploader.Wait(m_Uploader.GetLastValue());
+	ShowCompletedMeshes();
+}
+
+void Scene::Open(std::string_view filename)
+{
+	std::string const cachePath  = cooked_scene::GetCachePath(filename);
+	uint64_t const    sourceHash = cooked_scene::HashSource(filename);
+	auto const        cacheStart = std::chrono::steady_clock::now();
+	try
 	{
-		if (aiMaterial const* material = scene->mMaterials[i];
-			material->GetTextureCount(aiTextureType_NORMALS) > 0 &&
-			material->GetTextureCount(aiTextureType_DIFFUSE_ROUGHNESS) > 0 &&
-			material->GetTextureCount(aiTextureType_METALNESS) > 0)
-		{
-			m_ContainsPBRInfo = true;
-			break;
-		}
+		startup_timeline::Scope const scope{ "Open cooked scene" };
+		m_CookedScene = std::make_unique<CookedScene>(cachePath, sourceHash);
 	}
-	vkc::CommandBuffer& commandBuffer = m_CommandPool.AllocateCommandBuffer(m_Context);
-	commandBuffer.Begin(m_Context, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-	ProcessNode(scene->mRootNode, scene, commandBuffer);
-	commandBuffer.End(m_Context);
-	commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
-	if (auto const result = m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
-		result != VK_SUCCESS)
-		throw std::runtime_error("failed to wait for the fences");
-
-	while (!m_StagingBuffers.empty())
+	catch (std::runtime_error const& error)
 	{
-		m_StagingBuffers.top().Destroy(m_Context);
-		m_StagingBuffers.pop();
+		std::cerr << "Cooked scene unavailable (" << error.what() << "). Importing " << filename << std::endl;
 	}
+
+	if (m_CookedScene)
+	{
+		m_LoadStart                    = cacheStart;
+		m_View                         = m_CookedScene->GetView();
+		m_LoadStats.ColdImportDuration = m_CookedScene->GetImportDuration();
+		m_LoadStats.LoadedFromCache    = true;
+		BeginUpload();
+		return;
+	}
+
+	auto const start = std::chrono::steady_clock::now();
+	m_ImportedScene  = std::make_unique<SceneData>(scene_importer::Import(filename));
+	auto const end   = std::chrono::steady_clock::now();
+	m_LoadStats.ColdImportDuration = std::chrono::duration<double>(end - start).count();
+	m_LoadStats.LoadedFromCache    = false;
+
+	try
+	{
+		startup_timeline::Scope const scope{ "Write cooked scene" };
+		cooked_scene::Write(cachePath, *m_ImportedScene, sourceHash, m_LoadStats.ColdImportDuration);
+	}
+	catch (std::runtime_error const& error)
+	{
+		std::cerr << error.what() << std::endl;
+	}
+
+	// upload through the freshly written cache so cold and warm runs share the same path
+	m_LoadStart = std::chrono::steady_clock::now();
+	try
+	{
+		startup_timeline::Scope const scope{ "Open cooked scene" };
+		m_CookedScene = std::make_unique<CookedScene>(cachePath, sourceHash);
+		m_ImportedScene.reset();
+	}
+	catch (std::runtime_error const& error)
+	{
+		std::cerr << error.what() << std::endl;
+	}
+	m_View = m_CookedScene ? m_CookedScene->GetView() : SceneView{ *m_ImportedScene };
+	BeginUpload();
+}
+
+void Scene::ContinueLoading()
+{
+	// in whatever order the workers finish them, every texture has its own slot
+	for (uint32_t index{}; index < m_TextureDecodes.size(); ++index)
+		if (m_TextureDecodes[index].valid() &&
+			m_TextureDecodes[index].wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready)
+			AddTexture(index, m_TextureDecodes[index].get());
+
+	while (m_NextMesh < m_UploadOrder.size() && m_StagedBytes < UPLOAD_BATCH_SIZE)
+		RecordMesh(m_UploadOrder[m_NextMesh++]);
+	if (m_StagedBytes > 0)
+		SubmitUploadBatch();
+
+	ShowCompletedMeshes();
+}
+
+bool Scene::IsLoaded() const
+{
+	return IsGeometryLoaded() && m_DecodedTextureCount == m_TextureDecodes.size() &&
+		   m_TextureStreamer->GetStatistics().Placeholders == 0;
 }
 
 void Scene::LoadFirstMeshFromFile(std::string_view filename)
 {
 	std::string string{ filename };
 	m_Meshes.clear();
+	m_MeshBounds.Clear();
 }
 
 glm::mat4 Scene::CalculateLightSpaceMatrix(glm::vec3 const& direction) const
@@ -117,7 +202,28 @@ uint32_t Scene::AddTextureToPool(vkc::Image&& image, vkc::ImageView&& imageView)
 {
 	m_TextureImages.emplace_back(std::move(image));
 	m_TextureImageViews.emplace_back(std::move(imageView));
-	return static_cast<uint32_t>(m_TextureImageViews.size() - 1);
+	auto const index = static_cast<uint32_t>(m_TextureImageViews.size() - 1);
+	for (std::vector<uint32_t>& changed: m_ChangedTextures)
+		changed.emplace_back(index);
+	return index;
+}
+
+std::pair<vkc::Image, vkc::ImageView> Scene::ReplaceTextureInPool(uint32_t index, vkc::Image&& image, vkc::ImageView&& imageView)
+{
+	std::pair<vkc::Image, vkc::ImageView> previous{ std::move(m_TextureImages[index]), std::move(m_TextureImageViews[index]) };
+	m_TextureImages[index]     = std::move(image);
+	m_TextureImageViews[index] = std::move(imageView);
+	for (std::vector<uint32_t>& changed: m_ChangedTextures)
+		changed.emplace_back(index);
+	return previous;
+}
+
+std::vector<uint32_t> Scene::TakeChangedTextures(uint32_t frame)
+{
+	std::vector<uint32_t> changed = m_TextureStreamer->TakeChangedTextures(frame);
+	changed.insert(changed.end(), m_ChangedTextures[frame].begin(), m_ChangedTextures[frame].end());
+	m_ChangedTextures[frame].clear();
+	return changed;
 }
 
 void Scene::AddLight(Light light)
@@ -147,148 +253,253 @@ void Scene::AddLight(glm::vec3 const& position, bool isPoint, glm::vec3 const& c
 	AddLight(Light{ position, isPoint, colour, intensity });
 }
 
-void Scene::ProcessNode(aiNode const* node, aiScene const* scene, vkc::CommandBuffer& commandBuffer)
+void Scene::BeginUpload()
 {
-	for (uint32_t meshIndex{}; meshIndex < node->mNumMeshes; meshIndex++)
-	{
-		aiMesh const* const   mesh = scene->mMeshes[node->mMeshes[meshIndex]];
-		std::vector<Vertex>   tempVertices;
-		std::vector<uint32_t> tempIndices;
-		aiMatrix4x4           transform = scene->mRootNode->mTransformation;
-
-		aiVector3D   translation{};
-		aiQuaternion rotationQuat{};
+	startup_timeline::Scope const scope{ "Begin upload" };
+	m_ContainsPBRInfo = m_View.ContainsPBRInfo;
+	m_AABBMin         = m_View.AABBMin;
+	m_AABBMax         = m_View.AABBMax;
+
+	// decoded on the workers while the placeholders are shown, in table order so bindless indices stay stable
+	StartTextureDecodes();
+	LoadPlaceholders();
+	std::vector<SourceTexture const*> placeholders;
+	placeholders.reserve(m_View.Textures.size());
+	for (TextureEntry const& texture: m_View.Textures)
+		placeholders.emplace_back(&m_Placeholders[static_cast<size_t>(texture.Usage)]);
+	m_TextureStreamer = std::make_unique<TextureStreamer>(m_Context
+														  , m_Uploader
+														  , m_TextureImages
+														  , m_TextureImageViews
+														  , std::move(placeholders)
+														  , m_FramesInFlight);
+	m_StagedBytes += m_TextureStreamer->GetStatistics().ResidentBytes;
+
+	uint64_t shortIndexCount{};
+	for (MeshRecord const& mesh: m_View.Meshes)
+		if (Uses16BitIndices(mesh))
+		{
+			shortIndexCount += mesh.IndexCount;
+			m_ShortIndexClusterCount += mesh.MeshletCount;
+		}
+	m_Geometry = std::make_unique<GeometryArena>(m_Context
+												 , m_View.Vertices.size()
+												 , shortIndexCount
+												 , m_View.Indices.size() - shortIndexCount
+												 , m_View.Meshlets.size());
+
+	m_UploadOrder.assign(m_View.Meshes.begin(), m_View.Meshes.end());
+	std::ranges::stable_partition(m_UploadOrder, Uses16BitIndices);
+
+	// ends once the last mesh is visible, frames later when loading progressively
+	m_GeometryUploadSpan = startup_timeline::Begin("Geometry upload", startup_timeline::NO_PARENT);
+	SubmitUploadBatch();
+}
 
-		transform.DecomposeNoScaling(rotationQuat, translation);
+void Scene::LoadPlaceholders()
+{
+	startup_timeline::Scope const scope{ "Load placeholders" };
+	// the importer's image for missing textures stands in for colour, data textures start out flat, dielectric and rough
+	std::string const directory{ texture_processing::SOURCE_DIRECTORY };
+	m_Placeholders.reserve(4);
+	m_Placeholders.emplace_back(texture_processing::Process(directory + "200px-Debugempty.png", TextureUsage::Albedo, false));
+	m_Placeholders.emplace_back(ktx2::Texture{
+		texture_processing::GetFormat(TextureUsage::Normals, false)
+		, texture_mips::Chain{ { 128, 128 }, { texture_mips::Level{ 1, 1, 0, 2 } } }
+	});
+	m_Placeholders.emplace_back(ktx2::Texture{
+		texture_processing::GetFormat(TextureUsage::Metalness, false)
+		, texture_mips::Chain{ { 0 }, { texture_mips::Level{ 1, 1, 0, 1 } } }
+	});
+	m_Placeholders.emplace_back(texture_processing::Process(directory + "white.png", TextureUsage::Roughness, false));
+}
 
-		aiMatrix3x3 const rotation{ rotationQuat.GetMatrix() };
+void Scene::StartTextureDecodes()
+{
+	m_TextureDecodeStart = std::chrono::steady_clock::now();
+	// the decodes outlive the load call, so the span hangs off the root and each worker names its parent
+	m_TextureDecodeSpan = startup_timeline::Begin("Texture decode", startup_timeline::NO_PARENT);
 
-		for (uint32_t vertexIndex{}; vertexIndex < mesh->mNumVertices; vertexIndex++)
+	m_TextureDecodes.reserve(m_View.Textures.size());
+	for (TextureEntry const& texture: m_View.Textures)
+		m_TextureDecodes.emplace_back(m_ThreadPool.Submit([texture, parent = m_TextureDecodeSpan]
 		{
-			aiVector3D const aiPosition  = transform * mesh->mVertices[vertexIndex];
-			aiVector3D const aiNormal    = rotation * mesh->mNormals[vertexIndex];
-			aiVector3D const aiTangent   = rotation * mesh->mTangents[vertexIndex];
-			aiVector3D const aiBitangent = rotation * mesh->mBitangents[vertexIndex];
-
-			Vertex tempVertex{};
-			tempVertex.Position  = glm::vec3(aiPosition.x, aiPosition.y, aiPosition.z);
-			tempVertex.UV        = glm::vec2(mesh->mTextureCoords[0][vertexIndex].x, mesh->mTextureCoords[0][vertexIndex].y);
-			tempVertex.Normal    = glm::vec3(aiNormal.x, aiNormal.y, aiNormal.z);
-			tempVertex.Tangent   = glm::vec3(aiTangent.x, aiTangent.y, aiTangent.z);
-			tempVertex.Bitangent = glm::vec3(aiBitangent.x, aiBitangent.y, aiBitangent.z);
-
-			m_AABBMin.x = std::min(m_AABBMin.x, tempVertex.Position.x);
-			m_AABBMin.y = std::min(m_AABBMin.y, tempVertex.Position.y);
-			m_AABBMin.z = std::min(m_AABBMin.z, tempVertex.Position.z);
-
-			m_AABBMax.x = std::max(m_AABBMax.x, tempVertex.Position.x);
-			m_AABBMax.y = std::max(m_AABBMax.y, tempVertex.Position.y);
-			m_AABBMax.z = std::max(m_AABBMax.z, tempVertex.Position.z);
-
-			tempVertices.push_back(tempVertex);
-		}
-		for (uint32_t faceIndex{}; faceIndex < mesh->mNumFaces; faceIndex++)
-		{
-			aiFace const& face = mesh->mFaces[faceIndex];
-			for (uint32_t index{}; index < face.mNumIndices; index++)
-				tempIndices.push_back(face.mIndices[index]);
-		}
+			uint32_t const span        = startup_timeline::Begin(texture.Path, parent);
+			auto const     decodeStart = std::chrono::steady_clock::now();
+			SourceTexture result{};
+			bool          cooked{ true };
+			try
+			{
+				result = ktx2::Open(texture_processing::GetCookedPath(texture_processing::COOKED_DIRECTORY, texture));
+			}
+			catch (std::runtime_error const&)
+			{
+				std::string const sourcePath = std::string{ texture_processing::SOURCE_DIRECTORY } + texture.Path;
+				result                       = texture_processing::Process(sourcePath, texture.Usage, false);
+				cooked                       = false;
+			}
+			auto const decodeEnd = std::chrono::steady_clock::now();
+			startup_timeline::End(span);
+			return DecodedTexture{ std::move(result), std::chrono::duration<double>(decodeEnd - decodeStart).count(), cooked };
+		}));
+	if (m_TextureDecodes.empty())
+		startup_timeline::End(m_TextureDecodeSpan);
+}
 
-		TextureIndices textureIndices{};
-		textureIndices.Diffuse = LoadTexture(aiTextureType_DIFFUSE, scene->mMaterials[mesh->mMaterialIndex], commandBuffer);
-		textureIndices.Normals = LoadTexture(aiTextureType_NORMALS
-											 , scene->mMaterials[mesh->mMaterialIndex]
-											 , commandBuffer
-											 , VK_FORMAT_R8G8B8A8_UNORM);
-		textureIndices.Metalness = LoadTexture(aiTextureType_METALNESS, scene->mMaterials[mesh->mMaterialIndex], commandBuffer);
-		textureIndices.Roughness = LoadTexture(aiTextureType_DIFFUSE_ROUGHNESS, scene->mMaterials[mesh->mMaterialIndex], commandBuffer);
-
-		vkc::Buffer& stagingVert = m_StagingBuffers.emplace(vkc::BufferBuilder{ m_Context }
-															.MapMemory()
-															.SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
-																					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
-															.Build(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-																   , tempVertices.size() * sizeof(tempVertices[0])
-																   , false));
-		stagingVert.UpdateData(tempVertices);
-
-		vkc::Buffer& stagingIndex = m_StagingBuffers.emplace(vkc::BufferBuilder{ m_Context }
-															 .MapMemory()
-															 .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
-																					 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
-															 .Build(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-																	, tempIndices.size() * sizeof(tempIndices[0])
-																	, false));
-		stagingIndex.UpdateData(tempIndices);
-
-		m_Meshes.emplace_back(m_Context
-							  , commandBuffer
-							  , std::move(tempVertices)
-							  , stagingVert
-							  , std::move(tempIndices)
-							  , stagingIndex
-							  , textureIndices);
-	}
-	for (uint32_t index{}; index < node->mNumChildren; index++)
-		ProcessNode(node->mChildren[index], scene, commandBuffer);
+void Scene::AddTexture(uint32_t index, DecodedTexture decoded)
+{
+	std::span<texture_mips::Level const> const levels = std::holds_alternative<ktx2::MappedTexture>(decoded.Texture)
+														? std::get<ktx2::MappedTexture>(decoded.Texture).Levels
+														: std::get<ktx2::Texture>(decoded.Texture).Chain.Levels;
+	for (texture_mips::Level const& level: levels)
+		m_UncompressedTextureBytes += static_cast<uint64_t>(level.Width) * level.Height * 4;
+	m_LoadStats.TextureDecodeSummedDuration += decoded.Duration;
+	m_CookedTextureCount += decoded.Cooked;
+
+	uint64_t const tailBytes = m_TextureStreamer->SetSource(index, std::move(decoded.Texture));
+	m_TextureTailBytes += tailBytes;
+	m_StagedBytes += tailBytes;
+	startup_timeline::AddBytes(m_TextureDecodeSpan, tailBytes);
+	startup_timeline::AddItems(m_TextureDecodeSpan, 1, "textures");
+	if (++m_DecodedTextureCount < m_TextureDecodes.size())
+		return;
+	startup_timeline::End(m_TextureDecodeSpan);
+
+	// progressive loading only notices a finished decode on the next frame
+	auto const end                        = std::chrono::steady_clock::now();
+	m_LoadStats.TextureDecodeWallDuration = std::chrono::duration<double>(end - m_TextureDecodeStart).count();
+
+	if (m_CookedTextureCount != m_TextureDecodes.size())
+		std::cout << m_TextureDecodes.size() - m_CookedTextureCount << " of " << m_TextureDecodes.size()
+			<< " textures have no cooked KTX2, loaded uncompressed from the sources (run the CookTextures target)" << std::endl;
+	std::cout << std::format("Texture memory {:.1f} MiB in mip tails of {:.1f} MiB, {:.1f} MiB as uncompressed RGBA8"
+							 , static_cast<double>(m_TextureTailBytes) / (1024 * 1024)
+							 , static_cast<double>(m_TextureStreamer->GetStatistics().FullChainBytes) / (1024 * 1024)
+							 , static_cast<double>(m_UncompressedTextureBytes) / (1024 * 1024)) << std::endl;
 }
 
-uint32_t Scene::LoadTexture(aiTextureType type, aiMaterial const* material, vkc::CommandBuffer const& commandBuffer, VkFormat format)
+void Scene::RecordMesh(MeshRecord const& mesh)
 {
-	aiString str;
-	if (material->GetTextureCount(type))
-		material->GetTexture(type, 0, &str);
+	std::span const vertices = m_View.Vertices.subspan(mesh.FirstVertex, mesh.VertexCount);
+	std::span const indices  = m_View.Indices.subspan(mesh.FirstIndex, mesh.IndexCount);
+	std::span const meshlets = m_View.Meshlets.subspan(mesh.FirstMeshlet, mesh.MeshletCount);
+
+	VkIndexType const indexType = Uses16BitIndices(mesh) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	size_t const      indexSize = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	// one block for the whole mesh, a second allocation could submit the batch and retire the first before its copy
+	// was recorded
+	VkDeviceSize const            indexOffset   = AlignUp(vertices.size_bytes(), indexSize);
+	VkDeviceSize const            clusterOffset = AlignUp(indexOffset + indices.size() * indexSize, alignof(Cluster));
+	VkDeviceSize const            stagingSize   = clusterOffset + meshlets.size() * sizeof(Cluster);
+	StagingRing::Allocation const staging       = m_Uploader.AllocateStaging(stagingSize, alignof(Cluster));
+
+	StagingRing::Allocation const stagingVert = Subrange(staging, 0, vertices.size_bytes());
+	std::memcpy(stagingVert.Data.data(), vertices.data(), vertices.size_bytes());
+
+	// indices are mesh local, narrowed while they are written into the ring
+	StagingRing::Allocation const stagingIndex = Subrange(staging, indexOffset, indices.size() * indexSize);
+	if (indexType == VK_INDEX_TYPE_UINT16)
+		std::ranges::transform(indices
+							   , reinterpret_cast<uint16_t*>(stagingIndex.Data.data())
+							   , [](uint32_t index)
+							   {
+								   return static_cast<uint16_t>(index);
+							   });
 	else
-		str = aiString{ "200px-Debugempty.png" };
+		std::memcpy(stagingIndex.Data.data(), indices.data(), indices.size_bytes());
+
+	GeometryArena::Range const range = m_Geometry->Upload(m_Uploader.GetCommandBuffer(), stagingVert, stagingIndex, indexType);
+
+	// meshlets become clusters pointing straight into the arena
+	uint32_t const                firstCluster    = m_Geometry->GetClusterCount();
+	StagingRing::Allocation const stagingClusters = Subrange(staging, clusterOffset, meshlets.size() * sizeof(Cluster));
+	std::ranges::transform(meshlets
+						   , reinterpret_cast<Cluster*>(stagingClusters.Data.data())
+						   , [&range, firstCluster](Meshlet const& meshlet)
+						   {
+							   return Cluster{
+								   glm::vec4{ meshlet.Center, meshlet.Radius }
+								   , glm::vec4{ meshlet.ConeAxis, meshlet.ConeCutoff }
+								   , range.FirstIndex + meshlet.FirstIndex
+								   , meshlet.IndexCount
+								   , range.VertexOffset
+								   , firstCluster
+							   };
+						   });
+	m_Geometry->UploadClusters(m_Uploader.GetCommandBuffer(), stagingClusters);
+	m_StagedBytes += stagingSize;
+	startup_timeline::AddBytes(m_GeometryUploadSpan, stagingSize);
+	startup_timeline::AddItems(m_GeometryUploadSpan, 1, "meshes");
+
+	std::vector<Mesh::Lod> lods;
+	lods.reserve(mesh.LodCount);
+	for (MeshLod const& lod: m_View.Lods.subspan(mesh.FirstLod, mesh.LodCount))
+		lods.push_back(Mesh::Lod{ firstCluster + lod.FirstMeshlet, lod.MeshletCount, lod.IndexCount, lod.Error });
+
+	m_RecordedMeshes.emplace_back(range.FirstIndex
+								  , range.VertexOffset
+								  , mesh.IndexCount
+								  , indexType
+								  , firstCluster
+								  , mesh.MeshletCount
+								  , std::move(lods)
+								  , glm::vec4{ mesh.Center, mesh.Radius }
+								  , mesh.Textures);
+}
 
-	if (!m_LoadedTextures.contains(str.C_Str()))
+void Scene::ShowCompletedMeshes()
+{
+	// batches complete in order and meshes are uploaded in arena order, so the visible clusters stay a prefix
+	while (!m_PendingMeshes.empty() && m_Uploader.IsComplete(m_PendingMeshes.front().Value))
 	{
-		std::string const fullPath{ "data/textures/" + std::string{ str.C_Str() } };
-		m_LoadedTextures[str.C_Str()] = static_cast<uint32_t>(m_TextureImages.size());
-
-		help::ImageData const imageData{ help::LoadImage(fullPath) };
-
-		std::span const span{ imageData.Pixels, imageData.Pixels + imageData.Size };
-
-		vkc::Buffer& stagingBuffer = m_StagingBuffers.emplace(vkc::BufferBuilder{ m_Context }
-															  .MapMemory()
-															  .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-																					  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
-															  .Build(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, imageData.Size, false));
-		stagingBuffer.UpdateData(span);
-
-		vkc::Image& image = m_TextureImages.emplace_back(vkc::ImageBuilder{ m_Context }
-														 .SetType(VK_IMAGE_TYPE_2D)
-														 .SetFormat(format)
-														 .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
-														 .SetExtent({
-																		static_cast<uint32_t>(imageData.Width)
-																		, static_cast<uint32_t>(imageData.Height)
-																	})
-														 .Build(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
-
-		m_TextureImageViews.emplace_back(image.CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D));
-		//
-		{
-			vkc::Image::Transition transition{};
-			transition.NewLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			transition.SrcAccessMask = VK_ACCESS_NONE;
-			transition.DstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			image.MakeTransition(m_Context, commandBuffer, transition);
-		}
-		stagingBuffer.CopyTo(m_Context, commandBuffer, image);
-		//
-		{
-			vkc::Image::Transition transition{};
-			transition.NewLayout     = VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL;
-			transition.SrcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			transition.DstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-			image.MakeTransition(m_Context, commandBuffer, transition);
-		}
+		PendingMeshes& batch = m_PendingMeshes.front();
+		m_ResidentClusterCount = batch.Meshes.back().GetFirstCluster() + batch.Meshes.back().GetClusterCount();
+		m_UploadValue          = batch.Value;
+		for (Mesh const& mesh: batch.Meshes)
+			m_MeshBounds.Add(mesh.GetBounds());
+		m_Meshes.splice(m_Meshes.end(), batch.Meshes);
+		m_PendingMeshes.pop_front();
 	}
-	return m_LoadedTextures[str.C_Str()];
+
+	if (IsGeometryLoaded() && (m_CookedScene || m_ImportedScene))
+		FinishGeometry();
+}
+
+void Scene::FinishGeometry()
+{
+	auto const end                 = std::chrono::steady_clock::now();
+	m_LoadStats.CachedLoadDuration = std::chrono::duration<double>(end - m_LoadStart).count();
+	startup_timeline::End(m_GeometryUploadSpan);
+
+	std::cout << std::format("Geometry memory {:.1f} MiB, {:.1f} MiB with full precision vertices and 32 bit indices"
+							 , static_cast<double>(m_Geometry->GetSize()) / (1024 * 1024)
+							 , static_cast<double>(m_View.Vertices.size() * sizeof(Vertex) + m_View.Indices.size_bytes()) / (1024 * 1024))
+		<< std::endl;
+	std::cout << std::format("{} clusters in {} LODs, {:.1f} triangles on average", m_Geometry->GetClusterCount(), m_View.Lods.size()
+							 , static_cast<double>(m_View.Indices.size()) / 3 / std::max(m_Geometry->GetClusterCount(), 1u)) << std::endl;
+	std::cout << std::format("Staging ring peak {:.1f} of {:.1f} MiB, {} stalls on a full ring"
+							 , static_cast<double>(m_Uploader.GetStagingRing().GetPeakUsage()) / (1024 * 1024)
+							 , static_cast<double>(m_Uploader.GetStagingRing().GetCapacity()) / (1024 * 1024)
+							 , m_Uploader.GetStagingStallCount()) << std::endl;
+
+	// every mesh is in the arena, the textures keep their own mappings
+	m_View = {};
+	m_CookedScene.reset();
+	m_ImportedScene.reset();
+}
+
+void Scene::SubmitUploadBatchIfFull()
+{
+	if (m_StagedBytes >= UPLOAD_BATCH_SIZE)
+		SubmitUploadBatch();
+}
+
+void Scene::SubmitUploadBatch()
+{
+	m_Geometry->ReleaseWritten(m_Uploader);
+	uint64_t const value = m_TextureStreamer->Flush();
+	if (!m_RecordedMeshes.empty())
+		m_PendingMeshes.emplace_back(PendingMeshes{ value, std::exchange(m_RecordedMeshes, {}) });
+	m_StagedBytes = 0;
 }
@@ -0,0 +1,246 @@
+#include "scene_importer.h"
+#include "gltf_loader.h"
+#include "mesh_simplifier.h"
+#include "meshlet_builder.h"
+#include "startup_timeline.h"
+#include "vertex_packing.h"
+#include "assimp/Importer.hpp"
+#include "assimp/postprocess.h"
+#include "assimp/scene.h"
+
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+	uint32_t constexpr MAX_LOD_COUNT{ 6 };
+	// a level that keeps more of the previous level's indices than this is not worth its memory
+	float constexpr MAX_LOD_INDEX_RATIO{ .85f };
+
+	struct ImportContext
+	{
+		aiScene const*                            Scene;
+		SceneData&                                Data;
+		std::unordered_map<std::string, uint32_t> TextureLookup;
+		// packed once the bounds of the whole scene are known
+		std::vector<Vertex>& Vertices;
+	};
+
+	uint32_t AddTexture(ImportContext& context, aiTextureType type, aiMaterial const* material, TextureUsage usage)
+	{
+		aiString str;
+		if (material->GetTextureCount(type))
+			material->GetTexture(type, 0, &str);
+		else
+			str = aiString{ "200px-Debugempty.png" };
+
+		// keyed by usage as well, textures are processed per usage and glTF shares one image for metalness and roughness
+		std::string const key = std::string{ str.C_Str() } + '#' + std::to_string(static_cast<uint32_t>(usage));
+		if (auto const it = context.TextureLookup.find(key);
+			it != context.TextureLookup.end())
+			return it->second;
+
+		auto const index = static_cast<uint32_t>(context.Data.Textures.size());
+		context.Data.Textures.push_back(TextureEntry{ str.C_Str(), usage });
+		context.TextureLookup.emplace(key, index);
+		return index;
+	}
+
+	void ProcessNode(ImportContext& context, aiNode const* node)
+	{
+		aiScene const* const scene = context.Scene;
+		SceneData&           data  = context.Data;
+		for (uint32_t meshIndex{}; meshIndex < node->mNumMeshes; meshIndex++)
+		{
+			aiMesh const* const mesh      = scene->mMeshes[node->mMeshes[meshIndex]];
+			aiMatrix4x4         transform = scene->mRootNode->mTransformation;
+
+			aiVector3D   translation{};
+			aiQuaternion rotationQuat{};
+
+			transform.DecomposeNoScaling(rotationQuat, translation);
+
+			aiMatrix3x3 const rotation{ rotationQuat.GetMatrix() };
+
+			MeshRecord record{};
+			record.FirstVertex = static_cast<uint32_t>(context.Vertices.size());
+			record.VertexCount = mesh->mNumVertices;
+			record.FirstIndex  = static_cast<uint32_t>(data.Indices.size());
+
+			context.Vertices.reserve(context.Vertices.size() + mesh->mNumVertices);
+			for (uint32_t vertexIndex{}; vertexIndex < mesh->mNumVertices; vertexIndex++)
+			{
+				aiVector3D const aiPosition  = transform * mesh->mVertices[vertexIndex];
+				aiVector3D const aiNormal    = rotation * mesh->mNormals[vertexIndex];
+				aiVector3D const aiTangent   = rotation * mesh->mTangents[vertexIndex];
+				aiVector3D const aiBitangent = rotation * mesh->mBitangents[vertexIndex];
+
+				Vertex tempVertex{};
+				tempVertex.Position  = glm::vec3(aiPosition.x, aiPosition.y, aiPosition.z);
+				tempVertex.UV        = glm::vec2(mesh->mTextureCoords[0][vertexIndex].x, mesh->mTextureCoords[0][vertexIndex].y);
+				tempVertex.Normal    = glm::vec3(aiNormal.x, aiNormal.y, aiNormal.z);
+				tempVertex.Tangent   = glm::vec3(aiTangent.x, aiTangent.y, aiTangent.z);
+				tempVertex.Bitangent = glm::vec3(aiBitangent.x, aiBitangent.y, aiBitangent.z);
+
+				data.AABBMin = glm::min(data.AABBMin, tempVertex.Position);
+				data.AABBMax = glm::max(data.AABBMax, tempVertex.Position);
+
+				context.Vertices.push_back(tempVertex);
+			}
+			for (uint32_t faceIndex{}; faceIndex < mesh->mNumFaces; faceIndex++)
+			{
+				aiFace const& face = mesh->mFaces[faceIndex];
+				for (uint32_t index{}; index < face.mNumIndices; index++)
+					data.Indices.push_back(face.mIndices[index]);
+			}
+			record.IndexCount = static_cast<uint32_t>(data.Indices.size()) - record.FirstIndex;
+
+			aiMaterial const* material = scene->mMaterials[mesh->mMaterialIndex];
+			record.Textures.Diffuse    = AddTexture(context, aiTextureType_DIFFUSE, material, TextureUsage::Albedo);
+			record.Textures.Normals    = AddTexture(context, aiTextureType_NORMALS, material, TextureUsage::Normals);
+			record.Textures.Metalness  = AddTexture(context, aiTextureType_METALNESS, material, TextureUsage::Metalness);
+			record.Textures.Roughness  = AddTexture(context, aiTextureType_DIFFUSE_ROUGHNESS, material, TextureUsage::Roughness);
+
+			data.Meshes.push_back(record);
+		}
+		for (uint32_t index{}; index < node->mNumChildren; index++)
+			ProcessNode(context, node->mChildren[index]);
+	}
+
+	SourceScene ReadWithAssimp(std::string_view filename)
+	{
+		Assimp::Importer importer;
+		const aiScene*   scene = [&importer, filename]
+		{
+			startup_timeline::Scope const scope{ "Assimp read file" };
+			return importer.ReadFile(std::string{ filename }
+									 , aiProcess_Triangulate |
+									   aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices |
+									   aiProcess_ImproveCacheLocality | aiProcess_GenUVCoords |
+									   aiProcess_GenNormals | aiProcess_CalcTangentSpace);
+		}();
+
+		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+		{
+			throw std::runtime_error("failed to load model " + std::string(importer.GetErrorString()));
+		}
+
+		SourceScene source{};
+		SceneData&  data = source.Data;
+		for (unsigned int i = 0; i < scene->mNumMaterials; ++i)
+		{
+			if (aiMaterial const* material = scene->mMaterials[i];
+				material->GetTextureCount(aiTextureType_NORMALS) > 0 &&
+				material->GetTextureCount(aiTextureType_DIFFUSE_ROUGHNESS) > 0 &&
+				material->GetTextureCount(aiTextureType_METALNESS) > 0)
+			{
+				data.ContainsPBRInfo = true;
+				break;
+			}
+		}
+
+		startup_timeline::Scope const conversion{ "Convert vertices" };
+		ImportContext                 context{ scene, data, {}, source.Vertices };
+		ProcessNode(context, scene->mRootNode);
+		conversion.AddItems(source.Vertices.size(), "vertices");
+		conversion.AddBytes(source.Vertices.size() * sizeof(Vertex) + data.Indices.size() * sizeof(uint32_t));
+		return source;
+	}
+
+	// rebuilds every mesh's index range as its LOD chain, splits the levels into meshlets and packs the vertices
+	SceneData BuildLods(SourceScene scene)
+	{
+		SceneData& data = scene.Data;
+
+		startup_timeline::Scope const lods{ "Build LODs and meshlets" };
+		lods.AddItems(data.Meshes.size(), "meshes");
+
+		// a full quantization step covers the rounding of every axis
+		float const padding = glm::length(data.AABBMax - data.AABBMin) / 65535.f;
+
+		// rebuilt so every mesh's coarser levels follow its full resolution indices
+		std::vector<uint32_t> indices;
+		indices.reserve(data.Indices.size() * 2);
+		for (MeshRecord& mesh: data.Meshes)
+		{
+			std::span const vertices = std::span{ scene.Vertices }.subspan(mesh.FirstVertex, mesh.VertexCount);
+			std::span const source   = std::span{ data.Indices }.subspan(mesh.FirstIndex, mesh.IndexCount);
+
+			glm::vec3 boundsMin{ FLT_MAX };
+			glm::vec3 boundsMax{ -FLT_MAX };
+			for (Vertex const& vertex: vertices)
+			{
+				boundsMin = glm::min(boundsMin, vertex.Position);
+				boundsMax = glm::max(boundsMax, vertex.Position);
+			}
+			mesh.Center = (boundsMin + boundsMax) * .5f;
+			mesh.Radius = glm::length(boundsMax - boundsMin) * .5f + padding;
+
+			mesh.FirstIndex   = static_cast<uint32_t>(indices.size());
+			mesh.FirstMeshlet = static_cast<uint32_t>(data.Meshlets.size());
+			mesh.FirstLod     = static_cast<uint32_t>(data.Lods.size());
+
+			mesh_simplifier::Result level{ { source.begin(), source.end() }, .0f };
+			while (true)
+			{
+				MeshLod lod{};
+				lod.FirstIndex   = static_cast<uint32_t>(indices.size()) - mesh.FirstIndex;
+				lod.IndexCount   = static_cast<uint32_t>(level.Indices.size());
+				lod.FirstMeshlet = static_cast<uint32_t>(data.Meshlets.size()) - mesh.FirstMeshlet;
+				lod.Error        = level.Error;
+
+				std::vector<Meshlet> meshlets = meshlet_builder::Build(vertices, level.Indices, padding);
+				for (Meshlet& meshlet: meshlets)
+					meshlet.FirstIndex += lod.FirstIndex;
+				lod.MeshletCount = static_cast<uint32_t>(meshlets.size());
+
+				indices.insert(indices.end(), level.Indices.begin(), level.Indices.end());
+				data.Meshlets.insert(data.Meshlets.end(), meshlets.begin(), meshlets.end());
+				data.Lods.push_back(lod);
+				if (data.Lods.size() - mesh.FirstLod == MAX_LOD_COUNT)
+					break;
+
+				// every level is simplified from the source so its error is measured against the full resolution surface
+				mesh_simplifier::Result next = mesh_simplifier::Simplify(vertices, source, level.Indices.size() / 6 * 3);
+				if (next.Indices.empty() ||
+					static_cast<float>(next.Indices.size()) > static_cast<float>(level.Indices.size()) * MAX_LOD_INDEX_RATIO)
+					break;
+				level = std::move(next);
+			}
+
+			mesh.IndexCount   = static_cast<uint32_t>(indices.size()) - mesh.FirstIndex;
+			mesh.MeshletCount = static_cast<uint32_t>(data.Meshlets.size()) - mesh.FirstMeshlet;
+			mesh.LodCount     = static_cast<uint32_t>(data.Lods.size()) - mesh.FirstLod;
+		}
+		data.Indices = std::move(indices);
+		lods.AddBytes(data.Indices.size() * sizeof(uint32_t) + data.Meshlets.size() * sizeof(Meshlet));
+
+		startup_timeline::Scope const packing{ "Pack vertices" };
+		data.Vertices = vertex_packing::Pack(scene.Vertices, data.AABBMin, data.AABBMax);
+		packing.AddItems(data.Vertices.size(), "vertices");
+		packing.AddBytes(data.Vertices.size() * sizeof(PackedVertex));
+		return std::move(data);
+	}
+}
+
+SceneData scene_importer::Import(std::string_view filename, Reader reader)
+{
+	bool const                    native = reader == Reader::Auto && gltf_loader::CanLoad(filename);
+	startup_timeline::Scope const scope{ native ? "Import with the native glTF loader" : "Import with Assimp" };
+	auto const                    start  = std::chrono::steady_clock::now();
+	SourceScene                   source = native ? gltf_loader::Load(filename) : ReadWithAssimp(filename);
+	auto const                    read   = std::chrono::steady_clock::now();
+	SceneData                     data   = BuildLods(std::move(source));
+	auto const                    end    = std::chrono::steady_clock::now();
+
+	std::cout << std::format("Read {} with {} in {:.3f} s, LODs and meshlets built in {:.3f} s"
+							 , filename
+							 , native ? "the native glTF loader" : "Assimp"
+							 , std::chrono::duration<double>(read - start).count()
+							 , std::chrono::duration<double>(end - read).count()) << std::endl;
+	return data;
+}
@@ -0,0 +1,158 @@
+#include "shader_reloader.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "pipeline_manager.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// only the inotify watch uses these
+namespace
+{
+	bool IsShaderSource(std::filesystem::path const& path)
+	{
+		auto const extension = path.extension();
+		return extension == ".vert" || extension == ".frag" || extension == ".comp";
+	}
+
+	bool IsShaderInclude(std::filesystem::path const& path)
+	{
+		return path.extension() == ".glsl";
+	}
+
+	// the sources that include the header, they are recompiled in its place
+	std::vector<std::string> FindIncluders(std::string const& header)
+	{
+		std::string const        directive = "#include \"" + header + "\"";
+		std::vector<std::string> includers;
+		for (std::filesystem::directory_entry const& entry: std::filesystem::directory_iterator{ SHADER_SOURCE_DIRECTORY })
+		{
+			if (!IsShaderSource(entry.path()))
+				continue;
+			std::ifstream     file{ entry.path() };
+			std::string const text{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+			if (text.find(directive) != std::string::npos)
+				includers.emplace_back(entry.path().filename().string());
+		}
+		return includers;
+	}
+}
+#endif
+
+ShaderReloader::ShaderReloader(PipelineManager& pipelines)
+	: m_Pipelines{ pipelines }
+{
+#ifdef __linux__
+	m_Watch = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_Watch < 0 || inotify_add_watch(m_Watch, SHADER_SOURCE_DIRECTORY, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+	{
+		std::cerr << "Shader hot reload disabled, can not watch " << SHADER_SOURCE_DIRECTORY << '\n';
+		if (m_Watch >= 0)
+			close(m_Watch);
+		m_Watch = -1;
+		return;
+	}
+	m_Thread = std::thread{ &ShaderReloader::WatchLoop, this };
+#endif
+}
+
+ShaderReloader::~ShaderReloader()
+{
+	m_Stopping = true;
+	if (m_Thread.joinable())
+		m_Thread.join();
+}
+
+void ShaderReloader::Destroy()
+{
+	m_Stopping = true;
+	if (m_Thread.joinable())
+		m_Thread.join();
+#ifdef __linux__
+	if (m_Watch >= 0)
+		close(m_Watch);
+	m_Watch = -1;
+#endif
+}
+
+void ShaderReloader::WatchLoop()
+{
+#ifdef __linux__
+	alignas(inotify_event) std::array<char, 4096> buffer{};
+	std::set<std::string>                          changed;
+
+	while (!m_Stopping)
+	{
+		pollfd descriptor{ m_Watch, POLLIN, 0 };
+		// a shorter timeout once something changed waits for the saves to settle
+		int const ready = poll(&descriptor, 1, changed.empty() ? 250 : static_cast<int>(SETTLE_MILLISECONDS));
+		if (ready > 0)
+		{
+			ssize_t length{};
+			while ((length = read(m_Watch, buffer.data(), buffer.size())) > 0)
+				for (ssize_t offset{}; offset < length;)
+				{
+					auto const* event = reinterpret_cast<inotify_event const*>(buffer.data() + offset);
+					if (event->len > 0 && IsShaderSource(event->name))
+						changed.emplace(event->name);
+					else if (event->len > 0 && IsShaderInclude(event->name))
+						for (std::string& includer: FindIncluders(event->name))
+							changed.emplace(std::move(includer));
+					offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+				}
+			continue;
+		}
+
+		for (std::string const& shader: changed)
+			if (Compile(shader) && m_Pipelines.RebuildUsing(shader) == 0)
+				std::cout << "No reloadable pipeline uses " << shader << ", restart to apply it\n";
+		changed.clear();
+	}
+#endif
+}
+
+#ifdef __linux__
+bool ShaderReloader::Compile(std::string const& shader) const
+{
+	std::filesystem::path const source = std::filesystem::path{ SHADER_SOURCE_DIRECTORY } / shader;
+	std::filesystem::path const output = std::filesystem::path{ "shaders" } / source.stem().replace_extension(".spv");
+
+	// same invocation as the build's Shader_Compile, diagnostics are captured to be shown on failure
+	std::string const command = std::string{ "\"" } + GLSLANG_EXECUTABLE + "\" -V --target-env vulkan1.3 -I\"" + SHADER_SOURCE_DIRECTORY
+								+ "\" \"" + source.string() + "\" -o \"" + output.string() + "\" 2>&1";
+
+	auto const start   = std::chrono::steady_clock::now();
+	FILE*      process = popen(command.c_str(), "r");
+	if (!process)
+	{
+		std::cerr << "Failed to start the shader compiler for " << shader << '\n';
+		return false;
+	}
+
+	std::string           diagnostics;
+	std::array<char, 256> line{};
+	while (fgets(line.data(), static_cast<int>(line.size()), process))
+		diagnostics += line.data();
+	int const  status = pclose(process);
+	auto const end    = std::chrono::steady_clock::now();
+
+	if (status != 0)
+	{
+		std::cerr << "Failed to compile " << shader << ", keeping the previous pipelines\n" << diagnostics;
+		return false;
+	}
+	std::cout << "Compiled " << shader << " in " << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
+	return true;
+}
+#endif
@@ -0,0 +1,80 @@
+#include "staging_ring.h"
+
+#include <algorithm>
+
+namespace
+{
+	VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+StagingRing::StagingRing(vkc::Context& context, VkDeviceSize capacity)
+	: m_Context{ context }
+	, m_Buffer{ help::CreateMappedBuffer(context, capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, "staging ring") }
+	, m_Capacity{ capacity } {}
+
+void StagingRing::Destroy()
+{
+	for (Region const& region: m_Regions)
+		for (help::MappedBuffer const& buffer: region.DedicatedBuffers)
+			help::DestroyMappedBuffer(m_Context, buffer);
+	for (help::MappedBuffer const& buffer: m_OpenRegion.DedicatedBuffers)
+		help::DestroyMappedBuffer(m_Context, buffer);
+	m_Regions.clear();
+	m_OpenRegion = {};
+	help::DestroyMappedBuffer(m_Context, m_Buffer);
+}
+
+std::optional<StagingRing::Allocation> StagingRing::TryAllocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+	if (size > m_Capacity)
+	{
+		help::MappedBuffer const buffer = help::CreateMappedBuffer(m_Context, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, "oversized staging");
+		m_OpenRegion.DedicatedBuffers.emplace_back(buffer);
+		return Allocation{ buffer.Buffer, 0, { static_cast<std::byte*>(buffer.Data), size } };
+	}
+
+	// a request that does not fit before the end wraps to the start, the skipped tail stays part of the region
+	VkDeviceSize offset  = AlignUp(m_Head, alignment);
+	VkDeviceSize padding = offset - m_Head;
+	if (offset + size > m_Capacity)
+	{
+		offset  = 0;
+		padding = m_Capacity - m_Head;
+	}
+	if (m_Used + padding + size > m_Capacity)
+		return std::nullopt;
+
+	m_Head = offset + size;
+	m_Used += padding + size;
+	m_OpenRegion.Size += padding + size;
+	m_PeakUsage = std::max(m_PeakUsage, m_Used);
+	return Allocation{ m_Buffer.Buffer, offset, { static_cast<std::byte*>(m_Buffer.Data) + offset, size } };
+}
+
+void StagingRing::Close(uint64_t value)
+{
+	if (m_OpenRegion.Size == 0 && m_OpenRegion.DedicatedBuffers.empty())
+		return;
+
+	m_OpenRegion.Value = value;
+	m_Regions.emplace_back(std::move(m_OpenRegion));
+	m_OpenRegion = {};
+}
+
+void StagingRing::Release(uint64_t completedValue)
+{
+	while (!m_Regions.empty() && m_Regions.front().Value <= completedValue)
+	{
+		for (help::MappedBuffer const& buffer: m_Regions.front().DedicatedBuffers)
+			help::DestroyMappedBuffer(m_Context, buffer);
+		m_Used -= m_Regions.front().Size;
+		m_Regions.pop_front();
+	}
+
+	// nothing is in flight, start over so the next batch gets the whole ring without wrapping
+	if (m_Used == 0)
+		m_Head = 0;
+}
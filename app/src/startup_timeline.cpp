@@ -0,0 +1,156 @@
+#include "startup_timeline.h"
+
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+namespace
+{
+	auto const                          origin{ std::chrono::steady_clock::now() };
+	std::mutex                          mutex;
+	std::vector<startup_timeline::Span> spans;
+	// scopes open on this thread, innermost last
+	thread_local std::vector<uint32_t> scopeStack;
+
+	double SecondsSinceOrigin()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count();
+	}
+
+	std::string Escape(std::string_view string)
+	{
+		std::string escaped;
+		escaped.reserve(string.size());
+		for (char const character: string)
+			switch (character)
+			{
+			case '"':
+				escaped += "\\\"";
+				break;
+			case '\\':
+				escaped += "\\\\";
+				break;
+			default:
+				if (static_cast<unsigned char>(character) < 0x20)
+					escaped += std::format("\\u{:04x}", static_cast<uint32_t>(character));
+				else
+					escaped += character;
+			}
+		return escaped;
+	}
+
+	void WriteSpan
+	(
+		std::ofstream&                               file
+		, std::vector<startup_timeline::Span> const& snapshot
+		, std::vector<std::vector<uint32_t>> const&  children
+		, uint32_t                                   index
+		, uint32_t                                   depth
+	)
+	{
+		startup_timeline::Span const& span = snapshot[index];
+		std::string const             indent(depth * 2, ' ');
+		file << indent << "{ \"name\": \"" << Escape(span.Name) << '"'
+			<< std::format(", \"start_ms\": {:.3f}, \"duration_ms\": {:.3f}", span.Start * 1000., span.Duration * 1000.);
+		if (!span.Finished)
+			file << ", \"unfinished\": true";
+		if (span.Bytes > 0)
+			file << ", \"bytes\": " << span.Bytes;
+		if (span.Items > 0)
+			file << ", \"" << Escape(span.ItemName) << "\": " << span.Items;
+		if (!children[index].empty())
+		{
+			file << ", \"children\": [\n";
+			for (size_t child{}; child < children[index].size(); ++child)
+			{
+				WriteSpan(file, snapshot, children, children[index][child], depth + 1);
+				file << (child + 1 < children[index].size() ? ",\n" : "\n");
+			}
+			file << indent << ']';
+		}
+		file << " }";
+	}
+}
+
+uint32_t startup_timeline::Begin(std::string name, uint32_t parent)
+{
+	if (parent == CURRENT_SCOPE)
+		parent = scopeStack.empty() ? NO_PARENT : scopeStack.back();
+
+	double const    start = SecondsSinceOrigin();
+	std::lock_guard lock{ mutex };
+	spans.push_back(Span{ std::move(name), parent, start, 0, false, 0, 0, {} });
+	return static_cast<uint32_t>(spans.size() - 1);
+}
+
+void startup_timeline::End(uint32_t span)
+{
+	double const    end = SecondsSinceOrigin();
+	std::lock_guard lock{ mutex };
+	spans[span].Duration = end - spans[span].Start;
+	spans[span].Finished = true;
+}
+
+void startup_timeline::AddBytes(uint32_t span, uint64_t bytes)
+{
+	std::lock_guard lock{ mutex };
+	spans[span].Bytes += bytes;
+}
+
+void startup_timeline::AddItems(uint32_t span, uint64_t count, std::string_view itemName)
+{
+	std::lock_guard lock{ mutex };
+	spans[span].Items += count;
+	spans[span].ItemName = itemName;
+}
+
+startup_timeline::Scope::Scope(std::string name)
+	: m_Span{ Begin(std::move(name)) }
+{
+	scopeStack.push_back(m_Span);
+}
+
+startup_timeline::Scope::~Scope()
+{
+	scopeStack.pop_back();
+	End(m_Span);
+}
+
+std::vector<startup_timeline::Span> startup_timeline::GetSpans()
+{
+	double const      now = SecondsSinceOrigin();
+	std::vector<Span> snapshot;
+	//
+	{
+		std::lock_guard lock{ mutex };
+		snapshot = spans;
+	}
+	for (Span& span: snapshot)
+		if (!span.Finished)
+			span.Duration = now - span.Start;
+	return snapshot;
+}
+
+void startup_timeline::WriteJson(std::string_view path)
+{
+	std::vector<Span> const snapshot = GetSpans();
+
+	std::vector<std::vector<uint32_t>> children(snapshot.size());
+	std::vector<uint32_t>              roots;
+	for (uint32_t index{}; index < snapshot.size(); ++index)
+		(snapshot[index].Parent == NO_PARENT ? roots : children[snapshot[index].Parent]).push_back(index);
+
+	std::ofstream file{ std::string{ path } };
+	if (!file)
+		throw std::runtime_error("failed to write " + std::string{ path });
+
+	file << "[\n";
+	for (size_t root{}; root < roots.size(); ++root)
+	{
+		WriteSpan(file, snapshot, children, roots[root], 1);
+		file << (root + 1 < roots.size() ? ",\n" : "\n");
+	}
+	file << "]\n";
+}
@@ -0,0 +1,136 @@
+#include "texture_mips.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	uint32_t constexpr CHANNEL_COUNT{ 4 };
+
+	std::array<float, 256> const& GetSRGBToLinearTable()
+	{
+		static std::array<float, 256> const table = []
+		{
+			std::array<float, 256> result{};
+			for (uint32_t index{}; index < result.size(); ++index)
+			{
+				float const value = static_cast<float>(index) / 255.f;
+				result[index]     = value <= .04045f ? value / 12.92f : std::pow((value + .055f) / 1.055f, 2.4f);
+			}
+			return result;
+		}();
+		return table;
+	}
+
+	unsigned char LinearToSRGB(float value)
+	{
+		value = std::clamp(value, .0f, 1.f);
+		value = value <= .0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - .055f;
+		return static_cast<unsigned char>(std::lround(value * 255.f));
+	}
+
+	unsigned char ToUnorm(float value)
+	{
+		return static_cast<unsigned char>(std::lround(std::clamp(value, .0f, 1.f) * 255.f));
+	}
+
+	// 2x2 box filter, odd edges clamp so the last row/column is not lost
+	void Downsample
+	(
+		unsigned char const* source, uint32_t sourceWidth, uint32_t sourceHeight
+		, unsigned char*     destination, uint32_t width, uint32_t height, texture_mips::Filter filter
+	)
+	{
+		auto const& toLinear = GetSRGBToLinearTable();
+		for (uint32_t y{}; y < height; ++y)
+			for (uint32_t x{}; x < width; ++x)
+			{
+				uint32_t const x0 = std::min(x * 2, sourceWidth - 1);
+				uint32_t const x1 = std::min(x * 2 + 1, sourceWidth - 1);
+				uint32_t const y0 = std::min(y * 2, sourceHeight - 1);
+				uint32_t const y1 = std::min(y * 2 + 1, sourceHeight - 1);
+
+				unsigned char const* texels[]
+				{
+					source + (y0 * sourceWidth + x0) * CHANNEL_COUNT
+					, source + (y0 * sourceWidth + x1) * CHANNEL_COUNT
+					, source + (y1 * sourceWidth + x0) * CHANNEL_COUNT
+					, source + (y1 * sourceWidth + x1) * CHANNEL_COUNT
+				};
+
+				float sum[CHANNEL_COUNT]{};
+				for (unsigned char const* texel: texels)
+					for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+					{
+						bool const isColour = filter == texture_mips::Filter::SRGB && channel < 3;
+						sum[channel] += isColour ? toLinear[texel[channel]] : texel[channel] / 255.f;
+					}
+
+				unsigned char* const output = destination + (y * width + x) * CHANNEL_COUNT;
+				switch (filter)
+				{
+				case texture_mips::Filter::Linear:
+					for (uint32_t channel{}; channel < CHANNEL_COUNT; ++channel)
+						output[channel] = ToUnorm(sum[channel] * .25f);
+					break;
+				case texture_mips::Filter::SRGB:
+					for (uint32_t channel{}; channel < 3; ++channel)
+						output[channel] = LinearToSRGB(sum[channel] * .25f);
+					output[3] = ToUnorm(sum[3] * .25f);
+					break;
+				case texture_mips::Filter::Normal:
+				{
+					float normal[3]{};
+					for (uint32_t channel{}; channel < 3; ++channel)
+						normal[channel] = sum[channel] * .5f - 1.f; // mean of 2 * v - 1 over the four texels
+					float const length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+					for (uint32_t channel{}; channel < 3; ++channel)
+						output[channel] = ToUnorm(length > 1e-6f ? normal[channel] / length * .5f + .5f : .5f);
+					output[3] = ToUnorm(sum[3] * .25f);
+					break;
+				}
+				}
+			}
+	}
+}
+
+uint32_t texture_mips::CalculateLevelCount(uint32_t width, uint32_t height)
+{
+	return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+}
+
+texture_mips::Chain texture_mips::Generate(std::span<unsigned char const> pixels, uint32_t width, uint32_t height, Filter filter)
+{
+	uint32_t const levelCount = CalculateLevelCount(width, height);
+
+	Chain chain{};
+	chain.Levels.reserve(levelCount);
+	uint64_t totalSize{};
+	for (uint32_t level{}; level < levelCount; ++level)
+	{
+		uint32_t const levelWidth  = std::max(width >> level, 1u);
+		uint32_t const levelHeight = std::max(height >> level, 1u);
+		uint64_t const size        = static_cast<uint64_t>(levelWidth) * levelHeight * CHANNEL_COUNT;
+		chain.Levels.emplace_back(Level{ levelWidth, levelHeight, totalSize, size });
+		totalSize += size;
+	}
+
+	chain.Pixels.resize(totalSize);
+	std::memcpy(chain.Pixels.data(), pixels.data(), std::min<uint64_t>(pixels.size(), chain.Levels[0].Size));
+	for (uint32_t level{ 1 }; level < levelCount; ++level)
+	{
+		Level const& source      = chain.Levels[level - 1];
+		Level const& destination = chain.Levels[level];
+		Downsample(chain.Pixels.data() + source.Offset
+				   , source.Width
+				   , source.Height
+				   , chain.Pixels.data() + destination.Offset
+				   , destination.Width
+				   , destination.Height
+				   , filter);
+	}
+	return chain;
+}
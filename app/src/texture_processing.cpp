@@ -0,0 +1,115 @@
+#include "texture_processing.h"
+
+#include <filesystem>
+
+#include "block_compression.h"
+#include "helper.h"
+
+namespace
+{
+	uint32_t constexpr METALNESS_CHANNEL{ 2 };
+	uint32_t constexpr ROUGHNESS_CHANNEL{ 1 };
+
+	template<typename Converter>
+	ktx2::Texture ConvertLevels(texture_mips::Chain const& chain, VkFormat format, Converter&& convert)
+	{
+		ktx2::Texture texture{ format, {} };
+		for (texture_mips::Level const& level: chain.Levels)
+		{
+			std::vector<unsigned char> const bytes = convert(std::span{ chain.Pixels }.subspan(level.Offset, level.Size)
+															 , level.Width
+															 , level.Height);
+			// buffer to image copies need offsets aligned to 4 bytes, small R8 and RG8 levels are not
+			texture.Chain.Pixels.resize((texture.Chain.Pixels.size() + 3) & ~size_t{ 3 });
+			texture.Chain.Levels.emplace_back(texture_mips::Level{ level.Width, level.Height, texture.Chain.Pixels.size(), bytes.size() });
+			texture.Chain.Pixels.insert(texture.Chain.Pixels.end(), bytes.begin(), bytes.end());
+		}
+		return texture;
+	}
+
+	std::vector<unsigned char> ExtractChannels(std::span<unsigned char const> pixels, uint32_t firstChannel, uint32_t channelCount)
+	{
+		std::vector<unsigned char> result;
+		result.reserve(pixels.size() / 4 * channelCount);
+		for (size_t texel{}; texel < pixels.size(); texel += 4)
+			for (uint32_t channel{}; channel < channelCount; ++channel)
+				result.emplace_back(pixels[texel + firstChannel + channel]);
+		return result;
+	}
+}
+
+std::string texture_processing::GetCookedPath(std::string_view cookedDirectory, TextureEntry const& texture)
+{
+	static char const* const suffixes[]{ "albedo", "normals", "metalness", "roughness" };
+
+	std::filesystem::path const source{ texture.Path };
+	return std::string{ cookedDirectory } + source.stem().string() + "_" + suffixes[static_cast<uint32_t>(texture.Usage)] + ".ktx2";
+}
+
+VkFormat texture_processing::GetFormat(TextureUsage usage, bool compressed)
+{
+	switch (usage)
+	{
+	case TextureUsage::Albedo:
+		return compressed ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_R8G8B8A8_SRGB;
+	case TextureUsage::Normals:
+		return compressed ? VK_FORMAT_BC5_UNORM_BLOCK : VK_FORMAT_R8G8_UNORM;
+	case TextureUsage::Metalness:
+	case TextureUsage::Roughness:
+		return compressed ? VK_FORMAT_BC4_UNORM_BLOCK : VK_FORMAT_R8_UNORM;
+	}
+	throw std::runtime_error("unknown texture usage");
+}
+
+ktx2::Texture texture_processing::Process(std::string_view sourcePath, TextureUsage usage, bool compress)
+{
+	help::ImageData const data{ help::LoadImage(sourcePath) };
+
+	texture_mips::Filter filter{ texture_mips::Filter::Linear };
+	if (usage == TextureUsage::Albedo)
+		filter = texture_mips::Filter::SRGB;
+	else if (usage == TextureUsage::Normals)
+		filter = texture_mips::Filter::Normal;
+
+	texture_mips::Chain chain = texture_mips::Generate({ data.Pixels, data.Size }
+													   , static_cast<uint32_t>(data.Width)
+													   , static_cast<uint32_t>(data.Height)
+													   , filter);
+
+	VkFormat const format = GetFormat(usage, compress);
+	switch (usage)
+	{
+	case TextureUsage::Albedo:
+		if (!compress)
+			return ktx2::Texture{ format, std::move(chain) };
+		return ConvertLevels(chain, format, block_compression::EncodeBC7);
+	case TextureUsage::Normals:
+		if (!compress)
+			return ConvertLevels(chain
+								 , format
+								 , [](std::span<unsigned char const> pixels, uint32_t, uint32_t)
+								 {
+									 return ExtractChannels(pixels, 0, 2);
+								 });
+		return ConvertLevels(chain, format, block_compression::EncodeBC5);
+	case TextureUsage::Metalness:
+	case TextureUsage::Roughness:
+	{
+		uint32_t const channel = usage == TextureUsage::Metalness ? METALNESS_CHANNEL : ROUGHNESS_CHANNEL;
+		if (!compress)
+			return ConvertLevels(chain
+								 , format
+								 , [channel](std::span<unsigned char const> pixels, uint32_t, uint32_t)
+								 {
+									 return ExtractChannels(pixels, channel, 1);
+								 });
+		return ConvertLevels(chain
+							 , format
+							 , [channel](std::span<unsigned char const> pixels, uint32_t width, uint32_t height)
+							 {
+								 return block_compression::EncodeBC4(pixels, width, height, channel);
+							 });
+	}
+	}
+	throw std::runtime_error("unknown texture usage");
+}
@@ -0,0 +1,381 @@
+#include "texture_streaming.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "command_buffer.h"
+
+TextureStreamer::TextureStreamer
+(
+	vkc::Context&                       context
+	, Uploader&                         uploader
+	, std::vector<vkc::Image>&          images
+	, std::vector<vkc::ImageView>&      views
+	, std::vector<SourceTexture const*> placeholders
+	, uint32_t                          framesInFlight
+)
+	: m_Context{ context }
+	, m_Uploader{ uploader }
+	, m_Images{ images }
+	, m_Views{ views }
+	, m_FramesInFlight{ framesInFlight }
+	, m_ChangedTextures(framesInFlight)
+{
+	if (!m_Images.empty())
+		throw std::runtime_error("streamed textures have to be the first in the pool");
+
+	m_Textures.reserve(placeholders.size());
+	for (SourceTexture const* placeholder: placeholders)
+	{
+		uint32_t const tail = GetTailLevel(*placeholder);
+		m_Textures.emplace_back(Texture{ std::nullopt, placeholder, tail, tail, tail, tail, 0, true });
+	}
+
+	// placeholders go straight into the pool, nothing samples a texture before the batch they are in completed
+	m_RecordedUploads.reserve(m_Textures.size());
+	for (uint32_t index{}; index < m_Textures.size(); ++index)
+		Stream(index, m_Textures[index].TailLevel);
+	for (PendingUpload& upload: m_RecordedUploads)
+	{
+		m_Images.emplace_back(std::move(upload.Image));
+		m_Views.emplace_back(std::move(upload.View));
+	}
+	m_RecordedUploads.clear();
+
+	// zero means the texture was not sampled, so no frame requests anything before it is drawn
+	m_FeedbackBuffers.reserve(framesInFlight);
+	for (uint32_t frame{}; frame < framesInFlight; ++frame)
+		m_FeedbackBuffers.emplace_back(help::CreateMappedBuffer(m_Context
+																, std::max<VkDeviceSize>(m_Textures.size() * sizeof(uint32_t)
+																						 , sizeof(uint32_t))
+																, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+																, "texture feedback"));
+}
+
+void TextureStreamer::Destroy()
+{
+	for (uint32_t index{}; index < m_Textures.size(); ++index)
+	{
+		m_Views[index].Destroy(m_Context);
+		m_Images[index].Destroy(m_Context);
+	}
+	for (PendingBatch& batch: m_PendingBatches)
+		for (PendingUpload& upload: batch.Uploads)
+		{
+			upload.View.Destroy(m_Context);
+			upload.Image.Destroy(m_Context);
+		}
+	for (PendingUpload& upload: m_RecordedUploads)
+	{
+		upload.View.Destroy(m_Context);
+		upload.Image.Destroy(m_Context);
+	}
+	for (RetiredImage& retired: m_RetiredImages)
+	{
+		retired.View.Destroy(m_Context);
+		retired.Image.Destroy(m_Context);
+	}
+	for (help::MappedBuffer const& buffer: m_FeedbackBuffers)
+		help::DestroyMappedBuffer(m_Context, buffer);
+}
+
+uint64_t TextureStreamer::SetSource(uint32_t index, SourceTexture source)
+{
+	Texture& texture = m_Textures[index];
+
+	texture.Source         = std::move(source);
+	texture.TailLevel      = GetTailLevel(*texture.Source);
+	texture.RequestedLevel = texture.TailLevel;
+	return Stream(index, texture.TailLevel);
+}
+
+uint64_t TextureStreamer::Flush()
+{
+	uint64_t const value = m_Uploader.Submit();
+	if (!m_RecordedUploads.empty())
+		m_PendingBatches.emplace_back(PendingBatch{ value, std::exchange(m_RecordedUploads, {}) });
+	return value;
+}
+
+void TextureStreamer::Update(uint32_t frame, uint64_t budget)
+{
+	++m_Frame;
+
+	// every frame recorded since the swap rewrote its descriptor first, so the last submission that could sample
+	// a retired view belongs to a frame whose fence has been waited on by now
+	while (!m_RetiredImages.empty() && m_RetiredImages.front().Frame + m_FramesInFlight <= m_Frame)
+	{
+		m_RetiredImages.front().View.Destroy(m_Context);
+		m_RetiredImages.front().Image.Destroy(m_Context);
+		m_RetiredImages.pop_front();
+	}
+
+	// completed batches are acquired by the graphics command buffer recorded right after this
+	while (!m_PendingBatches.empty() && m_Uploader.IsComplete(m_PendingBatches.front().Value))
+	{
+		for (PendingUpload& upload: m_PendingBatches.front().Uploads)
+		{
+			m_RetiredImages.emplace_back(RetiredImage{
+				std::move(m_Images[upload.Texture])
+				, std::move(m_Views[upload.Texture])
+				, m_Frame
+			});
+			m_Images[upload.Texture]                    = std::move(upload.Image);
+			m_Views[upload.Texture]                     = std::move(upload.View);
+			m_Textures[upload.Texture].ResidentLevel    = upload.Level;
+			m_Textures[upload.Texture].ShowsPlaceholder = false;
+			MarkChanged(upload.Texture);
+		}
+		m_PendingBatches.pop_front();
+	}
+
+	ReadFeedback(frame);
+
+	uint64_t projected{};
+	for (Texture const& texture: m_Textures)
+		projected += GetSize(GetSource(texture), texture.TargetLevel);
+
+	// requests furthest from being met first, more recent ones win ties
+	std::vector<uint32_t> candidates;
+	for (uint32_t index{}; index < m_Textures.size(); ++index)
+		if (Texture const& texture = m_Textures[index];
+			!texture.ShowsPlaceholder && texture.TargetLevel == texture.ResidentLevel && GetEffectiveRequest(texture) < texture.TargetLevel)
+			candidates.emplace_back(index);
+	std::ranges::sort(candidates
+					  , [this](uint32_t left, uint32_t right)
+					  {
+						  Texture const& first  = m_Textures[left];
+						  Texture const& second = m_Textures[right];
+						  uint32_t const firstGap  = first.TargetLevel - GetEffectiveRequest(first);
+						  uint32_t const secondGap = second.TargetLevel - GetEffectiveRequest(second);
+						  if (firstGap != secondGap)
+							  return firstGap > secondGap;
+						  return first.LastRequestFrame > second.LastRequestFrame;
+					  });
+
+	uint64_t staged{};
+	for (uint32_t const index: candidates)
+	{
+		Texture const& texture = m_Textures[index];
+		uint32_t const level   = GetEffectiveRequest(texture);
+		uint64_t const size    = GetSize(*texture.Source, level);
+		if (staged > 0 && staged + size > MAX_STREAMED_BYTES_PER_UPDATE)
+			break;
+
+		uint64_t const growth = size - GetSize(*texture.Source, texture.TargetLevel);
+		if (projected + growth > budget)
+			projected -= Evict(projected + growth - budget);
+		if (projected + growth > budget)
+			continue;
+
+		staged += Stream(index, level);
+		projected += growth;
+	}
+	// a lowered budget shrinks textures even when nothing new is requested
+	if (projected > budget)
+		Evict(projected - budget);
+
+	if (!m_RecordedUploads.empty())
+		Flush();
+}
+
+std::vector<uint32_t> TextureStreamer::TakeChangedTextures(uint32_t frame)
+{
+	return std::exchange(m_ChangedTextures[frame], {});
+}
+
+TextureStreamer::Statistics TextureStreamer::GetStatistics() const
+{
+	Statistics statistics{};
+	for (Texture const& texture: m_Textures)
+	{
+		statistics.ResidentBytes += GetSize(texture.ShowsPlaceholder ? *texture.Placeholder : *texture.Source, texture.ResidentLevel);
+		statistics.Placeholders += texture.ShowsPlaceholder;
+		if (!texture.Source)
+			continue;
+		statistics.RequestedBytes += GetSize(*texture.Source, GetEffectiveRequest(texture));
+		statistics.FullChainBytes += GetSize(*texture.Source, 0);
+	}
+	for (PendingBatch const& batch: m_PendingBatches)
+		statistics.PendingUploads += static_cast<uint32_t>(batch.Uploads.size());
+	return statistics;
+}
+
+std::span<texture_mips::Level const> TextureStreamer::GetLevels(SourceTexture const& source)
+{
+	if (auto const* mapped = std::get_if<ktx2::MappedTexture>(&source))
+		return mapped->Levels;
+	return std::get<ktx2::Texture>(source).Chain.Levels;
+}
+
+VkFormat TextureStreamer::GetFormat(SourceTexture const& source)
+{
+	if (auto const* mapped = std::get_if<ktx2::MappedTexture>(&source))
+		return mapped->Format;
+	return std::get<ktx2::Texture>(source).Format;
+}
+
+uint32_t TextureStreamer::GetTailLevel(SourceTexture const& source)
+{
+	std::span const levels = GetLevels(source);
+	auto            tail   = static_cast<uint32_t>(levels.size()) - 1;
+	while (tail > 0 && std::max(levels[tail - 1].Width, levels[tail - 1].Height) <= TAIL_RESOLUTION)
+		--tail;
+	return tail;
+}
+
+TextureStreamer::SourceTexture const& TextureStreamer::GetSource(Texture const& texture)
+{
+	return texture.Source ? *texture.Source : *texture.Placeholder;
+}
+
+uint64_t TextureStreamer::GetSize(SourceTexture const& source, uint32_t level)
+{
+	std::span const levels = GetLevels(source);
+	return levels.back().Offset + levels.back().Size - levels[level].Offset;
+}
+
+uint32_t TextureStreamer::GetEffectiveRequest(Texture const& texture) const
+{
+	return m_Frame - texture.LastRequestFrame <= REQUEST_LIFETIME ? texture.RequestedLevel : texture.TailLevel;
+}
+
+uint64_t TextureStreamer::Stream(uint32_t index, uint32_t level)
+{
+	Texture&             texture    = m_Textures[index];
+	SourceTexture const& source     = GetSource(texture);
+	std::span const      levels     = GetLevels(source);
+	auto const           levelCount = static_cast<uint32_t>(levels.size()) - level;
+	uint64_t const       size       = GetSize(source, level);
+
+	// copy offsets have to be a multiple of the block size
+	StagingRing::Allocation const staging = m_Uploader.AllocateStaging(size, 16);
+	if (auto const* mapped = std::get_if<ktx2::MappedTexture>(&source))
+		ktx2::CopyLevels(*mapped, level, staging.Data);
+	else
+		std::memcpy(staging.Data.data(), std::get<ktx2::Texture>(source).Chain.Pixels.data() + levels[level].Offset, size);
+
+	vkc::Image image = vkc::ImageBuilder{ m_Context }
+					   .SetType(VK_IMAGE_TYPE_2D)
+					   .SetFormat(GetFormat(source))
+					   .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
+					   .SetExtent({ levels[level].Width, levels[level].Height })
+					   .SetMipLevels(levelCount)
+					   .Build(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, false);
+	vkc::ImageView view = image.CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D, 0, 1, 0, levelCount, false);
+
+	vkc::CommandBuffer const& commandBuffer = m_Uploader.GetCommandBuffer();
+	//
+	{
+		vkc::Image::Transition transition{};
+		transition.NewLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		transition.SrcAccessMask = VK_ACCESS_NONE;
+		transition.DstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		transition.SrcStageMask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		transition.DstStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		transition.LevelCount    = levelCount;
+		image.MakeTransition(m_Context, commandBuffer, transition);
+	}
+	std::vector<VkBufferImageCopy> regions;
+	regions.reserve(levelCount);
+	for (uint32_t mip{}; mip < levelCount; ++mip)
+	{
+		VkBufferImageCopy region{};
+		region.bufferOffset                = staging.Offset + levels[level + mip].Offset - levels[level].Offset;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel   = mip;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent                 = { levels[level + mip].Width, levels[level + mip].Height, 1 };
+		regions.emplace_back(region);
+	}
+	m_Context.DispatchTable.cmdCopyBufferToImage(commandBuffer
+												 , staging.Buffer
+												 , image
+												 , VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+												 , levelCount
+												 , regions.data());
+	// recorded on the transfer queue, visibility to the fragment shader comes from the ownership transfer or the semaphore
+	//
+	{
+		vkc::Image::Transition transition{};
+		transition.NewLayout     = VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL;
+		transition.SrcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		transition.DstAccessMask = VK_ACCESS_NONE;
+		transition.SrcStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		transition.DstStageMask  = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		transition.LevelCount    = levelCount;
+		image.MakeTransition(m_Context, commandBuffer, transition);
+	}
+
+	VkImageSubresourceRange range{};
+	range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	range.levelCount = levelCount;
+	range.layerCount = 1;
+	m_Uploader.ReleaseImage(image
+							, VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL
+							, range
+							, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+							, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+
+	texture.TargetLevel = level;
+	m_RecordedUploads.emplace_back(PendingUpload{ index, level, std::move(image), std::move(view) });
+	return size;
+}
+
+uint64_t TextureStreamer::Evict(uint64_t bytes)
+{
+	std::vector<uint32_t> candidates;
+	for (uint32_t index{}; index < m_Textures.size(); ++index)
+		if (Texture const& texture = m_Textures[index];
+			!texture.ShowsPlaceholder && texture.TargetLevel == texture.ResidentLevel && GetEffectiveRequest(texture) > texture.TargetLevel)
+			candidates.emplace_back(index);
+	std::ranges::sort(candidates
+					  , [this](uint32_t left, uint32_t right)
+					  {
+						  return m_Textures[left].LastRequestFrame < m_Textures[right].LastRequestFrame;
+					  });
+
+	// the coarser chain is copied from the source again, it is a fraction of what it replaces
+	uint64_t released{};
+	for (uint32_t const index: candidates)
+	{
+		if (released >= bytes)
+			break;
+		Texture const& texture = m_Textures[index];
+		uint32_t const level   = GetEffectiveRequest(texture);
+		released += GetSize(*texture.Source, texture.TargetLevel) - GetSize(*texture.Source, level);
+		Stream(index, level);
+	}
+	return released;
+}
+
+void TextureStreamer::ReadFeedback(uint32_t frame)
+{
+	// the log2 of the resolution each texture was sampled at plus one, written by the frame's last submission
+	auto* feedback = static_cast<uint32_t*>(m_FeedbackBuffers[frame].Data);
+	for (uint32_t index{}; index < m_Textures.size(); ++index)
+	{
+		if (feedback[index] == 0 || !m_Textures[index].Source)
+			continue;
+
+		// the coarsest level that still holds the sampled resolution
+		Texture&        texture    = m_Textures[index];
+		std::span const levels     = GetLevels(*texture.Source);
+		uint64_t const  resolution = 1ull << std::min(feedback[index] - 1, 31u);
+		uint32_t        level      = texture.TailLevel;
+		while (level > 0 && std::max(levels[level].Width, levels[level].Height) < resolution)
+			--level;
+
+		texture.RequestedLevel   = level;
+		texture.LastRequestFrame = m_Frame;
+	}
+	std::memset(feedback, 0, m_Textures.size() * sizeof(uint32_t));
+}
+
+void TextureStreamer::MarkChanged(uint32_t texture)
+{
+	for (std::vector<uint32_t>& changed: m_ChangedTextures)
+		changed.emplace_back(texture);
+}
@@ -0,0 +1,45 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	m_Workers.reserve(threadCount);
+	for (uint32_t index{}; index < threadCount; ++index)
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	//
+	{
+		std::lock_guard lock{ m_Mutex };
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+	for (std::thread& worker: m_Workers)
+		worker.join();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		//
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_Condition.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+			// remaining jobs are drained before exiting so no future is left without a value
+			if (m_Jobs.empty())
+				return;
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop();
+		}
+		job();
+	}
+}
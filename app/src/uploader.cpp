@@ -0,0 +1,301 @@
+#include "uploader.h"
+
+#include <stdexcept>
+
+#include "command_buffer.h"
+#include "helper.h"
+
+namespace
+{
+	uint32_t constexpr     COMMAND_BUFFER_COUNT{ 4 };
+	VkDeviceSize constexpr STAGING_RING_SIZE{ 64ull * 1024 * 1024 };
+
+	uint32_t FindTransferQueueFamily(vkc::Context const& context)
+	{
+		if (auto const dedicated = context.Device.get_dedicated_queue_index(vkb::QueueType::transfer))
+			return dedicated.value();
+		if (auto const separate = context.Device.get_queue_index(vkb::QueueType::transfer))
+			return separate.value();
+		return context.Device.get_queue_index(vkb::QueueType::graphics).value();
+	}
+}
+
+Uploader::Uploader(vkc::Context& context)
+	: m_Context{ context }
+	, m_QueueFamily{ FindTransferQueueFamily(context) }
+	, m_GraphicsQueueFamily{ context.Device.get_queue_index(vkb::QueueType::graphics).value() }
+	, m_CommandPool{ context, m_QueueFamily, COMMAND_BUFFER_COUNT, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT }
+	, m_StagingRing{ context, STAGING_RING_SIZE }
+{
+	m_Context.DispatchTable.getDeviceQueue(m_QueueFamily, 0, &m_Queue);
+
+	VkSemaphoreTypeCreateInfo typeCreateInfo{};
+	typeCreateInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeCreateInfo.initialValue  = 0;
+
+	VkSemaphoreCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	createInfo.pNext = &typeCreateInfo;
+	if (m_Context.DispatchTable.createSemaphore(&createInfo, nullptr, &m_TimelineSemaphore) != VK_SUCCESS)
+		throw std::runtime_error("failed to create upload timeline semaphore");
+
+	help::NameObject(m_Context, reinterpret_cast<uint64_t>(m_TimelineSemaphore), VK_OBJECT_TYPE_SEMAPHORE, "upload timeline");
+}
+
+void Uploader::Destroy()
+{
+	for (Retirement const& retirement: m_Retirements)
+		retirement.Callback();
+	m_Retirements.clear();
+	m_StagingRing.Destroy();
+	m_Context.DispatchTable.destroySemaphore(m_TimelineSemaphore, nullptr);
+}
+
+vkc::CommandBuffer& Uploader::GetCommandBuffer()
+{
+	if (!m_CommandBuffer)
+	{
+		// the pool hands its buffers out round robin, one may only be reused once its batch retired
+		if (m_InFlightValues.size() >= COMMAND_BUFFER_COUNT)
+		{
+			Wait(m_InFlightValues.front());
+			m_InFlightValues.pop_front();
+		}
+		m_CommandBuffer = &m_CommandPool.AllocateCommandBuffer(m_Context);
+		m_CommandBuffer->Begin(m_Context, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	}
+	return *m_CommandBuffer;
+}
+
+StagingRing::Allocation Uploader::AllocateStaging(VkDeviceSize size, VkDeviceSize alignment)
+{
+	m_StagingRing.Release(GetCompletedValue());
+	if (std::optional const allocation = m_StagingRing.TryAllocate(size, alignment))
+		return allocation.value();
+
+	++m_StagingStallCount;
+	while (true)
+	{
+		// copies already recorded into the ring have to be submitted before their region can ever retire
+		if (m_StagingRing.GetOldestValue() == 0)
+			Submit();
+		Wait(m_StagingRing.GetOldestValue());
+		m_StagingRing.Release(GetCompletedValue());
+		if (std::optional const allocation = m_StagingRing.TryAllocate(size, alignment))
+			return allocation.value();
+	}
+}
+
+void Uploader::ReleaseBuffer
+(
+	VkBuffer                buffer
+	, VkPipelineStageFlags2 dstStageMask
+	, VkAccessFlags2        dstAccessMask
+	, VkDeviceSize          offset
+	, VkDeviceSize          size
+)
+{
+	if (!IsDedicated())
+		return;
+
+	VkBufferMemoryBarrier2 barrier{};
+	barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+	barrier.srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+	barrier.srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	barrier.dstStageMask        = dstStageMask;
+	barrier.dstAccessMask       = dstAccessMask;
+	barrier.srcQueueFamilyIndex = m_QueueFamily;
+	barrier.dstQueueFamilyIndex = m_GraphicsQueueFamily;
+	barrier.buffer              = buffer;
+	barrier.offset              = offset;
+	barrier.size                = size;
+	m_RecordingBatch.BufferBarriers.emplace_back(barrier);
+}
+
+void Uploader::ReleaseImage
+(
+	VkImage                   image
+	, VkImageLayout           layout
+	, VkImageSubresourceRange range
+	, VkPipelineStageFlags2   dstStageMask
+	, VkAccessFlags2          dstAccessMask
+)
+{
+	if (!IsDedicated())
+		return;
+
+	VkImageMemoryBarrier2 barrier{};
+	barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	barrier.srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+	barrier.srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	barrier.dstStageMask        = dstStageMask;
+	barrier.dstAccessMask       = dstAccessMask;
+	barrier.oldLayout           = layout;
+	barrier.newLayout           = layout;
+	barrier.srcQueueFamilyIndex = m_QueueFamily;
+	barrier.dstQueueFamilyIndex = m_GraphicsQueueFamily;
+	barrier.image               = image;
+	barrier.subresourceRange    = range;
+	m_RecordingBatch.ImageBarriers.emplace_back(barrier);
+}
+
+uint64_t Uploader::Submit()
+{
+	vkc::CommandBuffer& commandBuffer = GetCommandBuffer();
+
+	// release half, the destination scope is ignored here and recorded again by the acquire on the graphics queue
+	//
+	{
+		std::vector<VkBufferMemoryBarrier2> bufferBarriers{ m_RecordingBatch.BufferBarriers };
+		std::vector<VkImageMemoryBarrier2>  imageBarriers{ m_RecordingBatch.ImageBarriers };
+		for (VkBufferMemoryBarrier2& barrier: bufferBarriers)
+		{
+			barrier.dstStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			barrier.dstAccessMask = VK_ACCESS_2_NONE;
+		}
+		for (VkImageMemoryBarrier2& barrier: imageBarriers)
+		{
+			barrier.dstStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			barrier.dstAccessMask = VK_ACCESS_2_NONE;
+		}
+
+		if (!bufferBarriers.empty() || !imageBarriers.empty())
+		{
+			VkDependencyInfo dependencyInfo{};
+			dependencyInfo.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+			dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+			dependencyInfo.pBufferMemoryBarriers    = bufferBarriers.data();
+			dependencyInfo.imageMemoryBarrierCount  = static_cast<uint32_t>(imageBarriers.size());
+			dependencyInfo.pImageMemoryBarriers     = imageBarriers.data();
+			m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+		}
+	}
+	commandBuffer.End(m_Context);
+
+	// waiting on the previous value keeps signals ordered when a graphics submission advanced the timeline
+	VkSemaphoreSubmitInfo waitInfos[]{ CreateWaitInfo(m_LastValue, VK_PIPELINE_STAGE_2_TRANSFER_BIT) };
+
+	uint64_t              value{};
+	VkSemaphoreSubmitInfo signalInfos[]{ CreateSignalInfo(value) };
+	commandBuffer.Submit(m_Context, m_Queue, waitInfos, signalInfos);
+
+	m_InFlightValues.emplace_back(value);
+	m_StagingRing.Close(value);
+	m_RecordingBatch.Value = value;
+	if (!m_RecordingBatch.BufferBarriers.empty() || !m_RecordingBatch.ImageBarriers.empty())
+		m_UnacquiredBatches.emplace_back(std::move(m_RecordingBatch));
+	m_RecordingBatch = {};
+	m_CommandBuffer  = nullptr;
+	return value;
+}
+
+uint64_t Uploader::RecordAcquireBarriers(vkc::CommandBuffer const& commandBuffer, bool completedOnly)
+{
+	uint64_t const acquireLimit = completedOnly ? GetCompletedValue() : m_LastValue;
+
+	std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+	std::vector<VkImageMemoryBarrier2>  imageBarriers;
+	uint64_t                            waitValue{};
+	while (!m_UnacquiredBatches.empty() && m_UnacquiredBatches.front().Value <= acquireLimit)
+	{
+		Batch const& batch = m_UnacquiredBatches.front();
+		bufferBarriers.insert(bufferBarriers.end(), batch.BufferBarriers.begin(), batch.BufferBarriers.end());
+		imageBarriers.insert(imageBarriers.end(), batch.ImageBarriers.begin(), batch.ImageBarriers.end());
+		waitValue = batch.Value;
+		m_UnacquiredBatches.pop_front();
+	}
+
+	// the semaphore wait orders the acquire after the release, the source scope is ignored
+	for (VkBufferMemoryBarrier2& barrier: bufferBarriers)
+	{
+		barrier.srcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+		barrier.srcAccessMask = VK_ACCESS_2_NONE;
+	}
+	for (VkImageMemoryBarrier2& barrier: imageBarriers)
+	{
+		barrier.srcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+		barrier.srcAccessMask = VK_ACCESS_2_NONE;
+	}
+
+	if (!bufferBarriers.empty() || !imageBarriers.empty())
+	{
+		VkDependencyInfo dependencyInfo{};
+		dependencyInfo.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+		dependencyInfo.pBufferMemoryBarriers    = bufferBarriers.data();
+		dependencyInfo.imageMemoryBarrierCount  = static_cast<uint32_t>(imageBarriers.size());
+		dependencyInfo.pImageMemoryBarriers     = imageBarriers.data();
+		m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+
+	// without a dedicated family nothing is acquired, the semaphore wait alone makes the copies visible
+	return completedOnly ? waitValue : m_LastValue;
+}
+
+VkSemaphoreSubmitInfo Uploader::CreateWaitInfo(uint64_t value, VkPipelineStageFlags2 stageMask) const
+{
+	VkSemaphoreSubmitInfo waitInfo{};
+	waitInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	waitInfo.semaphore = m_TimelineSemaphore;
+	waitInfo.value     = value;
+	waitInfo.stageMask = stageMask;
+	return waitInfo;
+}
+
+VkSemaphoreSubmitInfo Uploader::CreateSignalInfo(uint64_t& outValue)
+{
+	outValue = ++m_LastValue;
+
+	VkSemaphoreSubmitInfo signalInfo{};
+	signalInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	signalInfo.semaphore = m_TimelineSemaphore;
+	signalInfo.value     = outValue;
+	signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+	return signalInfo;
+}
+
+void Uploader::Retire(uint64_t value, std::function<void()> callback)
+{
+	m_Retirements.emplace_back(Retirement{ value, std::move(callback) });
+}
+
+void Uploader::Collect()
+{
+	m_StagingRing.Release(GetCompletedValue());
+	if (m_Retirements.empty())
+		return;
+
+	// callbacks run after the queue is rebuilt so they are free to retire more work
+	uint64_t const          completedValue = GetCompletedValue();
+	std::deque<Retirement>  pending;
+	std::vector<Retirement> completed;
+	for (Retirement& retirement: m_Retirements)
+		if (retirement.Value <= completedValue)
+			completed.emplace_back(std::move(retirement));
+		else
+			pending.emplace_back(std::move(retirement));
+	m_Retirements = std::move(pending);
+
+	for (Retirement const& retirement: completed)
+		retirement.Callback();
+}
+
+void Uploader::Wait(uint64_t value) const
+{
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores    = &m_TimelineSemaphore;
+	waitInfo.pValues        = &value;
+	if (m_Context.DispatchTable.waitSemaphores(&waitInfo, UINT64_MAX) != VK_SUCCESS)
+		throw std::runtime_error("failed to wait for the upload timeline");
+}
+
+uint64_t Uploader::GetCompletedValue() const
+{
+	uint64_t value{};
+	if (m_Context.DispatchTable.getSemaphoreCounterValue(m_TimelineSemaphore, &value) != VK_SUCCESS)
+		throw std::runtime_error("failed to query the upload timeline");
+	return value;
+}
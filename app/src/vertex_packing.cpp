@@ -0,0 +1,104 @@
+#include "vertex_packing.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "shader_stage.h"
+#include "glm/gtc/packing.hpp"
+
+namespace
+{
+	glm::vec3 CalculateExtent(glm::vec3 const& boundsMin, glm::vec3 const& boundsMax)
+	{
+		// a flat scene would divide by zero, any extent reproduces the single value
+		return glm::max(boundsMax - boundsMin, glm::vec3{ FLT_MIN });
+	}
+
+	uint16_t QuantizeUnorm(float value)
+	{
+		return static_cast<uint16_t>(std::lround(std::clamp(value, 0.f, 1.f) * 65535.f));
+	}
+
+	int16_t QuantizeSnorm(float value)
+	{
+		return static_cast<int16_t>(std::lround(std::clamp(value, -1.f, 1.f) * 32767.f));
+	}
+
+	float SignNotZero(float value)
+	{
+		return value >= 0.f ? 1.f : -1.f;
+	}
+}
+
+PackedVertex vertex_packing::Pack(Vertex const& vertex, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax)
+{
+	glm::vec3 const normalized = (vertex.Position - boundsMin) / CalculateExtent(boundsMin, boundsMax);
+	glm::vec2 const normal     = EncodeOctahedral(vertex.Normal);
+	glm::vec2 const tangent    = EncodeOctahedral(vertex.Tangent);
+
+	// the shader rebuilds the bitangent as cross(N, T) and flips it for mirrored uvs
+	bool const flipped = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.f;
+
+	PackedVertex packed{};
+	packed.Position[0] = QuantizeUnorm(normalized.x);
+	packed.Position[1] = QuantizeUnorm(normalized.y);
+	packed.Position[2] = QuantizeUnorm(normalized.z);
+	packed.Position[3] = flipped ? 0 : UINT16_MAX;
+	packed.UV[0]       = glm::packHalf1x16(vertex.UV.x);
+	packed.UV[1]       = glm::packHalf1x16(vertex.UV.y);
+	packed.Normal[0]   = QuantizeSnorm(normal.x);
+	packed.Normal[1]   = QuantizeSnorm(normal.y);
+	packed.Tangent[0]  = QuantizeSnorm(tangent.x);
+	packed.Tangent[1]  = QuantizeSnorm(tangent.y);
+	return packed;
+}
+
+std::vector<PackedVertex> vertex_packing::Pack(std::span<Vertex const> vertices, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax)
+{
+	std::vector<PackedVertex> packed;
+	packed.reserve(vertices.size());
+	for (Vertex const& vertex: vertices)
+		packed.emplace_back(Pack(vertex, boundsMin, boundsMax));
+	return packed;
+}
+
+glm::vec3 vertex_packing::UnpackPosition(PackedVertex const& vertex, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax)
+{
+	glm::vec3 const normalized{ vertex.Position[0] / 65535.f, vertex.Position[1] / 65535.f, vertex.Position[2] / 65535.f };
+	return boundsMin + normalized * CalculateExtent(boundsMin, boundsMax);
+}
+
+glm::vec2 vertex_packing::EncodeOctahedral(glm::vec3 const& direction)
+{
+	float const     length = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+	glm::vec2 const projected{ length > 0.f ? glm::vec2{ direction } / length : glm::vec2{} };
+	if (direction.z >= 0.f)
+		return projected;
+
+	// lower hemisphere folds over the diagonals
+	return {
+		(1.f - std::abs(projected.y)) * SignNotZero(projected.x)
+		, (1.f - std::abs(projected.x)) * SignNotZero(projected.y)
+	};
+}
+
+glm::vec3 vertex_packing::DecodeOctahedral(glm::vec2 const& encoded)
+{
+	glm::vec3   direction{ encoded, 1.f - std::abs(encoded.x) - std::abs(encoded.y) };
+	float const fold = std::max(-direction.z, 0.f);
+	direction.x += direction.x >= 0.f ? -fold : fold;
+	direction.y += direction.y >= 0.f ? -fold : fold;
+	return glm::normalize(direction);
+}
+
+void vertex_packing::AddDequantizationConstants(vkc::ShaderStage& stage, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax)
+{
+	glm::vec3 const extent = CalculateExtent(boundsMin, boundsMax);
+	stage.AddSpecializationConstant(boundsMin.x);
+	stage.AddSpecializationConstant(boundsMin.y);
+	stage.AddSpecializationConstant(boundsMin.z);
+	stage.AddSpecializationConstant(extent.x);
+	stage.AddSpecializationConstant(extent.y);
+	stage.AddSpecializationConstant(extent.z);
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "frustum_culling.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace
+{
+	// nanoseconds per sphere of the fastest of the runs, so one preempted run does not skew it
+	template<typename Function>
+	double Measure(Function&& function, uint32_t sphereCount, uint32_t iterations)
+	{
+		double fastest{ std::numeric_limits<double>::max() };
+		for (uint32_t iteration{}; iteration < iterations; ++iteration)
+		{
+			auto const start = std::chrono::steady_clock::now();
+			function();
+			auto const end = std::chrono::steady_clock::now();
+			fastest        = std::min(fastest, std::chrono::duration<double, std::nano>(end - start).count());
+		}
+		return fastest / sphereCount;
+	}
+}
+
+// compares the vectorized frustum test against the scalar one over scattered spheres, the camera sees roughly a tenth
+int main(int argc, char* argv[])
+{
+	uint32_t const iterations = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 100;
+
+	glm::mat4 const                       projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, 1000.f);
+	glm::mat4 const                       view       = glm::lookAt(glm::vec3{ 0.f }, glm::vec3{ 0.f, 0.f, -1.f }, glm::vec3{ 0.f, 1.f, 0.f });
+	frustum_culling::Planes const         planes     = frustum_culling::ExtractPlanes(projection * view);
+	std::mt19937                          generator{ 42 };
+	std::uniform_real_distribution<float> position{ -500.f, 500.f };
+	std::uniform_real_distribution<float> radius{ .5f, 5.f };
+
+	std::cout << std::format("{} kernel, fastest of {} runs", frustum_culling::GetInstructionSet(), iterations) << std::endl;
+	for (uint32_t const sphereCount: { 1'000u, 10'000u, 100'000u })
+	{
+		frustum_culling::Spheres spheres;
+		for (uint32_t index{}; index < sphereCount; ++index)
+			spheres.Add(glm::vec4{ position(generator), position(generator), position(generator), radius(generator) });
+
+		std::vector<uint32_t> scalarVisible;
+		std::vector<uint32_t> visible;
+		double const          scalar = Measure([&]
+		{
+			frustum_culling::CullScalar(planes, spheres, scalarVisible);
+		}, sphereCount, iterations);
+		double const vectorized = Measure([&]
+		{
+			frustum_culling::Cull(planes, spheres, visible);
+		}, sphereCount, iterations);
+
+		if (visible != scalarVisible)
+		{
+			std::cerr << std::format("{} spheres: kernels disagree, {} visible against {}", sphereCount, visible.size(), scalarVisible.size())
+				<< std::endl;
+			return 1;
+		}
+		std::cout << std::format("{:>7} spheres, {:>6} visible: scalar {:.2f} ns, {} {:.2f} ns per sphere, {:.1f}x"
+								 , sphereCount
+								 , visible.size()
+								 , scalar
+								 , frustum_culling::GetInstructionSet()
+								 , vectorized
+								 , scalar / vectorized) << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,48 @@
+#include <chrono>
+#include <iostream>
+#include <string_view>
+
+#include "cooked_scene.h"
+#include "scene_importer.h"
+
+// offline cook step, produces the same cache the renderer writes on a cold start
+int main(int argc, char* argv[])
+{
+	// --assimp reads glTF through Assimp as well, to compare against the native loader
+	auto reader = scene_importer::Reader::Auto;
+	if (argc > 1 && std::string_view{ argv[1] } == "--assimp")
+	{
+		reader = scene_importer::Reader::Assimp;
+		--argc;
+		++argv;
+	}
+	if (argc < 2)
+	{
+		std::cerr << "usage: SceneCooker [--assimp] <source scene> [output]" << std::endl;
+		return 1;
+	}
+
+	std::string const source{ argv[1] };
+	std::string const output{ argc > 2 ? argv[2] : cooked_scene::GetCachePath(source) };
+	try
+	{
+		auto const      start = std::chrono::steady_clock::now();
+		SceneData const data  = scene_importer::Import(source, reader);
+		auto const      end   = std::chrono::steady_clock::now();
+
+		cooked_scene::Write(output, data, cooked_scene::HashSource(source), std::chrono::duration<double>(end - start).count());
+		std::cout << "cooked " << source << " -> " << output
+			<< " (" << data.Meshes.size() << " meshes, "
+			<< data.Vertices.size() << " vertices, "
+			<< data.Indices.size() << " indices, "
+			<< data.Meshlets.size() << " meshlets, "
+			<< data.Lods.size() << " LODs, "
+			<< data.Textures.size() << " textures)" << std::endl;
+	}
+	catch (std::runtime_error const& error)
+	{
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
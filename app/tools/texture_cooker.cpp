@@ -0,0 +1,63 @@
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <future>
+#include <iostream>
+
+#include "scene_importer.h"
+#include "texture_processing.h"
+#include "thread_pool.h"
+
+// offline cook step, encodes every texture the scene references into a KTX2 file with a block compressed mip chain
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "usage: TextureCooker <source scene> [source texture directory] [output directory]" << std::endl;
+		return 1;
+	}
+
+	std::string const scene{ argv[1] };
+	std::string const sourceDirectory{ argc > 2 ? argv[2] : texture_processing::SOURCE_DIRECTORY };
+	std::string const outputDirectory{ argc > 3 ? argv[3] : texture_processing::COOKED_DIRECTORY };
+	try
+	{
+		auto const      start = std::chrono::steady_clock::now();
+		SceneData const data  = scene_importer::Import(scene);
+		std::filesystem::create_directories(outputDirectory);
+
+		ThreadPool                         threadPool{};
+		std::vector<std::future<uint64_t>> futures;
+		futures.reserve(data.Textures.size());
+		for (TextureEntry const& texture: data.Textures)
+			futures.emplace_back(threadPool.Submit([&texture, &sourceDirectory, &outputDirectory]
+			{
+				std::string const   source = (std::filesystem::path{ sourceDirectory } / texture.Path).string();
+				std::string const   output = texture_processing::GetCookedPath((std::filesystem::path{ outputDirectory } / "").string(), texture);
+				ktx2::Texture const cooked = texture_processing::Process(source, texture.Usage, true);
+				ktx2::Write(output, cooked);
+				return static_cast<uint64_t>(cooked.Chain.Pixels.size());
+			}));
+
+		uint64_t totalSize{};
+		for (size_t index{}; index < futures.size(); ++index)
+		{
+			uint64_t const size = futures[index].get();
+			totalSize += size;
+			std::cout << std::format("{} -> {:.2f} MiB", data.Textures[index].Path, static_cast<double>(size) / (1024 * 1024)) << std::endl;
+		}
+
+		auto const end = std::chrono::steady_clock::now();
+		std::cout << std::format("cooked {} textures into {}, {:.1f} MiB in {:.1f} s"
+								 , data.Textures.size()
+								 , outputDirectory
+								 , static_cast<double>(totalSize) / (1024 * 1024)
+								 , std::chrono::duration<double>(end - start).count()) << std::endl;
+	}
+	catch (std::runtime_error const& error)
+	{
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}